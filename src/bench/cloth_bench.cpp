@@ -0,0 +1,541 @@
+/**
+ * @file
+ * @brief Headless benchmark of the XPBD pipeline, prints the results as JSON.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtc/constants.hpp>
+#include "cloth/cloth.h"
+#include "cloth/profiler.h"
+#include "cloth/replay.h"
+#include "cloth/scene.h"
+#include "cloth/settings.h"
+#include "cloth/vertex_data.h"
+#include "collision/collider_set.h"
+#include "collision/mesh_collider.h"
+#include "collision/sdf.h"
+#include "constraints/distance_kernel.h"
+#include "forces/wind.h"
+#include "io/checkpoint.h"
+#include "io/point_cache.h"
+#include "mesh/mesh_io.h"
+#include "parallel/thread_pool.h"
+
+namespace {
+
+struct Options {
+    int rows = 60;
+    int columns = 60;
+    int substeps = 30;
+    bool adaptive = false;
+    bool self_collision = false;
+    bool tethers = false;
+    bool sleeping = false;
+    float tear = 0.0f;
+    std::string collider = "none";
+    std::string wind = "none";
+    float wind_speed = 5.0f;
+    std::string obstacle;
+    std::string cloth;
+    std::string restore;
+    std::string checkpoint;
+    std::string cache;
+    std::string record;
+    std::string replay;
+    int release_frame = -1;
+    int cloths = 1;
+    bool batched = true;
+    int frames = 300;
+    unsigned threads = 1;
+    std::string solver = "gs";
+    std::string bend = "distance";
+    std::string simd = "auto";
+    std::string output;
+};
+
+const char* bend_name(cloth::BendModel model) {
+    switch (model) {
+        case cloth::BendModel::Dihedral:  return "dihedral";
+        case cloth::BendModel::Isometric: return "isometric";
+        default:                          return "distance";
+    }
+}
+
+/**
+ * Residual of the active bending model (only one of the three sets is filled)
+ */
+cloth::DistanceConstraints::Residual bend_residual_of(const cloth::Cloth& c) {
+    switch (c.get_bend_model()) {
+        case cloth::BendModel::Dihedral:  return c.dihedral_cs.residual(c.particles);
+        case cloth::BendModel::Isometric: return c.isometric_cs.residual(c.particles);
+        default:                          return c.b_cs.residual(c.particles);
+    }
+}
+
+void usage() {
+    std::cerr << "usage: cloth_bench [--rows N] [--columns N] [--grid N] [--cloth mesh file] [--substeps N] [--adaptive 0|1] [--frames N]\n"
+                 "                   [--self-collision 0|1] [--tethers 0|1] [--sleep 0|1] [--tear strain (0 = off)] [--collider none|plane|sphere|capsule|sdf|mesh]\n"
+                 "                   [--obstacle mesh file, for --collider mesh]\n"
+                 "                   [--wind none|uniform|turbulent|point] [--wind-speed m/s]\n"
+                 "                   [--threads N (0 = all cores)] [--solver gs|jacobi]\n"
+                 "                   [--bend distance|dihedral|isometric]\n"
+                 "                   [--simd auto|scalar|sse41|avx2|avx512] [--output file.json]\n"
+                 "                   [--restore checkpoint to start from] [--checkpoint file written after the last frame]\n"
+                 "                   [--cache point cache of every frame]\n"
+                 "                   [--record event log] [--replay event log] [--release-frame N unpins both corners]\n"
+                 "                   [--cloths N copies side by side] [--batched 0|1 solves them as one scene]\n";
+}
+
+bool parse(int argc, char** argv, Options& o) {
+    for (int i=1; i<argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--rows")            o.rows = std::atoi(value.c_str());
+        else if (arg == "--columns")    o.columns = std::atoi(value.c_str());
+        else if (arg == "--grid")       o.rows = o.columns = std::atoi(value.c_str());
+        else if (arg == "--cloth")      o.cloth = value;
+        else if (arg == "--restore")    o.restore = value;
+        else if (arg == "--checkpoint") o.checkpoint = value;
+        else if (arg == "--cache")      o.cache = value;
+        else if (arg == "--record")     o.record = value;
+        else if (arg == "--replay")     o.replay = value;
+        else if (arg == "--release-frame") o.release_frame = std::atoi(value.c_str());
+        else if (arg == "--cloths")     o.cloths = std::atoi(value.c_str());
+        else if (arg == "--batched")    o.batched = std::atoi(value.c_str()) != 0;
+        else if (arg == "--substeps")   o.substeps = std::atoi(value.c_str());
+        else if (arg == "--adaptive")   o.adaptive = std::atoi(value.c_str()) != 0;
+        else if (arg == "--self-collision") o.self_collision = std::atoi(value.c_str()) != 0;
+        else if (arg == "--tethers")    o.tethers = std::atoi(value.c_str()) != 0;
+        else if (arg == "--sleep")      o.sleeping = std::atoi(value.c_str()) != 0;
+        else if (arg == "--tear")       o.tear = static_cast<float>(std::atof(value.c_str()));
+        else if (arg == "--collider")   o.collider = value;
+        else if (arg == "--obstacle")   o.obstacle = value;
+        else if (arg == "--wind")       o.wind = value;
+        else if (arg == "--wind-speed") o.wind_speed = static_cast<float>(std::atof(value.c_str()));
+        else if (arg == "--frames")     o.frames = std::atoi(value.c_str());
+        else if (arg == "--threads")    o.threads = static_cast<unsigned>(std::atoi(value.c_str()));
+        else if (arg == "--solver")     o.solver = value;
+        else if (arg == "--bend")       o.bend = value;
+        else if (arg == "--simd")       o.simd = value;
+        else if (arg == "--output")     o.output = value;
+        else {
+            std::cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (o.rows < 2 || o.columns < 2 || o.substeps < 1 || o.frames < 1 || o.cloths < 1) {
+        std::cerr << "need rows >= 2, columns >= 2, substeps >= 1, frames >= 1, cloths >= 1\n";
+        return false;
+    }
+    if (o.solver != "gs" && o.solver != "jacobi") {
+        std::cerr << "unknown solver " << o.solver << "\n";
+        return false;
+    }
+    if (o.bend != "distance" && o.bend != "dihedral" && o.bend != "isometric") {
+        std::cerr << "unknown bending model " << o.bend << "\n";
+        return false;
+    }
+    if (o.collider != "none" && o.collider != "plane" && o.collider != "sphere"
+        && o.collider != "capsule" && o.collider != "sdf" && o.collider != "mesh") {
+        std::cerr << "unknown collider " << o.collider << "\n";
+        return false;
+    }
+    if (o.wind != "none" && o.wind != "uniform" && o.wind != "turbulent" && o.wind != "point") {
+        std::cerr << "unknown wind " << o.wind << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Triangulated sphere, the stand-in obstacle of --collider mesh without --obstacle
+ */
+cloth::TriangleMesh sphere_mesh(const glm::vec3& center, float radius, int rings, int sectors) {
+    cloth::TriangleMesh mesh;
+    for (int r=0; r<=rings; ++r) {
+        const float theta = glm::pi<float>() * r / rings;
+        for (int s=0; s<sectors; ++s) {
+            const float phi = glm::two_pi<float>() * s / sectors;
+            mesh.vertices.push_back(center + radius * glm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+        }
+    }
+    for (int r=0; r<rings; ++r)
+        for (int s=0; s<sectors; ++s) {
+            const std::uint32_t a = r * sectors + s;
+            const std::uint32_t b = r * sectors + (s + 1) % sectors;
+            const std::uint32_t c = a + sectors;
+            const std::uint32_t d = b + sectors;
+            // the first and last rings collapse to the poles, skip their degenerate halves
+            if (r > 0)
+                mesh.indices.insert(mesh.indices.end(), {a, c, b});
+            if (r < rings - 1)
+                mesh.indices.insert(mesh.indices.end(), {b, c, d});
+        }
+    return mesh;
+}
+
+/**
+ * One obstacle below the cloth, which starts flat at z = 2 over [0, 1] x [0, 1]
+ */
+void add_collider(const std::string& kind, const std::string& obstacle, cloth::ColliderSet& set) {
+    const glm::vec3 center {0.5, 0.5, 1.6};
+    if (kind == "plane")
+        set.add<cloth::PlaneCollider>(glm::vec3(0.0, 0.0, 1.2), glm::vec3(0.0, 0.0, 1.0));
+    else if (kind == "sphere")
+        set.add<cloth::SphereCollider>(center, 0.3f);
+    else if (kind == "capsule")
+        set.add<cloth::CapsuleCollider>(center - glm::vec3(0.4, 0.0, 0.0), center + glm::vec3(0.4, 0.0, 0.0), 0.2f);
+    else if (kind == "sdf")
+        set.add<cloth::SdfCollider>(cloth::SdfGrid::from_function({center - 0.4f, center + 0.4f}, 0.01f,
+                                                                   [&](const glm::vec3& p) { return glm::length(p - center) - 0.3f; }));
+    else if (kind == "mesh") {
+        cloth::TriangleMesh mesh = obstacle.empty() ? sphere_mesh(center, 0.3f, 32, 64) : cloth::load_mesh(obstacle);
+        set.add<cloth::MeshCollider>(std::move(mesh.vertices), std::move(mesh.indices));
+    }
+}
+
+
+/**
+ * Wind across the cloth (along y), or from a fan above its centre. The nodes of the bench cloths
+ * weigh 1 kg each, so the air is made denser in proportion: the cloth reacts to the wind like a
+ * 200 g/m^2 fabric of its size would.
+ */
+void add_wind(const std::string& kind, float speed, const cloth::Cloth& c, cloth::WindField& field) {
+    if (kind == "none")
+        return;
+    float area = 0.0f, mass = 0.0f;
+    for (const auto& t : c.all_tris)
+        area += 0.5f * glm::length(glm::cross(c.particles.position(t.b) - c.particles.position(t.a),
+                                              c.particles.position(t.c) - c.particles.position(t.a)));
+    for (float m : c.particles.m)
+        mass += m;
+    if (area > 0.0f)
+        field.density *= mass / area / 0.2f;
+    const glm::vec3 across {0.0f, speed, 0.0f};
+    if (kind == "uniform")
+        field.add<cloth::UniformWind>(across);
+    else if (kind == "turbulent")
+        field.add<cloth::TurbulentWind>(across, 0.5f * speed, 1.0f);
+    else if (kind == "point")
+        field.add<cloth::PointWind>(glm::vec3(0.5f, 0.5f, 2.5f), speed, 1.5f);
+}
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse(argc, argv, o)) {
+        usage();
+        return 1;
+    }
+    cloth::SimdLevel simd;
+    if (!cloth::parse_simd_level(o.simd, simd) || !cloth::simd_level_supported(simd)) {
+        std::cerr << "simd level " << o.simd << " is not available\n";
+        return 1;
+    }
+
+    using clock = std::chrono::steady_clock;
+    cloth::TriangleMesh cloth_mesh;
+    if (!o.cloth.empty()) {
+        try {
+            cloth_mesh = cloth::load_mesh(o.cloth);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    // setup_s covers welding, edges, hinges and colouring, not the file parsing; for a checkpoint
+    // it is the whole restore, mapping included
+    // every copy is built like the first one and moved along x, so that they do not overlap
+    const auto setup_start = clock::now();
+    cloth::Scene scene;
+    cloth::SimSettings restored;
+    for (int k=0; k<o.cloths; ++k) {
+        std::unique_ptr<cloth::Cloth> cloth_ptr;
+        if (!o.restore.empty()) {
+            try {
+                cloth_ptr = cloth::Checkpoint(o.restore).restore(restored);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        } else {
+            cloth_ptr = o.cloth.empty() ? std::make_unique<cloth::Cloth>(o.rows, o.columns, 1.0)
+                                        : std::make_unique<cloth::Cloth>(k + 1 < o.cloths ? cloth_mesh : std::move(cloth_mesh));
+        }
+        if (o.restore.empty() && o.bend != "distance")
+            cloth_ptr->set_bend_model(o.bend == "dihedral" ? cloth::BendModel::Dihedral : cloth::BendModel::Isometric);
+        for (float& x : cloth_ptr->particles.x)
+            x += 1.2f * k;
+        scene.add(std::move(cloth_ptr));
+    }
+    cloth::Cloth& c = scene.cloth(0);
+    const bool batched = o.batched && o.cloths > 1;
+    const double setup_s = std::chrono::duration<double>(clock::now() - setup_start).count();
+
+    std::unique_ptr<cloth::ThreadPool> pool;
+    if (o.threads != 1)
+        pool = std::make_unique<cloth::ThreadPool>(o.threads);
+    cloth::Profiler profiler;
+    scene.pool = pool.get();
+    scene.profiler = &profiler;
+    scene.simd_level = simd;
+    scene.solver_mode = o.solver == "jacobi" ? cloth::SolverMode::Jacobi : cloth::SolverMode::GaussSeidel;
+    for (std::size_t k=0; k<scene.size(); ++k) {
+        scene.cloth(k).pool = scene.pool;
+        scene.cloth(k).profiler = scene.profiler;
+        scene.cloth(k).simd_level = scene.simd_level;
+        scene.cloth(k).solver_mode = scene.solver_mode;
+    }
+
+    // the command line wins over the settings of a checkpoint
+    cloth::SimSettings settings = restored;
+    settings.iteration_per_frame = o.substeps;
+    settings.adaptive_substeps = o.adaptive;
+    settings.self_collision = o.self_collision;
+    settings.long_range_attachments = o.tethers;
+    settings.sleeping = o.sleeping;
+    settings.tearing = o.tear > 0.0f;
+    if (settings.tearing)
+        settings.tear_strain = o.tear;
+    if (settings.tearing && !o.cache.empty()) {
+        std::cerr << "--cache needs a constant number of particles, it cannot be used with --tear\n";
+        return 1;
+    }
+    cloth::ColliderSet colliders;
+    try {
+        add_collider(o.collider, o.obstacle, colliders);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    scene.colliders = &colliders;
+    for (std::size_t k=0; k<scene.size(); ++k)
+        scene.cloth(k).colliders = &colliders;
+    cloth::WindField wind;
+    add_wind(o.wind, o.wind_speed, c, wind);
+    scene.wind = &wind;
+    for (std::size_t k=0; k<scene.size(); ++k)
+        scene.cloth(k).wind = &wind;
+
+    std::vector<float> vertices(scene.particle_count() * cloth::stream_vertex_floats);
+    std::vector<cloth::DistanceConstraints::Residual> stretch_residual, bend_residual;
+    stretch_residual.reserve(o.frames);
+    bend_residual.reserve(o.frames);
+
+    // a replay takes its settings and inputs from the log, a recording starts with the settings
+    cloth::EventLog log;
+    if (!o.replay.empty()) {
+        try {
+            log = cloth::EventLog::load(o.replay);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        settings.frame_time = log.frame_time;
+    } else {
+        log.record_settings(0, settings);
+    }
+    cloth::ReplayVerifier verifier {log};
+    std::vector<cloth::SimEvent> events;
+
+    std::unique_ptr<cloth::PointCacheWriter> cache;
+    if (!o.cache.empty()) {
+        try {
+            cache = std::make_unique<cloth::PointCacheWriter>(o.cache, c);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // residuals are measured outside the timed part of the frame, the cache has its own timer
+    double cache_s = 0.0;
+    double simulate_s = 0.0;
+    double total_s = 0.0;
+    long long substeps = 0;
+    std::vector<int> frame_substeps;
+    frame_substeps.reserve(o.frames);
+    for (int f=0; f<o.frames; ++f) {
+        events.clear();
+        if (!o.replay.empty()) {
+            auto [first, last] = log.at(f);
+            events.assign(first, last);
+        } else if (f == o.release_frame) {
+            events.push_back(cloth::SimEvent::unpin(cloth::EventType::Unpin1));
+            events.push_back(cloth::SimEvent::unpin(cloth::EventType::Unpin2));
+        }
+        for (const cloth::SimEvent& e : events) {
+            cloth::apply_event(e, c, settings);
+            if (o.replay.empty())
+                log.record(f, e);
+        }
+
+        const auto frame_start = clock::now();
+        if (batched)
+            scene.simulate_XPBD(settings);
+        else
+            for (std::size_t k=0; k<scene.size(); ++k)
+                scene.cloth(k).simulate_XPBD(settings);
+        const auto simulate_end = clock::now();
+        wind.advance(settings.frame_time);
+        substeps += c.last_substeps;
+        frame_substeps.push_back(c.last_substeps);
+
+        // a tear adds particles
+        vertices.resize(scene.particle_count() * cloth::stream_vertex_floats);
+        for (std::size_t k=0, at=0; k<scene.size(); at += scene.cloth(k++).particles.size())
+            cloth::write_stream_vertices(scene.cloth(k), vertices.data() + at * cloth::stream_vertex_floats);
+        const auto frame_end = clock::now();
+        simulate_s += std::chrono::duration<double>(simulate_end - frame_start).count();
+        total_s += std::chrono::duration<double>(frame_end - frame_start).count();
+
+        stretch_residual.push_back(c.s_cs.residual(c.particles));
+        bend_residual.push_back(bend_residual_of(c));
+        if (!o.replay.empty())
+            verifier.check(f, c.particles, pool.get());
+        else if (!o.record.empty())
+            log.hashes.push_back(cloth::state_hash(c.particles, pool.get()));
+
+        if (cache) {
+            const auto cache_start = clock::now();
+            try {
+                cache->append(c, (f + 1) * settings.frame_time);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+            cache_s += std::chrono::duration<double>(clock::now() - cache_start).count();
+        }
+    }
+    if (cache) {
+        try {
+            cache->finish();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    const double particle_substeps = static_cast<double>(scene.particle_count()) * substeps;
+
+    const std::size_t bend_size = c.b_cs.size() + c.dihedral_cs.size() + c.isometric_cs.size();
+    const std::size_t bend_colors = c.b_cs.colors() + c.dihedral_cs.colors() + c.isometric_cs.colors();
+
+    std::ostringstream json;
+    json.precision(9);
+    json << "{\n";
+    json << "  \"config\": {\"cloth\": \"" << (!o.restore.empty() ? o.restore : o.cloth.empty() ? "grid" : o.cloth) << "\", \"rows\": " << c.rows << ", \"columns\": " << c.columns
+         << ", \"triangles\": " << c.all_tris.size()
+         << ", \"particles\": " << c.particles.size()
+         << ", \"stretch_constraints\": " << c.s_cs.size() << ", \"bend_constraints\": " << bend_size
+         << ", \"stretch_colors\": " << c.s_cs.colors() << ", \"bend_colors\": " << bend_colors
+         << ", \"bend\": \"" << bend_name(c.get_bend_model()) << "\""
+         << ", \"substeps\": " << settings.iteration_per_frame << ", \"adaptive\": " << (settings.adaptive_substeps ? "true" : "false")
+         << ", \"self_collision\": " << (settings.self_collision ? "true" : "false")
+         << ", \"sleeping\": " << (settings.sleeping ? "true" : "false")
+         << ", \"tethers\": " << (settings.long_range_attachments ? c.tethers.size() : 0)
+         << ", \"collider\": \"" << o.collider << "\""
+         << ", \"wind\": \"" << o.wind << "\""
+         << ", \"cloths\": " << o.cloths << ", \"batched\": " << (batched ? "true" : "false")
+         << ", \"frames\": " << o.frames
+         << ", \"threads\": " << (pool ? pool->size() : 1u)
+         << ", \"solver\": \"" << o.solver << "\", \"simd\": \"" << cloth::to_string(simd) << "\"},\n";
+    json << "  \"setup_s\": " << setup_s << ",\n";
+    json << "  \"total_s\": " << total_s << ",\n";
+    if (cache)
+        json << "  \"cache_append_s\": " << cache_s << ",\n";
+    json << "  \"simulate_s\": " << simulate_s << ",\n";
+    if (!o.replay.empty())
+        json << "  \"replay\": {\"checked\": " << verifier.checked << ", \"recorded\": " << log.hashes.size()
+             << ", \"first_mismatch\": " << verifier.first_mismatch << "},\n";
+    if (o.self_collision)
+        json << "  \"collision_pairs\": " << (batched ? scene.collision_pair_count() : c.self_collision.pair_count()) << ",\n";
+    if (!colliders.empty())
+        json << "  \"collider_candidates\": " << (batched ? scene.collider_candidate_count() : c.collider_contacts.candidate_count()) << ",\n";
+    if (settings.sleeping) {
+        const cloth::Islands& islands = batched ? scene.islands() : c.islands;
+        json << "  \"islands\": {\"count\": " << islands.size() << ", \"asleep\": " << islands.sleeping() << "},\n";
+    }
+    if (settings.tearing) {
+        std::size_t splits = 0;
+        for (std::size_t k=0; k<scene.size(); ++k)
+            splits += scene.cloth(k).tearing.splits;
+        json << "  \"tears\": {\"splits\": " << splits << ", \"strain\": " << settings.tear_strain << "},\n";
+    }
+    json << "  \"mean_substeps\": " << static_cast<double>(substeps) / o.frames << ",\n";
+    json << "  \"ms_per_frame\": " << 1000.0 * total_s / o.frames << ",\n";
+    json << "  \"particle_substeps_per_s\": " << particle_substeps / simulate_s << ",\n";
+    json << "  \"phases\": {";
+    for (std::size_t p=0; p<static_cast<std::size_t>(cloth::Phase::Count); ++p) {
+        const auto phase = static_cast<cloth::Phase>(p);
+        json << (p ? ", " : "") << "\n    \"" << cloth::Profiler::name(phase) << "\": {\"total_s\": " << profiler.total(phase)
+             << ", \"calls\": " << profiler.count(phase)
+             << ", \"ms_per_frame\": " << 1000.0 * profiler.total(phase) / o.frames << "}";
+    }
+    json << "\n  },\n";
+    json << "  \"residual\": {\n";
+    json << "    \"final\": {\"stretch_rms\": " << stretch_residual.back().rms << ", \"stretch_max\": " << stretch_residual.back().max
+         << ", \"bend_rms\": " << bend_residual.back().rms << ", \"bend_max\": " << bend_residual.back().max;
+    if (o.tethers)
+        json << ", \"tether_overshoot\": " << c.tethers.overshoot(c.particles);
+    json << "},\n";
+    json << "    \"per_frame\": {\"stretch_rms\": [";
+    for (std::size_t f=0; f<stretch_residual.size(); ++f)
+        json << (f ? ", " : "") << stretch_residual[f].rms;
+    json << "], \"bend_rms\": [";
+    for (std::size_t f=0; f<bend_residual.size(); ++f)
+        json << (f ? ", " : "") << bend_residual[f].rms;
+    json << "], \"substeps\": [";
+    for (std::size_t f=0; f<frame_substeps.size(); ++f)
+        json << (f ? ", " : "") << frame_substeps[f];
+    json << "]}\n  }\n}\n";
+
+    if (!o.record.empty()) {
+        try {
+            log.save(o.record);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (!o.checkpoint.empty()) {
+        try {
+            cloth::save_checkpoint(o.checkpoint, c, settings);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (o.output.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(o.output);
+        if (!out) {
+            std::cerr << "cannot write " << o.output << "\n";
+            return 1;
+        }
+        out << json.str();
+    }
+    return 0;
+}
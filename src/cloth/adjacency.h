@@ -0,0 +1,150 @@
+/**
+ * @file
+ * @brief Contains the struct Adjacency, a compressed (CSR) one-to-many index table.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cloth{
+/**
+ * @struct Adjacency
+ * @brief For every key k, items[offsets[k] .. offsets[k+1]) lists its neighbours. Items of a key
+ * keep the order in which they were given to build(), so gathers over them are reproducible.
+ *
+ * The table can also be edited in place (add, remove, replace, split), each edit costs the items of
+ * the keys it touches. The first edit gives every key its own end (ends), so a key can shrink where
+ * it is; a key that grows is moved to the back of items, and keys added by split go there too.
+ */
+struct Adjacency
+{
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> items;
+    /**
+     * End of every key once the table has been edited, empty while it is compact
+     */
+    std::vector<std::uint32_t> ends;
+
+    std::size_t keys() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    std::uint32_t begin(std::size_t k) const { return offsets[k]; }
+    std::uint32_t end(std::size_t k) const { return ends.empty() ? offsets[k + 1] : ends[k]; }
+    std::uint32_t count(std::size_t k) const { return end(k) - begin(k); }
+
+    /**
+     * Build the table from a list of groups: group g contributes item g to the key of each of its
+     * per_group members (e.g. vertex -> triangles with per_group = 3).
+     * @param members per_group * groups key indices
+     * @param per_group members per group
+     * @param key_count number of keys
+     */
+    template <typename Index>
+    void build(const Index* members, std::size_t groups, std::size_t per_group, std::size_t key_count) {
+        ends.clear();
+        offsets.assign(key_count + 1, 0);
+        for (std::size_t i=0; i<groups * per_group; ++i)
+            ++offsets[static_cast<std::size_t>(members[i]) + 1];
+        for (std::size_t k=0; k<key_count; ++k)
+            offsets[k + 1] += offsets[k];
+        items.resize(groups * per_group);
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t g=0; g<groups; ++g)
+            for (std::size_t m=0; m<per_group; ++m)
+                items[fill[members[g * per_group + m]]++] = static_cast<std::uint32_t>(g);
+    }
+
+    /**
+     * Append an empty key
+     * @return the new key
+     */
+    std::size_t add_key() {
+        if (offsets.empty())
+            offsets.push_back(0);
+        make_editable();
+        offsets.push_back(offsets.back());
+        ends.push_back(offsets.back());
+        return keys() - 1;
+    }
+
+    /**
+     * Append item to key k
+     */
+    void add(std::size_t k, std::uint32_t item) {
+        make_editable();
+        if (ends[k] != items.size()) {
+            // no room after the key, move it to the back
+            const std::uint32_t first = offsets[k], last = ends[k];
+            offsets[k] = static_cast<std::uint32_t>(items.size());
+            for (std::uint32_t i=first; i<last; ++i) {
+                const std::uint32_t moved = items[i];
+                items.push_back(moved);
+            }
+        }
+        items.push_back(item);
+        ends[k] = static_cast<std::uint32_t>(items.size());
+        offsets.back() = ends[k];
+    }
+
+    /**
+     * Remove the first occurrence of item from key k, the last item of k takes its place
+     * @return false when k does not hold item
+     */
+    bool remove(std::size_t k, std::uint32_t item) {
+        make_editable();
+        for (std::uint32_t i=offsets[k]; i<ends[k]; ++i)
+            if (items[i] == item) {
+                items[i] = items[--ends[k]];
+                return true;
+            }
+        return false;
+    }
+
+    /**
+     * Replace the first occurrence of item in key k
+     */
+    void replace(std::size_t k, std::uint32_t item, std::uint32_t replacement) {
+        for (std::uint32_t i=begin(k); i<end(k); ++i)
+            if (items[i] == item) {
+                items[i] = replacement;
+                return;
+            }
+    }
+
+    /**
+     * Append a key made of the items of key k for which moves(item) is true, they are removed from
+     * k; both keys keep the order of their items
+     * @return the new key
+     */
+    template <typename Pred>
+    std::size_t split(std::size_t k, Pred&& moves) {
+        make_editable();
+        const std::size_t key = keys();
+        std::uint32_t kept = offsets[k];
+        for (std::uint32_t i=offsets[k]; i<ends[k]; ++i) {
+            const std::uint32_t item = items[i];
+            if (moves(item))
+                items.push_back(item);
+            else
+                items[kept++] = item;
+        }
+        const std::uint32_t moved = ends[k] - kept;
+        ends[k] = kept;
+        offsets.back() = static_cast<std::uint32_t>(items.size() - moved);
+        offsets.push_back(static_cast<std::uint32_t>(items.size()));
+        ends.push_back(static_cast<std::uint32_t>(items.size()));
+        return key;
+    }
+
+private:
+    void make_editable() {
+        if (!ends.empty() || offsets.empty())
+            return;
+        ends.assign(offsets.begin() + 1, offsets.end());
+    }
+};
+}
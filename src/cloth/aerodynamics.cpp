@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Contains the implementation of class Aerodynamics.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "cloth/aerodynamics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cloth{
+
+namespace {
+
+constexpr std::size_t triangle_grain = 1024;
+constexpr std::size_t particle_grain = 4096;
+
+/**
+ * Force on each node of n triangles, from their area weighted normal (nx, ny, nz), mean velocity
+ * (vx, vy, vz) and wind (wx, wy, wz). Plain arrays and no branches, so that the loop is vectorized.
+ * @param k density / 4 / 3: |N.u| is twice the area times |u| times cos, a third goes to each node
+ */
+void plate_forces(std::size_t n, float k, float drag, float lift,
+                  const float* nx, const float* ny, const float* nz,
+                  const float* vx, const float* vy, const float* vz,
+                  const float* wx, const float* wy, const float* wz,
+                  float* __restrict fx, float* __restrict fy, float* __restrict fz) {
+    for (std::size_t t=0; t<n; ++t) {
+        const float ux = wx[t] - vx[t], uy = wy[t] - vy[t], uz = wz[t] - vz[t];
+        const float d = nx[t] * ux + ny[t] * uy + nz[t] * uz;
+        const float length_n = std::max(std::sqrt(nx[t]*nx[t] + ny[t]*ny[t] + nz[t]*nz[t]), 1e-20f);
+        const float length_u = std::max(std::sqrt(ux*ux + uy*uy + uz*uz), 1e-20f);
+        const float abs_d = std::fabs(d);
+        // |u| n turned downstream, and |u| cos u/|u|
+        const float along_n = std::copysign(length_u / length_n, d);
+        const float across_u = abs_d / (length_n * length_u);
+        const float s = k * abs_d;
+        fx[t] = s * (drag * ux + lift * (along_n * nx[t] - across_u * ux));
+        fy[t] = s * (drag * uy + lift * (along_n * ny[t] - across_u * uy));
+        fz[t] = s * (drag * uz + lift * (along_n * nz[t] - across_u * uz));
+    }
+}
+}
+
+void Aerodynamics::sample_wind(const int* tris, std::size_t tri_count, const Particles& p, const WindField& wind, ThreadPool* pool) {
+    for (aligned_vector<float>* a : {&cx, &cy, &cz, &wx, &wy, &wz})
+        a->resize(tri_count);
+    parallel_for(pool, 0, tri_count, triangle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t=begin; t<end; ++t) {
+            const glm::vec3 centre = (p.position(tris[3*t]) + p.position(tris[3*t + 1]) + p.position(tris[3*t + 2])) * (1.0f / 3.0f);
+            cx[t] = centre.x;
+            cy[t] = centre.y;
+            cz[t] = centre.z;
+        }
+        wind.velocity(&cx[begin], &cy[begin], &cz[begin], end - begin, &wx[begin], &wy[begin], &wz[begin]);
+    });
+}
+
+void Aerodynamics::compute(const int* tris, std::size_t tri_count, const Adjacency& node_tris, const Particles& p,
+                           const WindField& wind, ThreadPool* pool) {
+    if (wx.size() != tri_count)
+        sample_wind(tris, tri_count, p, wind, pool);
+    for (aligned_vector<float>* a : {&nx, &ny, &nz, &vx, &vy, &vz, &fx, &fy, &fz})
+        a->resize(tri_count);
+    const float k = wind.density / 4.0f / 3.0f;
+
+    const float *x = p.x.data(), *y = p.y.data(), *z = p.z.data();
+    const float *pvx = p.vx.data(), *pvy = p.vy.data(), *pvz = p.vz.data();
+    float *tnx = nx.data(), *tny = ny.data(), *tnz = nz.data(), *tvx = vx.data(), *tvy = vy.data(), *tvz = vz.data();
+    parallel_for(pool, 0, tri_count, triangle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t=begin; t<end; ++t) {
+            const int a = tris[3*t], b = tris[3*t + 1], c = tris[3*t + 2];
+            const float abx = x[b] - x[a], aby = y[b] - y[a], abz = z[b] - z[a];
+            const float acx = x[c] - x[a], acy = y[c] - y[a], acz = z[c] - z[a];
+            tnx[t] = aby * acz - abz * acy;
+            tny[t] = abz * acx - abx * acz;
+            tnz[t] = abx * acy - aby * acx;
+            tvx[t] = (pvx[a] + pvx[b] + pvx[c]) * (1.0f / 3.0f);
+            tvy[t] = (pvy[a] + pvy[b] + pvy[c]) * (1.0f / 3.0f);
+            tvz[t] = (pvz[a] + pvz[b] + pvz[c]) * (1.0f / 3.0f);
+        }
+        plate_forces(end - begin, k, wind.drag, wind.lift, tnx + begin, tny + begin, tnz + begin, tvx + begin, tvy + begin, tvz + begin,
+                     wx.data() + begin, wy.data() + begin, wz.data() + begin, fx.data() + begin, fy.data() + begin, fz.data() + begin);
+    });
+
+    const std::size_t count = p.size();
+    ax.resize(count);
+    ay.resize(count);
+    az.resize(count);
+    const float *tfx = fx.data(), *tfy = fy.data(), *tfz = fz.data(), *w = p.w.data();
+    const std::uint32_t* items = node_tris.items.data();
+    float *nax = ax.data(), *nay = ay.data(), *naz = az.data();
+    parallel_for(pool, 0, count, particle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i=begin; i<end; ++i) {
+            float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+            for (std::uint32_t e=node_tris.begin(i); e<node_tris.end(i); ++e) {
+                const std::uint32_t t = items[e];
+                sx += tfx[t];
+                sy += tfy[t];
+                sz += tfz[t];
+            }
+            nax[i] = sx * w[i];
+            nay[i] = sy * w[i];
+            naz[i] = sz * w[i];
+        }
+    });
+}
+}
@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Contains the class Aerodynamics, the wind forces on the triangles of a cloth.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include "cloth/adjacency.h"
+#include "forces/wind.h"
+#include "node/aligned_allocator.h"
+#include "node/particles.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class Aerodynamics
+ * @brief Turns a WindField into accelerations of the particles of a cloth.
+ *
+ * Every triangle is a small flat plate. With u the air velocity at its centre relative to its
+ * mean velocity, n its unit normal turned downstream and cos = n.u/|u|, it feels
+ *
+ *     drag = density/2 * drag coefficient * area * |u| * cos * u
+ *     lift = density/2 * lift coefficient * area * |u|^2 * cos * (n - cos * u/|u|)
+ *
+ * the lift being normal to the flow, largest for a plate at 45 degrees and null for a plate along
+ * or across it. A third of the force goes to each node. The triangles are processed in blocks: a
+ * gather of their nodes, then the forces over plain arrays, which the compiler vectorizes; every
+ * node then sums the forces of its triangles (node_tris), so the pass needs no atomics and its
+ * result does not depend on the pool.
+ */
+class Aerodynamics
+{
+public:
+    /**
+     * Acceleration of every particle after the last compute(), zero for pinned particles
+     */
+    aligned_vector<float> ax, ay, az;
+
+    /**
+     * Sample the wind at the centre of the triangles tris (three node indices each), once per frame:
+     * the cloth moves little across a gust in a frame, and a turbulent source is the costly part
+     */
+    void sample_wind(const int* tris, std::size_t tri_count, const Particles& p, const WindField& wind, ThreadPool* pool);
+    /**
+     * Forces of the sampled wind on the triangles with the current positions and velocities of p,
+     * once per substep; the wind is sampled again if the number of triangles changed
+     */
+    void compute(const int* tris, std::size_t tri_count, const Adjacency& node_tris, const Particles& p,
+                 const WindField& wind, ThreadPool* pool);
+
+private:
+    /**
+     * Per triangle: centre and wind of the frame, area weighted normal, mean velocity and force per
+     * node of the substep
+     */
+    aligned_vector<float> cx, cy, cz, nx, ny, nz, vx, vy, vz, wx, wy, wz, fx, fy, fz;
+};
+}
@@ -7,17 +7,19 @@
  * @copyright 2023 Davide Furlani
  */
 #include <vector>
-#include <filesystem>
 #include <cmath>
+#include <limits>
 #include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <utility>
 #include <glm.hpp>
-#include <gtc/matrix_transform.hpp>
 #include "node/node.h"
 #include "cloth.h"
 #include "constraints/s_constr.h"
 #include "constraints/b_constr.h"
-#include "display/display.h"
-#include "state/state.h"
+#include "constraints/coloring.h"
+#include "constraints/bending_kernel.h"
 
 //#include <iostream> // DEBUG
 
@@ -25,7 +27,7 @@
 
 namespace cloth {
     
-    Cloth::Cloth(int rows, int columns, float size, render::State& s){
+    Cloth::Cloth(int rows, int columns, float size){
         Cloth::rows = rows;
         Cloth::columns = columns;
         
@@ -38,12 +40,17 @@ namespace cloth {
         vec3 normal {0.0, 0.0, 1.0};
         
 //        std::cout << "creo i nodi" << std::endl;
+        particles.reserve(rows*columns);
+        normals.reserve(rows*columns);
+        uvs.reserve(rows*columns);
         size = 1/size;
         for(int i=0; i<rows; ++i){
             for(int j=0; j<columns; ++j){
                 vec3 pos {static_cast<float>(j)/(size*static_cast<float>(columns-1)), static_cast<float>(i)/(size*static_cast<float>(columns-1)), z_constant};
                 vec2 uv_c {static_cast<float>(j)/static_cast<float>(columns-1), static_cast<float>(i)/static_cast<float>(rows-1)};
-                nodes.emplace_back(Node(pos, mass, vel, normal, uv_c));
+                particles.add(Node(pos, mass, vel, normal, uv_c));
+                normals.emplace_back(normal);
+                uvs.emplace_back(uv_c);
             }
         }
 
@@ -59,61 +66,86 @@ namespace cloth {
         
 //        std::cout << "genero gli s_constr" << std::endl;
         generate_bend_constraints();
-        
-        // robe per rendering
+    }
 
-        std::vector<float> cloth_verts_data = get_GL_tris();
+    Cloth::Cloth(TriangleMesh mesh, float weld_tolerance, float mass){
+        rows = 0;
+        columns = 0;
         
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-
-        glBindVertexArray(VAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, cloth_verts_data.size() * sizeof(float), &cloth_verts_data.front(), GL_DYNAMIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3*sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6*sizeof(float)));
-        glEnableVertexAttribArray(2);
-
-
-        std::filesystem::path texture_p {"resources/Textures/tex1.jpg"};
-        texture = render::load_textures(texture_p);
-
-        shader.use();
-
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)s.scr_width / (float)s.scr_height, 0.1f, 100.0f);
-        shader.setMat4("uniProjMatrix", projection);
-
-        shader.setInt("uniTex", 0);
-        shader.setVec3("uniLightPos", glm::vec3(0.0, 0.0, 1.0));
-        shader.setVec3("uniLightColor", glm::vec3(1.0, 1.0, 1.0));
+        weld_vertices(mesh, weld_tolerance);
+        const std::size_t n = mesh.vertices.size();
+        if (n == 0 || mesh.indices.empty())
+            throw std::invalid_argument("cloth mesh has no triangles");
+        
+        vec3 lo {std::numeric_limits<float>::max()}, hi {std::numeric_limits<float>::lowest()};
+        for (const auto& v : mesh.vertices) {
+            lo = glm::min(lo, v);
+            hi = glm::max(hi, v);
+        }
+        const vec3 extent = glm::max(hi - lo, vec3(std::numeric_limits<float>::min()));
         
+        vec3 vel {0.0};
+        vec3 normal {0.0, 0.0, 1.0};
+        particles.reserve(n);
+        normals.reserve(n);
+        uvs.reserve(n);
+        for (std::size_t i=0; i<n; ++i) {
+            const vec3& pos = mesh.vertices[i];
+            vec2 uv_c = mesh.uvs.empty() ? vec2((pos.x - lo.x) / extent.x, (pos.y - lo.y) / extent.y) : mesh.uvs[i];
+            particles.add(Node(pos, mass, vel, normal, uv_c));
+            normals.emplace_back(normal);
+            uvs.emplace_back(uv_c);
+        }
+        
+        all_tris.reserve(mesh.triangle_count());
+        for (std::size_t t=0; t<mesh.triangle_count(); ++t)
+            all_tris.push_back(triangle_struct{static_cast<int>(mesh.indices[3*t]), static_cast<int>(mesh.indices[3*t + 1]), static_cast<int>(mesh.indices[3*t + 2])});
+        generate_topology();
+        
+        // the two ends of the lowest row, like the corners pinned on a grid
+        int first = 0, last = 0;
+        for (std::size_t i=1; i<n; ++i) {
+            const vec3& p = mesh.vertices[i];
+            const vec3& f = mesh.vertices[first];
+            const vec3& l = mesh.vertices[last];
+            if (p.y < f.y || (p.y == f.y && p.x < f.x))
+                first = static_cast<int>(i);
+            if (p.y < l.y || (p.y == l.y && p.x > l.x))
+                last = static_cast<int>(i);
+        }
+        pin1(first);
+        pin2(last);
+        
+        generate_stretch_constraints();
+        generate_bend_constraints();
+        compute_normals();
+    }
+
+    Node Cloth::node(int index) const {
+        Node n {particles.position(index), particles.m.at(index), particles.velocity(index), normals.at(index), uvs.at(index)};
+        n.prev_pos = particles.prev_position(index);
+        n.w = particles.w.at(index);
+        return n;
     }
 
     void Cloth::pin1(int index) {
-        nodes.at(pin1_index).m = std::numeric_limits<float>::infinity();
-        nodes.at(pin1_index).w = 0.0;
         pin1_index = index;
+        particles.w.at(pin1_index) = 0.0;
+        generate_tethers();
     }
     void Cloth::pin2(int index) {
-        nodes.at(pin2_index).m = std::numeric_limits<float>::infinity();
-        nodes.at(pin2_index).w = 0.0;
         pin2_index = index;
+        particles.w.at(pin2_index) = 0.0;
+        generate_tethers();
     }
 
     void Cloth::unpin1() {
-        nodes.at(pin1_index).m = 0.0;
-        nodes.at(pin1_index).w = std::numeric_limits<float>::infinity();
+        particles.w.at(pin1_index) = 1.0 / particles.m.at(pin1_index);
+        generate_tethers();
     }
     void Cloth::unpin2() {
-        nodes.at(pin2_index).m = 0.0;
-        nodes.at(pin2_index).w = std::numeric_limits<float>::infinity();
+        particles.w.at(pin2_index) = 1.0 / particles.m.at(pin2_index);
+        generate_tethers();
     }
 
     void Cloth::generate_verts() {
@@ -140,251 +172,397 @@ namespace cloth {
         
         all_tris.insert(all_tris.end(), up_left_tris.begin(), up_left_tris.end());
         all_tris.insert(all_tris.end(), low_right_tris.begin(), low_right_tris.end());
+        generate_topology();
+    }
+
+    void Cloth::generate_topology() {
         
-        for(auto t : up_left_tris){
-            verts.emplace_back(t.a);
-            verts.emplace_back(t.b);
-            verts.emplace_back(t.c);
-        }
-        for(auto t : low_right_tris){
-            verts.emplace_back(t.a);
-            verts.emplace_back(t.b);
-            verts.emplace_back(t.c);
-        }
+        static_assert(sizeof(triangle_struct) == 3 * sizeof(int), "triangle_struct must be three packed indices");
+        topology = build_topology(reinterpret_cast<const std::uint32_t*>(tri_indices()), all_tris.size());
+        node_tris.build(tri_indices(), all_tris.size(), 3, particles.size());
+        face_normals.resize(all_tris.size());
+        tearing.topology_stale = false;
     }
 
     void Cloth::generate_stretch_constraints() {
         
-        if(up_left_tris.empty())
+        if(all_tris.empty())
             generate_verts();
+        else if (tearing.topology_stale)
+            generate_topology();
         
-        for (auto t : up_left_tris){
-            s_cs.emplace_back(nodes.at(t.a), nodes.at(t.b));
-//            s_cs.emplace_back(nodes.at(t.b), nodes.at(t.c));
-            s_cs.emplace_back(nodes.at(t.a), nodes.at(t.c));
+        // one constraint per unique edge of the triangles; a generated grid keeps its rows and
+        // columns only, the diagonal of every cell (b-c of the upper left triangle, a-c of the lower
+        // right one) has no constraint so that the grid is not stiffer in shear
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> diagonals;
+        if (up_left_tris.size() + low_right_tris.size() == all_tris.size()) {
+            auto edge = [](int i, int j) {
+                return std::pair<std::uint32_t, std::uint32_t>(std::min(i, j), std::max(i, j));
+            };
+            for (const triangle_struct& t : up_left_tris)
+                diagonals.push_back(edge(t.b, t.c));
+            for (const triangle_struct& t : low_right_tris)
+                diagonals.push_back(edge(t.a, t.c));
+            std::sort(diagonals.begin(), diagonals.end());
         }
-        
-        for(int i=columns-1; i<columns*(rows-1); i+=columns){
-            s_cs.emplace_back(nodes.at(i), nodes.at(i+columns));
-        }
-        for(int i=columns*(rows-1); i<(rows*columns)-1; ++i){
-            s_cs.emplace_back(nodes.at(i), nodes.at(i+1));
+        s_cs.clear();
+        s_cs.set_index_width(particles.size());
+        s_cs.reserve(topology.edge_count());
+        for (std::size_t e=0; e<topology.edge_count(); ++e) {
+            const std::pair<std::uint32_t, std::uint32_t> key {topology.edge_v0[e], topology.edge_v1[e]};
+            if (!std::binary_search(diagonals.begin(), diagonals.end(), key))
+                s_cs.add(particles, key.first, key.second, StretchConstraints::default_compliance);
         }
-
-
-//        std::cout << "fine generazione constr" << std::endl;
+        
+        color_constraints(s_cs, particles.size());
+        s_jacobi.invalidate();
+        self_collision.set_links(s_cs, particles.size());
+        generate_tethers();
+        ++constraint_revision;
+    }
+    
+    void Cloth::generate_tethers() {
+        // the geodesic distances follow the stretch constraints, none before they exist
+        tethers.build(particles, s_cs);
+        ++constraint_revision;
     }
 
     void Cloth::generate_bend_constraints() {
         
         if(all_tris.empty())
             generate_verts();
+        else if (tearing.topology_stale)
+            generate_topology();
         
-//        std::vector<std::pair<int, int>> edges {};
-//        
-//        int num_tris = low_right_tris.size() + up_left_tris.size();
-//        for (int i=0; i< num_tris; ++i){
-//            int id1 = all_tris.at(i).a;
-//            int id2 = all_tris.at(i).b;
-//            edges.emplace_back(min(id1, id2), max(id1, id2));
-//            id1 = all_tris.at(i).b;
-//            id2 = all_tris.at(i).c;
-//            edges.emplace_back(min(id1, id2), max(id1, id2));
-//            id1 = all_tris.at(i).a;
-//            id2 = all_tris.at(i).c;
-//            edges.emplace_back(min(id1, id2), max(id1, id2));
-//        }
-//
-//        std::sort(edges.begin(), edges.end());
-//        std
-//        
-//        int nr = 0;
-//        while(nr < edges.size()){
-//            auto e0 = edges.at(nr);
-//            nr++;
-//            if(nr<edges.size()){
-//                auto e1 = edges.at(nr);
-//                if(e0.first == e1.first && e0.second == e1.second){
-//                    
-//                }
-//                nr++;
-//            }
-//        }
-//              TODO
-
-        for(int i=0; i<rows-1; ++i){
-            for(int j=0; j<columns-1; ++j){
-                b_cs.emplace_back(nodes.at(i*columns+j), nodes.at((i*columns+j)+8));
-            }
+        b_cs.clear();
+        b_cs.set_index_width(particles.size());
+        dihedral_cs.clear();
+        isometric_cs.clear();
+        switch (bend_model) {
+            case BendModel::Distance:
+                // one constraint per hinge, between the two vertices opposite to the shared edge
+                b_cs.reserve(topology.hinges.size());
+                for (const Hinge& h : topology.hinges)
+                    b_cs.add(particles, h.a, h.b, BendConstraints::default_compliance);
+                color_constraints(b_cs, particles.size());
+                break;
+            case BendModel::Dihedral:
+                dihedral_cs.reserve(topology.hinges.size());
+                for (const Hinge& h : topology.hinges)
+                    dihedral_cs.add(particles, h.v0, h.v1, h.a, h.b, DihedralBendConstraints::default_compliance);
+                color_constraints(dihedral_cs, particles.size());
+                break;
+            case BendModel::Isometric:
+                isometric_cs.reserve(topology.hinges.size());
+                for (const Hinge& h : topology.hinges)
+                    isometric_cs.add(particles, h.v0, h.v1, h.a, h.b, IsometricBendConstraints::default_compliance);
+                color_constraints(isometric_cs, particles.size());
+                break;
         }
-        for(int i=1; i<rows; ++i){
-            for(int j=0; j<columns-2; ++j){
-                b_cs.emplace_back(nodes.at(i*columns+j), nodes.at((i*columns+j)-5));
-            }
-        }
-        for(int i=0; i<rows-2; ++i){
-            for(int j=1; j<columns; ++j){
-                b_cs.emplace_back(nodes.at(i*columns+j), nodes.at((i*columns+j)+13));
-            }
-        }        
+        b_jacobi.invalidate();
+        ++constraint_revision;
     }
     
-    std::vector<float> Cloth::get_GL_tris() {
-        std::vector<float> v_array {};
-        
-        if(verts.empty())
-            generate_verts();
-            
-            
-        for(auto i : verts){
-            Node& n = nodes.at(i);
-            v_array.emplace_back(n.pos.x);
-            v_array.emplace_back(n.pos.y);
-            v_array.emplace_back(n.pos.z);
-            v_array.emplace_back(n.n.x);
-            v_array.emplace_back(n.n.y);
-            v_array.emplace_back(n.n.z);
-            v_array.emplace_back(n.uv_c.x);
-            v_array.emplace_back(n.uv_c.y);
-
-        }
-
-        return v_array;
+    void Cloth::set_bend_model(BendModel model) {
+        bend_model = model;
+        generate_bend_constraints();
     }
-
+    
+    // minimum number of particles / constraints handed to a thread
+    static constexpr std::size_t particle_grain = 4096;
+    static constexpr std::size_t constraint_grain = 512;
+    
+    void Cloth::compute_face_normals() {
+        cloth::compute_face_normals(tri_indices(), all_tris.size(), particles.x.data(), particles.y.data(), particles.z.data(),
+                                    face_normals.data(), pool);
+    }
+    
     void Cloth::compute_normals() {
-        /** Reset nodes' normal **/
-        vec3 normal(0.0, 0.0, 0.0);
-        for (auto& n : nodes) {
-            n.n = normal;
-        }
+        ScopedPhase phase {profiler, Phase::Normals};
+        compute_face_normals();
+        /** gather, every node only writes its own normal **/
+        parallel_for(pool, 0, particles.size(), particle_grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i=begin; i<end; ++i)
+                normals[i] = gather_normal(i);
+        });
+    }
+    
+    void Cloth::simulate_XPBD(const SimSettings& s) {
         
-        for(auto t : up_left_tris){
-            Node& n1 = nodes.at(t.a);
-            Node& n2 = nodes.at(t.b);
-            Node& n3 = nodes.at(t.c);
-            normal = cross(n2.pos - n1.pos, n3.pos - n1.pos);
-            n1.n += normal;
-            n2.n += normal;
-            n3.n += normal;
+        if (s.sleeping || islands.sleeping())
+            XPBD_update_islands(s);
+        if (islands.all_asleep()) {
+            // nothing moves, so nothing can touch the cloth either
+            last_substeps = 0;
+            return;
         }
-        for(auto t : low_right_tris){
-            Node& n1 = nodes.at(t.a);
-            Node& n2 = nodes.at(t.b);
-            Node& n3 = nodes.at(t.c);
-            normal = cross(n2.pos - n1.pos, n3.pos - n1.pos);
-            n1.n += normal;
-            n2.n += normal;
-            n3.n += normal;
+        const int substeps = s.adaptive_substeps ? substep_control.next(particles, s_cs, s, pool) : s.iteration_per_frame;
+        last_substeps = substeps;
+        float timestep = s.frame_time/substeps; // a frame is always frame_time seconds, FixedTimestep decides how many frames run
+        if (s.self_collision || (colliders && !colliders->empty())) {
+            XPBD_find_contacts(s);
+            if (s.self_collision)
+                islands.wake_touched(self_collision.offsets, self_collision.candidates);
         }
-        
-        for (auto& n : nodes) {
-            n.n = normalize(n.n);
+        if (islands.take_changes()) {
+            if (islands.sleeping())
+                awake.build(islands, particles.size(), s_cs, b_cs, dihedral_cs, isometric_cs, tethers);
+            s_jacobi.invalidate();
+            b_jacobi.invalidate();
         }
-    }
-    
-    void Cloth::render(render::Camera& c) {
-        
-        compute_normals();
-        std::vector<float> cloth_verts_data = get_GL_tris();
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, cloth_verts_data.size() * sizeof(float), &cloth_verts_data.front(), GL_DYNAMIC_DRAW);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        shader.use();
-        mat4 view = lookAt(c.pos, c.pos + c.front_v, c.up_v);
-        shader.setMat4("uniViewMatrix", view);
-        glBindVertexArray(VAO);
-
-        mat4 model = mat4(1.0f);
-        shader.setMat4("uniModelMatrix", model);
-        glDrawArrays(GL_TRIANGLES, 0, cloth_verts_data.size()/8.0);
-        
+        const bool blowing = blown();
+        if (blowing) {
+            ScopedPhase phase {profiler, Phase::Wind};
+            aerodynamics.sample_wind(tri_indices(), all_tris.size(), particles, *wind, pool);
+        }
+        for(int i=0; i< substeps; ++i){
+            if (blowing) {
+                // with the velocities at the start of the substep, like gravity
+                ScopedPhase phase {profiler, Phase::Wind};
+                aerodynamics.compute(tri_indices(), all_tris.size(), node_tris, particles, *wind, pool);
+            }
+            XPBD_predict(timestep, s.gravity);
+            XPBD_solve_constraints(timestep);
+            if (s.self_collision)
+                XPBD_solve_self_collisions();
+            // last, so that the other passes cannot pull a node back past its tether
+            if (s.long_range_attachments)
+                XPBD_solve_tethers();
+            XPBD_update_velocity(timestep);
+        }
+        if (s.sleeping)
+            islands.update(particles, s.sleep_speed, s.sleep_frames, pool);
+        if (s.tearing)
+            XPBD_tear(s);
     }
 
-    void Cloth::free_resources() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        shader.destroy();
+    void Cloth::XPBD_update_islands(const SimSettings& s) {
+        if (!s.sleeping) {
+            islands.wake_all();
+            return;
+        }
+        if (islands_revision != constraint_revision || islands.of.size() != particles.size()) {
+            // pins and regenerated constraints give new islands, all awake
+            islands.build(s_cs, particles.size());
+            islands_revision = constraint_revision;
+        } else if (s.gravity != islands_gravity || blown()) {
+            // the wind reaches every island
+            islands.wake_all();
+        }
+        islands_gravity = s.gravity;
     }
 
-    void Cloth::simulate_XPBD(render::State& s) {
-        
-        float timestep = (1.0/60.0)/s.iteration_per_frame; // frame indipendent, la velocità della simulazione è come se fosse costante a 60 frame al secondo, se non riesce a generare 60 frame al secondo la simulazione sembra rallentata
-        //float timestep = (s.delta_time)/iteration_per_frame; // la simulazione dovrebbe avere velocità costante
-        for(int i=0; i< s.iteration_per_frame; ++i){
-            XPBD_predict(timestep, s.gravity);
-            XPBD_solve_constraints(timestep, s);
-            XPBD_update_velocity(timestep);
+    /**
+     * Call f(i) for every particle that is not asleep, in parallel on pool
+     */
+    template <typename F>
+    static void for_awake_particles(std::size_t count, const Islands& islands, const AwakeConstraints& awake, ThreadPool* pool, F&& f) {
+        if (islands.sleeping() == 0) {
+            parallel_for(pool, 0, count, particle_grain, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i=begin; i<end; ++i)
+                    f(i);
+            });
+            return;
         }
+        const std::uint32_t* active = awake.particles.data();
+        parallel_for(pool, 0, awake.particles.size(), particle_grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k=begin; k<end; ++k)
+                f(active[k]);
+        });
     }
+    
     void Cloth::XPBD_predict(float t, glm::vec3 g){
+        ScopedPhase phase {profiler, Phase::Predict};
         /** Nodes **/
-        for (int i=0; i<nodes.size(); ++i) {
-            if (nodes.at(i).w == 0.0)
-                continue;
-                
-            nodes.at(i).vel += g * t;
-            nodes.at(i).prev_pos = nodes.at(i).pos;
-            nodes.at(i).pos += nodes.at(i).vel * t;
+        float* x = particles.x.data();
+        float* y = particles.y.data();
+        float* z = particles.z.data();
+        float* px = particles.px.data();
+        float* py = particles.py.data();
+        float* pz = particles.pz.data();
+        float* vx = particles.vx.data();
+        float* vy = particles.vy.data();
+        float* vz = particles.vz.data();
+        const float* w = particles.w.data();
+        if (blown()) {
+            const float* ax = aerodynamics.ax.data();
+            const float* ay = aerodynamics.ay.data();
+            const float* az = aerodynamics.az.data();
+            for_awake_particles(particles.size(), islands, awake, pool, [&](std::size_t i) {
+                if (w[i] == 0.0)
+                    return;
+
+                vx[i] += (g.x + ax[i]) * t;
+                vy[i] += (g.y + ay[i]) * t;
+                vz[i] += (g.z + az[i]) * t;
+                px[i] = x[i];
+                py[i] = y[i];
+                pz[i] = z[i];
+                x[i] += vx[i] * t;
+                y[i] += vy[i] * t;
+                z[i] += vz[i] * t;
+            });
+            return;
         }
+        for_awake_particles(particles.size(), islands, awake, pool, [&](std::size_t i) {
+            if (w[i] == 0.0)
+                return;
+                
+            vx[i] += g.x * t;
+            vy[i] += g.y * t;
+            vz[i] += g.z * t;
+            px[i] = x[i];
+            py[i] = y[i];
+            pz[i] = z[i];
+            x[i] += vx[i] * t;
+            y[i] += vy[i] * t;
+            z[i] += vz[i] * t;
+        });
+    }
+    void Cloth::XPBD_find_contacts(const SimSettings& s) {
+        ScopedPhase phase {profiler, Phase::Collision};
+        // how far a particle can move in the frame, counting what gravity adds to its speed
+        const float frame = static_cast<float>(s.frame_time);
+        const float travel = (max_particle_speed(particles, pool) + glm::length(s.gravity) * frame) * frame;
+        // two particles close in on each other at most twice as fast; the margin is capped so that a
+        // fast cloth does not gather huge candidate lists, faster pairs are caught next frame
+        if (s.self_collision)
+            self_collision.find_candidates(particles, std::min(2.0f * travel, self_collision.distance()), pool);
+        if (colliders && !colliders->empty())
+            collider_contacts.broadphase(*colliders, particles, travel, pool);
+    }
+
+    void Cloth::XPBD_solve_colliders(float timeStep) {
+        ScopedPhase phase {profiler, Phase::Collision};
+        collider_contacts.solve(*colliders, particles, timeStep, pool);
+    }
+
+    void Cloth::XPBD_solve_self_collisions() {
+        ScopedPhase phase {profiler, Phase::Collision};
+        self_collision.solve(particles, pool);
     }
-    void Cloth::XPBD_solve_constraints(float t, render::State& s){
-        XPBD_solve_stretching(t, s);
+
+    void Cloth::XPBD_solve_constraints(float t){
+        XPBD_solve_stretching(t);
         XPBD_solve_bending(t);
+        if (colliders && !colliders->empty())
+            XPBD_solve_colliders(t);
         
     }
-    void Cloth::XPBD_solve_stretching(float timeStep, render::State& state) {
+    
+    /**
+     * Gauss-Seidel sweep over a set of distance constraints. Colours are processed in order, the
+     * constraints inside a colour share no particle and are split across the pool, so the result
+     * does not depend on the number of threads.
+     */
+    static void solve_distance_constraints(Particles& p, const DistanceConstraints& cs, float timeStep, ThreadPool* pool, SimdLevel simd) {
+        const DistanceKernelData d {p.x.data(), p.y.data(), p.z.data(), p.w.data(),
+                                    cs.rest_dist.data(), cs.compliance.data(), timeStep};
+        cs.with_indices([&](const auto* first, const auto* second) {
+            if (cs.colors() == 0) {
+                // without colours the constraints are not independent, keep the plain sequential sweep
+                solve_distance_range(SimdLevel::Scalar, d, first, second, 0, cs.size());
+                return;
+            }
+            auto sweep = [&](std::size_t begin, std::size_t end) {
+                solve_distance_range(simd, d, first, second, begin, end);
+            };
+            for (std::size_t c=0; c<cs.colors(); ++c)
+                parallel_for(pool, cs.color_offsets[c], cs.color_offsets[c+1], constraint_grain, sweep);
+        });
+    }
+    
+    void Cloth::XPBD_solve_tethers() {
+        ScopedPhase phase {profiler, Phase::Tethers};
+        (islands.sleeping() ? awake.tethers : tethers).solve(particles, pool);
+    }
+    
+    void Cloth::XPBD_solve_stretching(float timeStep) {
+        ScopedPhase phase {profiler, Phase::Stretch};
         
-        for (auto& s_c : s_cs) {
-            float alpha = s_c.compliance / timeStep / timeStep;
-            if (s_c.nodes.first.w + s_c.nodes.second.w == 0.0)
-                continue;
-            vec3 distance = s_c.nodes.first.pos - s_c.nodes.second.pos;
-            float abs_distance = sqrt(distance.x * distance.x + distance.y * distance.y + distance.z * distance.z);
-            
-            if (abs_distance == 0.0) 
-                continue;
-            distance *= 1 / abs_distance;
-
-            float rest_len = s_c.rest_dist;
-            float C = abs_distance - rest_len;
-            float s = -C / static_cast<float>((s_c.nodes.first.w + s_c.nodes.second.w) + alpha);
-            
-            s_c.nodes.first.pos += distance * static_cast<float>(s) * s_c.nodes.first.w;
-            s_c.nodes.second.pos += distance * static_cast<float>(-s) * s_c.nodes.second.w;
-            
-            
-        }
+        const DistanceConstraints& stretch = islands.sleeping() ? awake.stretch : s_cs;
+        if (solver_mode == SolverMode::Jacobi)
+            s_jacobi.solve(particles, stretch, timeStep, jacobi_relaxation, pool);
+        else
+            solve_distance_constraints(particles, stretch, timeStep, pool, simd_level);
     }
+    /**
+     * Coloured Gauss-Seidel sweep over a set of hinge constraints, in both solver modes: the hinges
+     * of a colour are already independent
+     */
+    template <typename Hinges, typename Kernel>
+    static void solve_hinge_constraints(Particles& p, const Hinges& cs, HingeKernelData d, ThreadPool* pool, Kernel&& kernel) {
+        d.x = p.x.data();
+        d.y = p.y.data();
+        d.z = p.z.data();
+        d.w = p.w.data();
+        d.p0 = cs.p0.data();
+        d.p1 = cs.p1.data();
+        d.p2 = cs.p2.data();
+        d.p3 = cs.p3.data();
+        d.compliance = cs.compliance.data();
+        for (std::size_t c=0; c<cs.colors(); ++c)
+            parallel_for(pool, cs.color_offsets[c], cs.color_offsets[c+1], constraint_grain, [&](std::size_t begin, std::size_t end) {
+                kernel(d, begin, end);
+            });
+    }
+    
     void Cloth::XPBD_solve_bending(float timeStep) {
+        ScopedPhase phase {profiler, Phase::Bend};
         
-        for (auto& b_c : b_cs) {
-            float alpha = b_c.compliance / timeStep / timeStep;
-            if (b_c.nodes.first.w + b_c.nodes.second.w == 0.0)
-                continue;
-            vec3 distance = b_c.nodes.first.pos - b_c.nodes.second.pos;
-            float abs_distance = sqrt(distance.x * distance.x + distance.y * distance.y + distance.z * distance.z);
-            if (abs_distance == 0.0)
-                continue;
-            distance *= 1 / abs_distance;
-
-            float rest_len = b_c.rest_dist;
-            float C = abs_distance - rest_len;
-            float s = -C / ((b_c.nodes.first.w + b_c.nodes.second.w) + alpha);
-
-            b_c.nodes.first.pos += distance * s * b_c.nodes.first.w;
-            b_c.nodes.second.pos += distance * -s * b_c.nodes.second.w;
+        // only the set of the bending model is filled, except in the arena of a Scene whose cloths
+        // may use different models; while islands sleep only their awake part is solved
+        const bool partial = islands.sleeping() > 0;
+        const DihedralBendConstraints& dihedral = partial ? awake.dihedral : dihedral_cs;
+        const IsometricBendConstraints& isometric = partial ? awake.isometric : isometric_cs;
+        const DistanceConstraints& bend = partial ? awake.bend : b_cs;
+        if (!dihedral.empty()) {
+            HingeKernelData d {};
+            d.rest = dihedral.rest_angle.data();
+            d.timeStep = timeStep;
+            solve_hinge_constraints(particles, dihedral, d, pool, [&](const HingeKernelData& k, std::size_t begin, std::size_t end) {
+                solve_dihedral_range(simd_level, k, begin, end);
+            });
+        }
+        if (!isometric.empty()) {
+            HingeKernelData d {};
+            d.k0 = isometric.k0.data();
+            d.k1 = isometric.k1.data();
+            d.k2 = isometric.k2.data();
+            d.k3 = isometric.k3.data();
+            d.scale = isometric.scale.data();
+            d.timeStep = timeStep;
+            solve_hinge_constraints(particles, isometric, d, pool, [&](const HingeKernelData& k, std::size_t begin, std::size_t end) {
+                solve_isometric_range(simd_level, k, begin, end);
+            });
         }
+        if (bend.empty())
+            return;
+        if (solver_mode == SolverMode::Jacobi)
+            b_jacobi.solve(particles, bend, timeStep, jacobi_relaxation, pool);
+        else
+            solve_distance_constraints(particles, bend, timeStep, pool, simd_level);
     }
     void Cloth::XPBD_update_velocity(float t){
+        ScopedPhase phase {profiler, Phase::Velocity};
         /** Nodes **/
-        for (auto& n : nodes) {
-            if (n.w == 0.0)
-                continue;
-            n.vel = (n.pos - n.prev_pos) * static_cast<float>(1.0)/t;
-            //n.vel *= damping;
-        }
+        const float* x = particles.x.data();
+        const float* y = particles.y.data();
+        const float* z = particles.z.data();
+        const float* px = particles.px.data();
+        const float* py = particles.py.data();
+        const float* pz = particles.pz.data();
+        float* vx = particles.vx.data();
+        float* vy = particles.vy.data();
+        float* vz = particles.vz.data();
+        const float* w = particles.w.data();
+        for_awake_particles(particles.size(), islands, awake, pool, [&](std::size_t i) {
+            if (w[i] == 0.0)
+                return;
+            vx[i] = (x[i] - px[i]) / t;
+            vy[i] = (y[i] - py[i]) / t;
+            vz[i] = (z[i] - pz[i]) / t;
+        });
     }
 
-}
\ No newline at end of file
+}
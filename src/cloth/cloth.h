@@ -8,36 +8,128 @@
  */
 
 #pragma once
+#include <cstdint>
 #include <vector>
+#include <glm.hpp>
 #include "node/node.h"
+#include "node/particles.h"
 #include "constraints/s_constr.h"
 #include "constraints/b_constr.h"
-#include "state/state.h"
-#include "display/shader.h"
-#include "display/camera.h"
+#include "constraints/h_constr.h"
+#include "constraints/tethers.h"
+#include "constraints/jacobi.h"
+#include "constraints/distance_kernel.h"
+#include "cloth/settings.h"
+#include "cloth/profiler.h"
+#include "cloth/adjacency.h"
+#include "cloth/normals.h"
+#include "cloth/timestep.h"
+#include "cloth/islands.h"
+#include "cloth/aerodynamics.h"
+#include "cloth/tearing.h"
+#include "collision/self_collision.h"
+#include "collision/collider_set.h"
+#include "mesh/triangle_mesh.h"
+#include "mesh/topology.h"
+#include "parallel/thread_pool.h"
 
 namespace cloth{
+/**
+ * Constraint projection scheme used by the XPBD solver
+ */
+enum class SolverMode {
+    GaussSeidel,    ///< in-place coloured Gauss-Seidel, best convergence
+    Jacobi          ///< averaged Jacobi, converges slower but every constraint is independent
+};
+
+/**
+ * Bending model, see Cloth::set_bend_model
+ */
+enum class BendModel {
+    Distance,   ///< distance constraint across every hinge, stiffness depends on the resolution
+    Dihedral,   ///< angle between the two triangles of a hinge, handles curved rest shapes
+    Isometric   ///< quadratic energy of Bergou et al., cheapest, for cloth flat at rest
+};
+
+/**
+ * @class Cloth
+ * @brief Simulation state of a cloth: nodes, constraints and the XPBD solver. It does not touch
+ * OpenGL, the GPU side lives in render::ClothRenderer which only reads from it.
+ */
 class Cloth
 {
 public:
     // physics
-    std::vector<Node> nodes;
+    Particles particles;
     //float damping = 0.9999;
-    std::vector<StretchConstraint> s_cs;
-    std::vector<BendConstraint> b_cs;
+    StretchConstraints s_cs;
+    BendConstraints b_cs;
+    DihedralBendConstraints dihedral_cs;
+    IsometricBendConstraints isometric_cs;
+    /**
+     * Tethers from the pinned nodes, rebuilt whenever a node is pinned or unpinned
+     */
+    LongRangeAttachments tethers;
     int pin1_index;
     int pin2_index;
-    
-    // rendering
-    
     /**
-     * lista degli indici di tutti i nodi duplicati per ogni triangolo per poi mandarli al rendering
+     * Worker pool for the parallel passes, the solver runs serially when null
+     */
+    ThreadPool* pool = nullptr;
+    /**
+     * Phase timings are accumulated here when not null
+     */
+    Profiler* profiler = nullptr;
+    /**
+     * Projection scheme, can be changed between two frames
      */
-    std::vector<int> verts;
+    SolverMode solver_mode = SolverMode::GaussSeidel;
+    /**
+     * Over-relaxation factor of the Jacobi mode
+     */
+    float jacobi_relaxation = 1.5;
+    /**
+     * Instruction set of the Gauss-Seidel distance kernel, every level gives the same result
+     */
+    SimdLevel simd_level = best_simd_level();
+    JacobiSolver s_jacobi;
+    JacobiSolver b_jacobi;
+    /**
+     * Picks the substeps of every frame when SimSettings::adaptive_substeps is set
+     */
+    SubstepController substep_control;
+    /**
+     * Substeps run by the last call to simulate_XPBD
+     */
+    int last_substeps = 0;
+    /**
+     * Particle contacts, used when SimSettings::self_collision is set
+     */
+    SelfCollision self_collision;
+    /**
+     * Static obstacles, shared with other cloths; null = none
+     */
+    ColliderSet* colliders = nullptr;
+    ColliderContacts collider_contacts;
+    /**
+     * Wind, shared with other cloths; null = none
+     */
+    WindField* wind = nullptr;
+    Aerodynamics aerodynamics;
+    /**
+     * Connected parts of the cloth and which of them sleep, used when SimSettings::sleeping is set
+     */
+    Islands islands;
+    /**
+     * Constraints of every particle and journal of the rewritten triangles, used when
+     * SimSettings::tearing is set
+     */
+    Tearing tearing;
+    
+    // rendering attributes, one per particle, never touched by the solver
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
     
-    unsigned VAO, VBO;
-    Shader shader {"resources/Shaders/ClothVS.glsl", "resources/Shaders/ClothFS.glsl"};
-    unsigned int texture;
     //temporaneo
     int rows;
     int columns;
@@ -48,9 +140,37 @@ public:
     std::vector<triangle_struct> up_left_tris;
     std::vector<triangle_struct> low_right_tris;
     std::vector<triangle_struct> all_tris;
+    /**
+     * Unique edges and hinges of all_tris, the constraints are generated from them
+     */
+    MeshTopology topology;
+    /**
+     * Triangles (indices in all_tris) incident to every node, built with all_tris
+     */
+    Adjacency node_tris;
+    /**
+     * Unnormalized (area weighted) normal of every triangle of all_tris, scratch of compute_normals
+     */
+    std::vector<glm::vec3> face_normals;
     // fine temporaneo
     
-    Cloth(int rows, int columns, float size, render::State& s);
+    Cloth(int rows, int columns, float size);
+    /**
+     * Cloth from a triangle mesh, e.g. a garment loaded with load_mesh. Coincident vertices are
+     * welded first; the two lowest (smallest y) vertices at the ends of the x range are pinned,
+     * as the first row of a grid is.
+     * @param mesh triangles, uvs are projected on the xy bounding box when the mesh has none
+     * @param weld_tolerance vertices closer than this are merged, 0 = exact duplicates only
+     * @param mass mass of every node
+     */
+    Cloth(TriangleMesh mesh, float weld_tolerance = 0.0f, float mass = 1.0f);
+    
+    /**
+     * Copy of a node assembled from the particle arrays (debug/inspection only)
+     * @param index
+     * @return node
+     */
+    Node node(int index) const;
     
     void pin1(int index);
     void pin2(int index);
@@ -59,23 +179,116 @@ public:
     void unpin2();
     
     void generate_verts();
-    
-    std::vector<float> get_GL_tris();
+    /**
+     * Build topology, node_tris and the normals scratch once all_tris is filled
+     */
+    void generate_topology();
     
     void generate_stretch_constraints();
+    /**
+     * Generate the constraints of the current bending model, the other sets are left empty
+     */
     void generate_bend_constraints();
+    /**
+     * Switch bending model. The rest shape of the new constraints is the current one, so this is
+     * meant to be called before simulating.
+     */
+    void set_bend_model(BendModel model);
+    /**
+     * Rebuild the tethers from the nodes pinned now and the stretch constraints
+     */
+    void generate_tethers();
+    BendModel get_bend_model() const { return bend_model; }
+    /**
+     * Incremented whenever a constraint set is regenerated, so that a Scene knows when to repack
+     */
+    std::uint64_t revision() const { return constraint_revision; }
     
+    /**
+     * Compute the area weighted normal of every triangle (in parallel on pool)
+     */
+    void compute_face_normals();
+    /**
+     * Normal of node i from face_normals: sum over its incident triangles, normalized
+     */
+    glm::vec3 gather_normal(std::size_t i) const { return cloth::gather_normal(node_tris, face_normals.data(), i); }
+    /**
+     * The triangle list as three packed node indices per triangle
+     */
+    const int* tri_indices() const { return reinterpret_cast<const int*>(all_tris.data()); }
     void compute_normals();
-    void render(render::Camera& c);
 
-    void simulate_XPBD (render::State& s);
+    /**
+     * Advance the cloth by one frame of s.frame_time seconds
+     */
+    void simulate_XPBD (const SimSettings& s);
     void XPBD_predict(float t, glm::vec3 g);
-    void XPBD_solve_constraints(float t, render::State& s);
+    void XPBD_solve_constraints(float t);
     void XPBD_update_velocity(float t);
-    void XPBD_solve_stretching(float timeStep, render::State& s);
+    void XPBD_solve_stretching(float timeStep);
     void XPBD_solve_bending(float timeStep);
+    void XPBD_solve_tethers();
+    /**
+     * Gather the particle pairs and the particle - collider pairs that may touch during the frame,
+     * once per frame
+     */
+    void XPBD_find_contacts(const SimSettings& s);
+    void XPBD_solve_colliders(float timeStep);
+    void XPBD_solve_self_collisions();
+    /**
+     * Keep the islands up to date with the constraints and wake them on pin or gravity changes and
+     * on contacts, then rebuild the awake constraints if the sleeping islands changed
+     */
+    void XPBD_update_islands(const SimSettings& s);
+    /**
+     * True when the wind has sources and the cloth triangles to catch it
+     */
+    bool blown() const { return wind && !wind->empty() && !all_tris.empty(); }
+    /**
+     * True when islands were built from the current constraints
+     */
+    bool islands_current() const { return islands_revision == constraint_revision && islands.of.size() == particles.size(); }
+    /**
+     * End of a frame: split the nodes of the stretch constraints strained past s.tear_strain, the
+     * most strained first and at most s.max_tears of them. A node is split by the plane through it
+     * normal to its strained constraint: the triangles on the far side move to a copy of the node,
+     * the constraints follow their triangles, a stretch constraint along the cut is doubled and a
+     * bending constraint across it is dropped. Only the triangles and constraints around the node
+     * are touched; the constraint sets keep their colours.
+     * @return number of nodes split
+     */
+    int XPBD_tear(const SimSettings& s);
+
+private:
+    /**
+     * Empty cloth, filled by Checkpoint::restore
+     */
+    Cloth() = default;
+    friend class Checkpoint;
+    friend class Scene;
 
-    void free_resources();
+    BendModel bend_model = BendModel::Distance;
+    std::uint64_t constraint_revision = 0;
+    /**
+     * Revision the islands were built from and gravity of the last frame, a change wakes every island
+     */
+    std::uint64_t islands_revision = ~std::uint64_t(0);
+    glm::vec3 islands_gravity {0.0f};
+    /**
+     * What the solver works on while islands sleep
+     */
+    AwakeConstraints awake;
+
+    /**
+     * Build the per particle constraint tables of tearing if the constraints changed since
+     */
+    void prepare_tearing();
+    /**
+     * Split node v by the plane through it normal to the direction of node toward, the side of
+     * toward goes to the new node
+     * @return false when every triangle of v is on the same side
+     */
+    bool split_node(std::uint32_t v, std::uint32_t toward);
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * @brief Contains the implementation of the sleeping support.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "cloth/islands.h"
+#include <algorithm>
+#include <numeric>
+
+namespace cloth{
+
+namespace {
+
+std::uint32_t find_root(std::vector<std::uint32_t>& parent, std::uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/**
+ * Call append(i) for the constraints of in that keep(i) accepts, colour by colour
+ * @return colour offsets of the kept constraints, empty when in is not coloured
+ */
+template <typename Set, typename Keep, typename Append>
+std::vector<std::uint32_t> filter_colors(const Set& in, Keep&& keep, Append&& append) {
+    std::vector<std::uint32_t> colors;
+    if (in.colors() == 0) {
+        for (std::size_t i=0; i<in.size(); ++i)
+            if (keep(i))
+                append(i);
+        return colors;
+    }
+    std::uint32_t count = 0;
+    colors.push_back(count);
+    for (std::size_t c=0; c<in.colors(); ++c) {
+        for (std::size_t i=in.color_offsets[c]; i<in.color_offsets[c+1]; ++i)
+            if (keep(i)) {
+                append(i);
+                ++count;
+            }
+        colors.push_back(count);
+    }
+    return colors;
+}
+
+void filter_distance(DistanceConstraints& out, const DistanceConstraints& in, const Islands& islands, std::size_t particle_count) {
+    std::vector<std::uint32_t> first, second;
+    std::vector<float> rest, compliance;
+    std::vector<std::uint32_t> colors = filter_colors(in,
+            [&](std::size_t i) { return islands.awake(in.first(i)); },
+            [&](std::size_t i) {
+                first.push_back(in.first(i));
+                second.push_back(in.second(i));
+                rest.push_back(in.rest_dist[i]);
+                compliance.push_back(in.compliance[i]);
+            });
+    out.clear();
+    out.set_index_width(particle_count);
+    out.assign(first.data(), second.data(), rest.data(), compliance.data(), first.size());
+    out.color_offsets = std::move(colors);
+}
+
+/**
+ * extra(i) appends the arrays of the hinge model
+ */
+template <typename Hinges, typename Extra>
+void filter_hinges(Hinges& out, const Hinges& in, const Islands& islands, Extra&& extra) {
+    out.clear();
+    std::vector<std::uint32_t> colors = filter_colors(in,
+            [&](std::size_t i) { return islands.awake(in.p0[i]); },
+            [&](std::size_t i) {
+                out.p0.push_back(in.p0[i]);
+                out.p1.push_back(in.p1[i]);
+                out.p2.push_back(in.p2[i]);
+                out.p3.push_back(in.p3[i]);
+                out.compliance.push_back(in.compliance[i]);
+                extra(i);
+            });
+    out.color_offsets = std::move(colors);
+}
+}
+
+void Islands::build(const DistanceConstraints& edges, std::size_t particle_count) {
+    std::vector<std::uint32_t> parent(particle_count);
+    std::iota(parent.begin(), parent.end(), 0u);
+    for (std::size_t e=0; e<edges.size(); ++e) {
+        const std::uint32_t a = find_root(parent, edges.first(e));
+        const std::uint32_t b = find_root(parent, edges.second(e));
+        if (a != b)
+            parent[std::max(a, b)] = std::min(a, b);
+    }
+
+    // number the islands in the order of their first particle, then bucket the particles
+    of.assign(particle_count, 0);
+    std::vector<std::uint32_t> id(particle_count, UINT32_MAX);
+    std::uint32_t count = 0;
+    for (std::size_t i=0; i<particle_count; ++i) {
+        const std::uint32_t root = find_root(parent, static_cast<std::uint32_t>(i));
+        if (id[root] == UINT32_MAX)
+            id[root] = count++;
+        of[i] = id[root];
+    }
+    offsets.assign(count + 1, 0);
+    for (std::uint32_t k : of)
+        ++offsets[k + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    members.resize(particle_count);
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i=0; i<particle_count; ++i)
+        members[fill[of[i]]++] = static_cast<std::uint32_t>(i);
+
+    quiet_frames.assign(count, 0);
+    asleep.assign(count, 0);
+    sleeping_count = 0;
+    changed = true;
+}
+
+void Islands::wake(std::uint32_t island) {
+    quiet_frames[island] = 0;
+    if (!asleep[island])
+        return;
+    asleep[island] = 0;
+    --sleeping_count;
+    changed = true;
+}
+
+void Islands::wake_all() {
+    for (std::uint32_t k=0; k<size(); ++k)
+        wake(k);
+}
+
+void Islands::wake_touched(const std::vector<std::uint32_t>& pair_offsets, const std::vector<std::uint32_t>& candidates) {
+    if (sleeping_count == 0 || pair_offsets.size() != of.size() + 1)
+        return;
+    for (std::size_t i=0; i<of.size(); ++i) {
+        if (asleep[of[i]])
+            continue;
+        for (std::uint32_t c=pair_offsets[i]; c<pair_offsets[i+1]; ++c)
+            if (asleep[of[candidates[c]]])
+                wake(of[candidates[c]]);
+    }
+}
+
+void Islands::update(Particles& p, float speed, int frames, ThreadPool* pool) {
+    const float limit = speed * speed;
+    std::vector<std::uint8_t> falls(size(), 0);
+    parallel_for(pool, 0, size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k=begin; k<end; ++k) {
+            if (asleep[k])
+                continue;
+            bool quiet = true;
+            for (std::uint32_t m=offsets[k]; m<offsets[k+1] && quiet; ++m) {
+                const std::uint32_t i = members[m];
+                quiet = p.vx[i]*p.vx[i] + p.vy[i]*p.vy[i] + p.vz[i]*p.vz[i] <= limit;
+            }
+            quiet_frames[k] = quiet ? quiet_frames[k] + 1 : 0;
+            if (quiet_frames[k] < static_cast<std::uint32_t>(std::max(frames, 1)))
+                continue;
+            falls[k] = 1;
+            for (std::uint32_t m=offsets[k]; m<offsets[k+1]; ++m) {
+                const std::uint32_t i = members[m];
+                p.vx[i] = p.vy[i] = p.vz[i] = 0.0f;
+                p.px[i] = p.x[i];
+                p.py[i] = p.y[i];
+                p.pz[i] = p.z[i];
+            }
+        }
+    });
+    for (std::size_t k=0; k<size(); ++k)
+        if (falls[k]) {
+            asleep[k] = 1;
+            ++sleeping_count;
+            changed = true;
+        }
+}
+
+void Islands::restore(const std::uint32_t* quiet, const std::uint8_t* sleeping) {
+    quiet_frames.assign(quiet, quiet + size());
+    sleeping_count = 0;
+    for (std::size_t k=0; k<size(); ++k) {
+        asleep[k] = sleeping[k] ? 1 : 0;
+        sleeping_count += asleep[k];
+    }
+    changed = true;
+}
+
+void AwakeConstraints::build(const Islands& islands, std::size_t particle_count, const DistanceConstraints& all_stretch,
+                             const DistanceConstraints& all_bend, const DihedralBendConstraints& all_dihedral,
+                             const IsometricBendConstraints& all_isometric, const LongRangeAttachments& all_tethers) {
+    particles.clear();
+    for (std::uint32_t i=0; i<particle_count; ++i)
+        if (islands.awake(i))
+            particles.push_back(i);
+
+    filter_distance(stretch, all_stretch, islands, particle_count);
+    filter_distance(bend, all_bend, islands, particle_count);
+    filter_hinges(dihedral, all_dihedral, islands, [&](std::size_t i) {
+        dihedral.rest_angle.push_back(all_dihedral.rest_angle[i]);
+    });
+    filter_hinges(isometric, all_isometric, islands, [&](std::size_t i) {
+        isometric.k0.push_back(all_isometric.k0[i]);
+        isometric.k1.push_back(all_isometric.k1[i]);
+        isometric.k2.push_back(all_isometric.k2[i]);
+        isometric.k3.push_back(all_isometric.k3[i]);
+        isometric.scale.push_back(all_isometric.scale[i]);
+    });
+
+    // a tether joins its anchor to a particle of the same island
+    tethers.clear();
+    if (all_tethers.empty())
+        return;
+    tethers.offsets.push_back(0);
+    for (std::size_t g=0; g<all_tethers.anchors.size(); ++g) {
+        if (!islands.awake(all_tethers.anchors[g]))
+            continue;
+        tethers.anchors.push_back(all_tethers.anchors[g]);
+        for (std::uint32_t t=all_tethers.offsets[g]; t<all_tethers.offsets[g+1]; ++t) {
+            tethers.particle.push_back(all_tethers.particle[t]);
+            tethers.length.push_back(all_tethers.length[t]);
+        }
+        tethers.offsets.push_back(static_cast<std::uint32_t>(tethers.particle.size()));
+    }
+}
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Contains the sleeping support: class Islands and struct AwakeConstraints.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "node/particles.h"
+#include "constraints/d_constr.h"
+#include "constraints/h_constr.h"
+#include "constraints/tethers.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class Islands
+ * @brief Connected components of the constraint graph and their sleep state. An island whose
+ * particles all stay slower than a speed for a number of frames falls asleep: its velocities are
+ * zeroed and the solver skips it (see AwakeConstraints) until something wakes it up: a contact
+ * with an awake particle, a pin change or a change of gravity.
+ *
+ * Every constraint joins particles of one island, so the islands never interact through the
+ * solver, only through contacts.
+ */
+class Islands
+{
+public:
+    /**
+     * Island of every particle
+    */
+    std::vector<std::uint32_t> of;
+    /**
+     * Particles of every island, members[offsets[k] .. offsets[k+1]) for island k
+    */
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> members;
+    /**
+     * Frames in a row every island has stayed slower than the sleep speed
+    */
+    std::vector<std::uint32_t> quiet_frames;
+    /**
+     * 1 for the sleeping islands
+    */
+    std::vector<std::uint8_t> asleep;
+
+    /**
+     * Find the islands of the graph whose edges are the constraints of edges, every island awake
+     */
+    void build(const DistanceConstraints& edges, std::size_t particle_count);
+
+    std::size_t size() const { return asleep.size(); }
+    std::size_t sleeping() const { return sleeping_count; }
+    bool all_asleep() const { return !asleep.empty() && sleeping_count == asleep.size(); }
+    bool awake(std::uint32_t particle) const { return asleep[of[particle]] == 0; }
+
+    void wake(std::uint32_t island);
+    void wake_all();
+    /**
+     * Wake the sleeping islands that an awake particle may touch in the coming frame
+     * @param offsets,candidates candidate pairs of every particle, as gathered by SelfCollision
+     */
+    void wake_touched(const std::vector<std::uint32_t>& offsets, const std::vector<std::uint32_t>& candidates);
+    /**
+     * End of a frame: count the quiet frames of the awake islands and put to sleep those quiet
+     * for frames frames, with zero velocity and their positions as the previous ones
+     * @param speed largest speed of a quiet particle
+     */
+    void update(Particles& p, float speed, int frames, ThreadPool* pool);
+    /**
+     * Set the quiet frames and sleep flags of every island, as saved from islands built on the same
+     * constraints
+     */
+    void restore(const std::uint32_t* quiet, const std::uint8_t* sleeping);
+
+    /**
+     * True when an island fell asleep or woke up since the last call to take_changes
+     */
+    bool take_changes() { const bool c = changed; changed = false; return c; }
+
+private:
+    std::size_t sleeping_count = 0;
+    bool changed = false;
+};
+
+/**
+ * @struct AwakeConstraints
+ * @brief The particles and constraints of the awake islands, what the solver iterates over while
+ * some islands sleep. Every set keeps the colouring of the full one (a colour of the subset is
+ * the awake part of the same colour), so the awake islands are solved exactly as when nothing
+ * sleeps.
+ */
+struct AwakeConstraints
+{
+    std::vector<std::uint32_t> particles;
+    DistanceConstraints stretch;
+    DistanceConstraints bend;
+    DihedralBendConstraints dihedral;
+    IsometricBendConstraints isometric;
+    LongRangeAttachments tethers;
+
+    /**
+     * Copy the awake part of every set
+     */
+    void build(const Islands& islands, std::size_t particle_count, const DistanceConstraints& all_stretch,
+               const DistanceConstraints& all_bend, const DihedralBendConstraints& all_dihedral,
+               const IsometricBendConstraints& all_isometric, const LongRangeAttachments& all_tethers);
+};
+}
@@ -0,0 +1,31 @@
+/**
+ * @file
+ * @brief Contains the implementation of the vertex normal computation.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "cloth/normals.h"
+
+namespace cloth{
+
+static constexpr std::size_t triangle_grain = 4096;
+
+void compute_face_normals(const int* tris, std::size_t tri_count,
+                          const float* x, const float* y, const float* z,
+                          glm::vec3* faces, ThreadPool* pool) {
+    parallel_for(pool, 0, tri_count, triangle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t=begin; t<end; ++t) {
+            const int a = tris[3*t];
+            const int b = tris[3*t + 1];
+            const int c = tris[3*t + 2];
+            glm::vec3 p1 {x[a], y[a], z[a]};
+            glm::vec3 p2 {x[b], y[b], z[b]};
+            glm::vec3 p3 {x[c], y[c], z[c]};
+            faces[t] = glm::cross(p2 - p1, p3 - p1);
+        }
+    });
+}
+}
@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @brief Contains the vertex normal computation shared by the cloth and the renderer.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <glm.hpp>
+#include "cloth/adjacency.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * Unnormalized (area weighted) normal of every triangle
+ * @param tris three node indices per triangle
+ * @param tri_count number of triangles
+ * @param x,y,z node positions
+ * @param faces output, one per triangle
+ * @param pool worker pool, may be null
+ */
+void compute_face_normals(const int* tris, std::size_t tri_count,
+                          const float* x, const float* y, const float* z,
+                          glm::vec3* faces, ThreadPool* pool);
+
+/**
+ * Normal of node i: sum of the normals of its incident triangles, normalized
+ */
+inline glm::vec3 gather_normal(const Adjacency& node_tris, const glm::vec3* faces, std::size_t i) {
+    glm::vec3 n {0.0};
+    for (std::uint32_t k=node_tris.begin(i); k<node_tris.end(i); ++k)
+        n += faces[node_tris.items[k]];
+    return glm::normalize(n);
+}
+}
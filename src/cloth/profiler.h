@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Contains the class Profiler, wall-clock accounting of the simulation phases.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace cloth{
+/**
+ * Phases of a simulated and displayed frame
+ */
+enum class Phase {
+    Predict,
+    Stretch,
+    Bend,
+    Tethers,
+    Velocity,
+    Collision,
+    Normals,
+    Packing,
+    Tearing,
+    Wind,
+    Count
+};
+
+/**
+ * @class Profiler
+ * @brief Accumulates time and call count per Phase. A cloth only measures when it has a profiler
+ * attached, otherwise the cost is a null check per phase.
+ */
+class Profiler
+{
+public:
+    std::array<double, static_cast<std::size_t>(Phase::Count)> seconds {};
+    std::array<std::uint64_t, static_cast<std::size_t>(Phase::Count)> calls {};
+
+    void add(Phase p, double s) {
+        seconds[static_cast<std::size_t>(p)] += s;
+        ++calls[static_cast<std::size_t>(p)];
+    }
+    double total(Phase p) const { return seconds[static_cast<std::size_t>(p)]; }
+    std::uint64_t count(Phase p) const { return calls[static_cast<std::size_t>(p)]; }
+    void reset() {
+        seconds.fill(0.0);
+        calls.fill(0);
+    }
+
+    static const char* name(Phase p) {
+        static const char* names[] = {"predict", "stretch", "bend", "tethers", "velocity", "collision", "normals", "packing", "tearing", "wind"};
+        return names[static_cast<std::size_t>(p)];
+    }
+};
+
+/**
+ * @class ScopedPhase
+ * @brief Adds the lifetime of the object to a phase of profiler (does nothing when profiler is null)
+ */
+class ScopedPhase
+{
+public:
+    ScopedPhase(Profiler* profiler, Phase phase) : profiler(profiler), phase(phase) {
+        if (profiler)
+            start = std::chrono::steady_clock::now();
+    }
+    ~ScopedPhase() {
+        if (profiler)
+            profiler->add(phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    Profiler* profiler;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+}
@@ -0,0 +1,226 @@
+/**
+ * @file
+ * @brief Contains the implementation of the deterministic replay support.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "cloth/replay.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace cloth{
+
+namespace {
+
+constexpr char magic[8] = {'X', 'P', 'B', 'D', 'E', 'V', 'L', 'G'};
+constexpr std::uint32_t log_version = 1;
+constexpr std::uint32_t byte_order_mark = 0x01020304u;
+constexpr std::size_t hash_grain = 8192;
+
+struct LogHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    double frame_time;
+    std::uint64_t event_count;
+    std::uint64_t hash_count;
+};
+static_assert(sizeof(LogHeader) == 40, "event log header layout");
+static_assert(sizeof(SimEvent) == 40, "event layout");
+
+/**
+ * splitmix64 finalizer
+ */
+inline std::uint64_t mix(std::uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+inline std::uint64_t hash_array(std::uint64_t h, const float* a, std::size_t b, std::size_t e) {
+    for (std::size_t i=b; i<e; ++i) {
+        std::uint32_t bits;
+        std::memcpy(&bits, a + i, sizeof(bits));
+        h = mix(h ^ bits);
+    }
+    return h;
+}
+
+int as_int(float v) { return static_cast<int>(v); }
+}
+
+SimEvent SimEvent::pin(EventType type, int index) {
+    SimEvent e;
+    e.type = type;
+    e.index = index;
+    return e;
+}
+
+SimEvent SimEvent::unpin(EventType type) {
+    SimEvent e;
+    e.type = type;
+    return e;
+}
+
+SimEvent SimEvent::setting_change(SettingId id, float v0, float v1, float v2) {
+    SimEvent e;
+    e.type = EventType::Setting;
+    e.setting = id;
+    e.value[0] = v0;
+    e.value[1] = v1;
+    e.value[2] = v2;
+    return e;
+}
+
+SimEvent SimEvent::camera(const glm::vec3& position, const glm::vec3& front) {
+    SimEvent e;
+    e.type = EventType::Camera;
+    e.value[0] = position.x; e.value[1] = position.y; e.value[2] = position.z;
+    e.value[3] = front.x; e.value[4] = front.y; e.value[5] = front.z;
+    return e;
+}
+
+bool apply_event(const SimEvent& e, Cloth& c, SimSettings& s) {
+    switch (e.type) {
+        case EventType::Pin1: c.pin1(e.index); return true;
+        case EventType::Pin2: c.pin2(e.index); return true;
+        case EventType::Unpin1: c.unpin1(); return true;
+        case EventType::Unpin2: c.unpin2(); return true;
+        case EventType::Camera: return false;
+        case EventType::Setting: break;
+    }
+    const float v = e.value[0];
+    switch (e.setting) {
+        case SettingId::IterationPerFrame: s.iteration_per_frame = as_int(v); break;
+        case SettingId::AdaptiveSubsteps: s.adaptive_substeps = v != 0.0f; break;
+        case SettingId::MinSubsteps: s.min_substeps = as_int(v); break;
+        case SettingId::MaxSubsteps: s.max_substeps = as_int(v); break;
+        case SettingId::TargetStrain: s.target_strain = v; break;
+        case SettingId::MaxSubstepTravel: s.max_substep_travel = v; break;
+        case SettingId::SelfCollision: s.self_collision = v != 0.0f; break;
+        case SettingId::LongRangeAttachments: s.long_range_attachments = v != 0.0f; break;
+        case SettingId::Gravity: s.gravity = glm::vec3(e.value[0], e.value[1], e.value[2]); break;
+        case SettingId::Sleeping: s.sleeping = v != 0.0f; break;
+        case SettingId::SleepSpeed: s.sleep_speed = v; break;
+        case SettingId::SleepFrames: s.sleep_frames = as_int(v); break;
+        case SettingId::Tearing: s.tearing = v != 0.0f; break;
+        case SettingId::TearStrain: s.tear_strain = v; break;
+        case SettingId::MaxTears: s.max_tears = as_int(v); break;
+    }
+    return true;
+}
+
+std::uint64_t state_hash(const Particles& p, ThreadPool* pool) {
+    const std::size_t n = p.size();
+    return parallel_reduce(pool, std::size_t(0), n, hash_grain, mix(n),
+            [&p](std::size_t b, std::size_t e) {
+                std::uint64_t h = mix(b);
+                for (const auto* a : {&p.x, &p.y, &p.z, &p.vx, &p.vy, &p.vz})
+                    h = hash_array(h, a->data(), b, e);
+                return h;
+            },
+            [](std::uint64_t acc, std::uint64_t h) { return mix(acc ^ h) + 0x9e3779b97f4a7c15ull; });
+}
+
+void EventLog::record(std::uint64_t frame, SimEvent e) {
+    e.frame = frame;
+    events.push_back(e);
+}
+
+void EventLog::record_settings(std::uint64_t frame, const SimSettings& s) {
+    frame_time = s.frame_time;
+    auto flag = [](bool b) { return b ? 1.0f : 0.0f; };
+    record(frame, SimEvent::setting_change(SettingId::IterationPerFrame, static_cast<float>(s.iteration_per_frame)));
+    record(frame, SimEvent::setting_change(SettingId::AdaptiveSubsteps, flag(s.adaptive_substeps)));
+    record(frame, SimEvent::setting_change(SettingId::MinSubsteps, static_cast<float>(s.min_substeps)));
+    record(frame, SimEvent::setting_change(SettingId::MaxSubsteps, static_cast<float>(s.max_substeps)));
+    record(frame, SimEvent::setting_change(SettingId::TargetStrain, s.target_strain));
+    record(frame, SimEvent::setting_change(SettingId::MaxSubstepTravel, s.max_substep_travel));
+    record(frame, SimEvent::setting_change(SettingId::SelfCollision, flag(s.self_collision)));
+    record(frame, SimEvent::setting_change(SettingId::LongRangeAttachments, flag(s.long_range_attachments)));
+    record(frame, SimEvent::setting_change(SettingId::Gravity, s.gravity.x, s.gravity.y, s.gravity.z));
+    record(frame, SimEvent::setting_change(SettingId::Sleeping, flag(s.sleeping)));
+    record(frame, SimEvent::setting_change(SettingId::SleepSpeed, s.sleep_speed));
+    record(frame, SimEvent::setting_change(SettingId::SleepFrames, static_cast<float>(s.sleep_frames)));
+    record(frame, SimEvent::setting_change(SettingId::Tearing, flag(s.tearing)));
+    record(frame, SimEvent::setting_change(SettingId::TearStrain, s.tear_strain));
+    record(frame, SimEvent::setting_change(SettingId::MaxTears, static_cast<float>(s.max_tears)));
+}
+
+std::pair<const SimEvent*, const SimEvent*> EventLog::at(std::uint64_t frame) const {
+    auto first = std::lower_bound(events.begin(), events.end(), frame,
+                                  [](const SimEvent& e, std::uint64_t f) { return e.frame < f; });
+    auto last = std::upper_bound(first, events.end(), frame,
+                                 [](std::uint64_t f, const SimEvent& e) { return f < e.frame; });
+    const SimEvent* base = events.data();
+    return {base + (first - events.begin()), base + (last - events.begin())};
+}
+
+void EventLog::save(const std::string& path) const {
+    LogHeader header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = log_version;
+    header.byte_order = byte_order_mark;
+    header.frame_time = frame_time;
+    header.event_count = events.size();
+    header.hash_count = hashes.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(SimEvent));
+    out.write(reinterpret_cast<const char*>(hashes.data()), hashes.size() * sizeof(std::uint64_t));
+    if (!out)
+        throw std::runtime_error("cannot write event log " + path);
+}
+
+EventLog EventLog::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("cannot open event log " + path);
+    LogHeader header {};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error(path + " is not an event log");
+    if (header.byte_order != byte_order_mark)
+        throw std::runtime_error(path + " was written with another byte order");
+    if (header.version != log_version)
+        throw std::runtime_error(path + ": unsupported event log version " + std::to_string(header.version));
+
+    in.seekg(0, std::ios::end);
+    const auto size = static_cast<std::uint64_t>(in.tellg());
+    if (size != sizeof(header) + header.event_count * sizeof(SimEvent) + header.hash_count * sizeof(std::uint64_t))
+        throw std::runtime_error(path + ": truncated event log");
+    in.seekg(sizeof(header));
+
+    EventLog log;
+    log.frame_time = header.frame_time;
+    log.events.resize(header.event_count);
+    log.hashes.resize(header.hash_count);
+    in.read(reinterpret_cast<char*>(log.events.data()), log.events.size() * sizeof(SimEvent));
+    in.read(reinterpret_cast<char*>(log.hashes.data()), log.hashes.size() * sizeof(std::uint64_t));
+    if (!in)
+        throw std::runtime_error("cannot read event log " + path);
+    if (!std::is_sorted(log.events.begin(), log.events.end(),
+                        [](const SimEvent& a, const SimEvent& b) { return a.frame < b.frame; }))
+        throw std::runtime_error(path + ": events out of order");
+    return log;
+}
+
+bool ReplayVerifier::check(std::uint64_t frame, const Particles& p, ThreadPool* pool) {
+    if (frame >= log.hashes.size())
+        return true;
+    ++checked;
+    if (state_hash(p, pool) == log.hashes[frame])
+        return true;
+    if (first_mismatch < 0)
+        first_mismatch = static_cast<std::int64_t>(frame);
+    return false;
+}
+}
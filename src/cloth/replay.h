@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @brief Contains the deterministic replay support: struct SimEvent, class EventLog and
+ * state_hash.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "cloth/cloth.h"
+#include "cloth/settings.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * Kind of a SimEvent
+ */
+enum class EventType : std::uint8_t {
+    Pin1,       ///< pin1(index)
+    Pin2,       ///< pin2(index)
+    Unpin1,
+    Unpin2,
+    Setting,    ///< a SimSettings field, see SettingId
+    Camera      ///< view only: position and front of the camera, applied by the application
+};
+
+/**
+ * SimSettings field changed by an EventType::Setting event
+ */
+enum class SettingId : std::uint8_t {
+    IterationPerFrame,
+    AdaptiveSubsteps,
+    MinSubsteps,
+    MaxSubsteps,
+    TargetStrain,
+    MaxSubstepTravel,
+    SelfCollision,
+    LongRangeAttachments,
+    Gravity,            ///< value[0..2]
+    Sleeping,
+    SleepSpeed,
+    SleepFrames,
+    Tearing,
+    TearStrain,
+    MaxTears
+};
+
+/**
+ * @struct SimEvent
+ * @brief An input that changes the simulation (or the view) between two frames, stamped with the
+ * frame it was applied before. 40 bytes, stored as is in the log.
+ */
+struct SimEvent
+{
+    std::uint64_t frame = 0;
+    EventType type = EventType::Setting;
+    SettingId setting = SettingId::IterationPerFrame;
+    std::uint16_t reserved = 0;
+    /**
+     * Node of a pin event
+    */
+    std::int32_t index = 0;
+    /**
+     * Value of a setting (booleans and integers are stored exactly), camera position and front
+    */
+    float value[6] = {};
+
+    static SimEvent pin(EventType type, int index);
+    static SimEvent unpin(EventType type);
+    static SimEvent setting_change(SettingId id, float v0, float v1 = 0.0f, float v2 = 0.0f);
+    static SimEvent camera(const glm::vec3& position, const glm::vec3& front);
+};
+
+/**
+ * Apply e to the cloth or the settings
+ * @return false when e is not for the simulation (camera), the caller applies it
+ */
+bool apply_event(const SimEvent& e, Cloth& c, SimSettings& s);
+
+/**
+ * Hash of the state that the next frames depend on (positions and velocities of every particle),
+ * bitwise: two states hash the same only if every float is identical. The blocks are folded in a
+ * fixed order, so the hash does not depend on the pool.
+ */
+std::uint64_t state_hash(const Particles& p, ThreadPool* pool = nullptr);
+
+/**
+ * @class EventLog
+ * @brief Recording of a run: the events in the order they were applied and the state_hash after
+ * every frame. The settings at the start are recorded as events of frame 0 (record_settings), so
+ * replaying the events on the same initial cloth gives the same hashes, whatever the thread count
+ * or the SIMD level.
+ */
+class EventLog
+{
+public:
+    /**
+     * SimSettings::frame_time of the run, kept apart as it is the one double setting
+    */
+    double frame_time = 1.0 / 60.0;
+    /**
+     * Events sorted by frame, in application order within a frame
+    */
+    std::vector<SimEvent> events;
+    /**
+     * hashes[f] = state_hash after frame f
+    */
+    std::vector<std::uint64_t> hashes;
+
+    /**
+     * Stamp e with frame and append it
+     */
+    void record(std::uint64_t frame, SimEvent e);
+    /**
+     * Record every setting of s (and its frame_time) as events of frame
+     */
+    void record_settings(std::uint64_t frame, const SimSettings& s);
+
+    /**
+     * Range [first, last) of events to apply before frame
+     */
+    std::pair<const SimEvent*, const SimEvent*> at(std::uint64_t frame) const;
+
+    /**
+     * @throws std::runtime_error when the file cannot be written / is not an event log
+     */
+    void save(const std::string& path) const;
+    static EventLog load(const std::string& path);
+};
+
+/**
+ * @class ReplayVerifier
+ * @brief Compares the state after every replayed frame with the hash recorded in the log and keeps
+ * the first frame that differs.
+ */
+class ReplayVerifier
+{
+public:
+    explicit ReplayVerifier(const EventLog& log) : log(log) {}
+
+    /**
+     * Check the state after frame
+     * @return false when it differs from the recording (frames past the recording are not checked)
+     */
+    bool check(std::uint64_t frame, const Particles& p, ThreadPool* pool = nullptr);
+
+    std::uint64_t checked = 0;
+    /**
+     * First frame whose state differs, -1 when none
+    */
+    std::int64_t first_mismatch = -1;
+
+private:
+    const EventLog& log;
+};
+}
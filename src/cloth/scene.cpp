@@ -0,0 +1,262 @@
+/**
+ * @file
+ * @brief Contains the implementation of class Scene.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "cloth/scene.h"
+#include <algorithm>
+#include <utility>
+#include "constraints/coloring.h"
+
+namespace cloth{
+
+namespace {
+
+/**
+ * Append the constraints of every set colour by colour: colour k of the result is colour k of
+ * every set, in the order of the sets. Constraints of different cloths share no particle, so the
+ * merged colours are still independent. append(set, begin, end) copies a range of a set.
+ * @return colour offsets of the result, empty when a non-empty set has no colours (the result has
+ * to be coloured again)
+ */
+template <typename Set, typename Append>
+std::vector<std::uint32_t> merge_colors(const std::vector<const Set*>& sets, Append&& append) {
+    bool colored = true;
+    std::size_t colors = 0;
+    for (const Set* s : sets) {
+        colored = colored && (s->empty() || s->colors() > 0);
+        colors = std::max(colors, s->colors());
+    }
+    if (!colored) {
+        for (std::size_t k=0; k<sets.size(); ++k)
+            append(k, 0, sets[k]->size());
+        return {};
+    }
+    std::vector<std::uint32_t> offsets;
+    if (colors == 0)
+        return offsets;
+    std::uint32_t count = 0;
+    offsets.push_back(count);
+    for (std::size_t c=0; c<colors; ++c) {
+        for (std::size_t k=0; k<sets.size(); ++k) {
+            if (c >= sets[k]->colors())
+                continue;
+            const std::uint32_t begin = sets[k]->color_offsets[c], end = sets[k]->color_offsets[c+1];
+            append(k, begin, end);
+            count += end - begin;
+        }
+        offsets.push_back(count);
+    }
+    return offsets;
+}
+
+template <typename T>
+void append_range(std::vector<T>& out, const std::vector<T>& in, std::size_t begin, std::size_t end) {
+    out.insert(out.end(), in.begin() + begin, in.begin() + end);
+}
+
+void append_shifted(std::vector<std::uint32_t>& out, const std::vector<std::uint32_t>& in, std::size_t begin, std::size_t end, std::size_t shift) {
+    for (std::size_t i=begin; i<end; ++i)
+        out.push_back(static_cast<std::uint32_t>(in[i] + shift));
+}
+
+void merge_distance(DistanceConstraints& out, const std::vector<const DistanceConstraints*>& sets,
+                    const std::vector<std::size_t>& offsets, std::size_t particle_count) {
+    std::vector<std::uint32_t> first, second;
+    std::vector<float> rest, compliance;
+    std::vector<std::uint32_t> colors = merge_colors(sets, [&](std::size_t k, std::size_t begin, std::size_t end) {
+        const DistanceConstraints& set = *sets[k];
+        const std::size_t shift = offsets[k];
+        set.with_indices([&](const auto* f, const auto* s) {
+            for (std::size_t i=begin; i<end; ++i) {
+                first.push_back(static_cast<std::uint32_t>(f[i] + shift));
+                second.push_back(static_cast<std::uint32_t>(s[i] + shift));
+            }
+        });
+        append_range(rest, set.rest_dist, begin, end);
+        append_range(compliance, set.compliance, begin, end);
+    });
+    out.clear();
+    out.set_index_width(particle_count);
+    out.assign(first.data(), second.data(), rest.data(), compliance.data(), first.size());
+    out.color_offsets = std::move(colors);
+    if (out.colors() == 0 && !out.empty())
+        color_constraints(out, particle_count);
+}
+
+/**
+ * Merge hinge sets; extra(out, set, begin, end) appends the arrays of the hinge model
+ */
+template <typename Hinges, typename Extra>
+void merge_hinges(Hinges& out, const std::vector<const Hinges*>& sets, const std::vector<std::size_t>& offsets,
+                  std::size_t particle_count, Extra&& extra) {
+    out.clear();
+    std::vector<std::uint32_t> colors = merge_colors(sets, [&](std::size_t k, std::size_t begin, std::size_t end) {
+        const Hinges& set = *sets[k];
+        append_shifted(out.p0, set.p0, begin, end, offsets[k]);
+        append_shifted(out.p1, set.p1, begin, end, offsets[k]);
+        append_shifted(out.p2, set.p2, begin, end, offsets[k]);
+        append_shifted(out.p3, set.p3, begin, end, offsets[k]);
+        append_range(out.compliance, set.compliance, begin, end);
+        extra(out, set, begin, end);
+    });
+    out.color_offsets = std::move(colors);
+    if (out.colors() == 0 && !out.empty())
+        color_constraints(out, particle_count);
+}
+
+template <typename Set>
+std::vector<const Set*> sets_of(const std::vector<std::unique_ptr<Cloth>>& cloths, Set Cloth::* member) {
+    std::vector<const Set*> sets;
+    for (const auto& c : cloths)
+        sets.push_back(&(*c.*member));
+    return sets;
+}
+
+template <typename F>
+void for_each_array(Particles& p, F&& f) {
+    for (aligned_vector<float>* a : {&p.x, &p.y, &p.z, &p.px, &p.py, &p.pz, &p.vx, &p.vy, &p.vz, &p.w})
+        f(*a);
+    f(p.m);
+}
+}
+
+Cloth& Scene::add(std::unique_ptr<Cloth> c) {
+    cloths.push_back(std::move(c));
+    return *cloths.back();
+}
+
+std::size_t Scene::particle_count() const {
+    std::size_t n = 0;
+    for (const auto& c : cloths)
+        n += c->particles.size();
+    return n;
+}
+
+void Scene::pack() {
+    offsets.assign(1, 0);
+    for (const auto& c : cloths)
+        offsets.push_back(offsets.back() + c->particles.size());
+    const std::size_t total = offsets.back();
+    for_each_array(arena.particles, [total](auto& a) { a.resize(total); });
+
+    std::vector<const DistanceConstraints*> stretch, bend;
+    for (const auto& c : cloths) {
+        stretch.push_back(&c->s_cs);
+        bend.push_back(&c->b_cs);
+    }
+    merge_distance(arena.s_cs, stretch, offsets, total);
+    merge_distance(arena.b_cs, bend, offsets, total);
+    merge_hinges(arena.dihedral_cs, sets_of(cloths, &Cloth::dihedral_cs), offsets, total,
+                 [](DihedralBendConstraints& out, const DihedralBendConstraints& set, std::size_t begin, std::size_t end) {
+                     append_range(out.rest_angle, set.rest_angle, begin, end);
+                 });
+    merge_hinges(arena.isometric_cs, sets_of(cloths, &Cloth::isometric_cs), offsets, total,
+                 [](IsometricBendConstraints& out, const IsometricBendConstraints& set, std::size_t begin, std::size_t end) {
+                     append_range(out.k0, set.k0, begin, end);
+                     append_range(out.k1, set.k1, begin, end);
+                     append_range(out.k2, set.k2, begin, end);
+                     append_range(out.k3, set.k3, begin, end);
+                     append_range(out.scale, set.scale, begin, end);
+                 });
+
+    LongRangeAttachments& tethers = arena.tethers;
+    tethers.clear();
+    tethers.offsets.push_back(0);
+    for (std::size_t k=0; k<cloths.size(); ++k) {
+        const LongRangeAttachments& t = cloths[k]->tethers;
+        if (t.empty())
+            continue;
+        append_shifted(tethers.anchors, t.anchors, 0, t.anchors.size(), offsets[k]);
+        for (std::size_t g=1; g<t.offsets.size(); ++g)
+            tethers.offsets.push_back(static_cast<std::uint32_t>(t.offsets[g] + tethers.particle.size()));
+        append_shifted(tethers.particle, t.particle, 0, t.size(), offsets[k]);
+        append_range(tethers.length, t.length, 0, t.size());
+    }
+
+    // the triangles of every cloth, for the wind
+    arena.all_tris.clear();
+    for (std::size_t k=0; k<cloths.size(); ++k) {
+        const int shift = static_cast<int>(offsets[k]);
+        for (const Cloth::triangle_struct& t : cloths[k]->all_tris)
+            arena.all_tris.push_back(Cloth::triangle_struct{t.a + shift, t.b + shift, t.c + shift});
+    }
+    arena.node_tris.build(arena.tri_indices(), arena.all_tris.size(), 3, total);
+
+    // the links keep the neighbours of every cloth from colliding, different cloths always collide
+    arena.self_collision.thickness = 0.0f;
+    for (const auto& c : cloths)
+        arena.self_collision.thickness = std::max(arena.self_collision.thickness, c->self_collision.thickness);
+    arena.self_collision.set_links(arena.s_cs, total);
+    arena.s_jacobi.invalidate();
+    arena.b_jacobi.invalidate();
+    // new islands for the arena
+    ++arena.constraint_revision;
+
+    packed_revisions.clear();
+    for (const auto& c : cloths)
+        packed_revisions.push_back(c->revision());
+}
+
+void Scene::gather() {
+    Particles& p = arena.particles;
+    parallel_for(pool, 0, cloths.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k=begin; k<end; ++k) {
+            Particles& c = cloths[k]->particles;
+            const std::size_t at = offsets[k];
+            for (auto [from, to] : {std::pair{&c.x, &p.x}, {&c.y, &p.y}, {&c.z, &p.z}, {&c.px, &p.px}, {&c.py, &p.py},
+                                    {&c.pz, &p.pz}, {&c.vx, &p.vx}, {&c.vy, &p.vy}, {&c.vz, &p.vz}, {&c.w, &p.w}})
+                std::copy(from->begin(), from->end(), to->begin() + at);
+            std::copy(c.m.begin(), c.m.end(), p.m.begin() + at);
+        }
+    });
+}
+
+void Scene::scatter() {
+    const Particles& p = arena.particles;
+    parallel_for(pool, 0, cloths.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k=begin; k<end; ++k) {
+            Particles& c = cloths[k]->particles;
+            const std::size_t at = offsets[k];
+            // w and m are not changed by the solver
+            for (auto [from, to] : {std::pair{&p.x, &c.x}, {&p.y, &c.y}, {&p.z, &c.z}, {&p.px, &c.px}, {&p.py, &c.py},
+                                    {&p.pz, &c.pz}, {&p.vx, &c.vx}, {&p.vy, &c.vy}, {&p.vz, &c.vz}})
+                std::copy(from->begin() + at, from->begin() + at + c.size(), to->begin());
+            cloths[k]->last_substeps = last_substeps;
+        }
+    });
+}
+
+void Scene::simulate_XPBD(const SimSettings& s) {
+    if (cloths.empty())
+        return;
+    bool stale = packed_revisions.size() != cloths.size();
+    for (std::size_t k=0; k<cloths.size() && !stale; ++k)
+        stale = cloths[k]->revision() != packed_revisions[k] || offsets[k+1] - offsets[k] != cloths[k]->particles.size();
+    if (stale)
+        pack();
+    gather();
+
+    arena.pool = pool;
+    arena.profiler = profiler;
+    arena.solver_mode = solver_mode;
+    arena.jacobi_relaxation = jacobi_relaxation;
+    arena.simd_level = simd_level;
+    arena.colliders = colliders;
+    arena.wind = wind;
+    // a tear splits the nodes of its own cloth, the next frame packs the arena again
+    SimSettings solve = s;
+    solve.tearing = false;
+    arena.simulate_XPBD(solve);
+    last_substeps = arena.last_substeps;
+
+    scatter();
+    if (s.tearing)
+        for (auto& c : cloths)
+            c->XPBD_tear(s);
+}
+}
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @brief Contains the class Scene, several cloths simulated together.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "cloth/cloth.h"
+#include "cloth/settings.h"
+#include "cloth/profiler.h"
+#include "collision/collider_set.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class Scene
+ * @brief Owns many cloths (e.g. the panels of a garment) and simulates them as one: the particles
+ * and constraints of every cloth are packed into shared arenas, so each phase of a substep
+ * (predict, every colour of every constraint set, velocity update) is a single dispatch over all
+ * the cloths. A few small cloths then keep the whole pool busy instead of running one after the
+ * other, each too small to be split.
+ *
+ * The colours of the cloths are merged (colour k of the arena is colour k of every cloth), so the
+ * arena has as many colours as the most coloured cloth and a scene of one cloth gives exactly the
+ * result of Cloth::simulate_XPBD. Tethers and contacts are shared as well: with self collision on,
+ * the cloths also collide with each other. The triangles are packed too, so the wind of the scene
+ * blows on every cloth.
+ *
+ * The cloths stay the reference state: every frame starts by copying their particles into the
+ * arena and ends by copying positions and velocities back, so pinning a node or moving a cloth
+ * between frames works as for a single cloth. The constraints are packed again only when a cloth
+ * regenerates some of them (Cloth::revision).
+ */
+class Scene
+{
+public:
+    /**
+     * Worker pool shared by every cloth, the scene runs serially when null
+     */
+    ThreadPool* pool = nullptr;
+    /**
+     * Phase timings of the whole scene are accumulated here when not null
+     */
+    Profiler* profiler = nullptr;
+    /**
+     * Solver of every cloth of the scene, their own settings are not used by simulate_XPBD
+     */
+    SolverMode solver_mode = SolverMode::GaussSeidel;
+    float jacobi_relaxation = 1.5;
+    SimdLevel simd_level = best_simd_level();
+    /**
+     * Static obstacles of the scene; null = none
+     */
+    ColliderSet* colliders = nullptr;
+    /**
+     * Wind of the scene; null = none
+     */
+    WindField* wind = nullptr;
+    /**
+     * Substeps run by the last call to simulate_XPBD
+     */
+    int last_substeps = 0;
+
+    Scene() = default;
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    /**
+     * Add a cloth to the scene
+     * @return the cloth, owned by the scene
+     */
+    Cloth& add(std::unique_ptr<Cloth> c);
+    template <typename... Args>
+    Cloth& emplace(Args&&... args) { return add(std::make_unique<Cloth>(std::forward<Args>(args)...)); }
+
+    std::size_t size() const { return cloths.size(); }
+    bool empty() const { return cloths.empty(); }
+    Cloth& cloth(std::size_t i) { return *cloths[i]; }
+    const Cloth& cloth(std::size_t i) const { return *cloths[i]; }
+
+    /**
+     * Total number of particles
+     */
+    std::size_t particle_count() const;
+    /**
+     * Particles of every cloth, back to back in the order the cloths were added, as of the last
+     * simulated frame
+     */
+    const Particles& particles() const { return arena.particles; }
+    /**
+     * Index in particles() of the first particle of cloth i, valid after a simulated frame
+     */
+    std::size_t particle_offset(std::size_t i) const { return offsets.at(i); }
+    /**
+     * Contacts gathered by the last frame, between and inside the cloths / with the colliders
+     */
+    std::size_t collision_pair_count() const { return arena.self_collision.pair_count(); }
+    std::size_t collider_candidate_count() const { return arena.collider_contacts.candidate_count(); }
+    /**
+     * Islands of all the cloths and their sleep state, when sleeping is on
+     */
+    const Islands& islands() const { return arena.islands; }
+
+    /**
+     * Advance every cloth by one frame of s.frame_time seconds
+     */
+    void simulate_XPBD(const SimSettings& s);
+
+private:
+    /**
+     * Rebuild the constraint arenas from the cloths
+     */
+    void pack();
+    void gather();
+    void scatter();
+
+    std::vector<std::unique_ptr<Cloth>> cloths;
+    /**
+     * Revision of every cloth when the arenas were packed
+     */
+    std::vector<std::uint64_t> packed_revisions;
+    std::vector<std::size_t> offsets;
+    /**
+     * All the cloths as one (particles and constraints, no topology); it runs the solver
+     */
+    Cloth arena;
+};
+}
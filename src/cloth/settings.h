@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Contains the struct SimSettings, the simulation parameters shared by every cloth.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <glm.hpp>
+
+namespace cloth{
+/**
+ * @struct SimSettings
+ * @brief Parameters read by the solver. It has no dependency on the windowing system, so it can be
+ * filled by a headless driver as well as by render::State.
+ */
+struct SimSettings
+{
+    /**
+     * Number of XPBD substeps executed for every simulated frame
+    */
+    int iteration_per_frame = 30;
+    /**
+     * Simulated seconds advanced by every call to simulate_XPBD
+    */
+    double frame_time = 1.0 / 60.0;
+    /**
+     * Frames a FixedTimestep may simulate for a single real time update, the rest is dropped
+    */
+    int max_frames_per_update = 4;
+    /**
+     * Let a SubstepController choose the substeps of every frame instead of iteration_per_frame
+    */
+    bool adaptive_substeps = false;
+    /**
+     * Range of the adaptive substep count
+    */
+    int min_substeps = 4;
+    int max_substeps = 60;
+    /**
+     * Rms relative stretch strain the adaptive substeps aim for
+    */
+    float target_strain = 0.02f;
+    /**
+     * Largest distance a particle may travel in one adaptive substep, in shortest rest lengths
+    */
+    float max_substep_travel = 0.5f;
+    /**
+     * Tether every node to the pinned nodes (see LongRangeAttachments): a hanging cloth no longer
+     * sags far past its rest size with few substeps, the stretch of single edges is unchanged
+    */
+    bool long_range_attachments = false;
+    /**
+     * Keep the particles of a cloth from passing through each other (see SelfCollision)
+    */
+    bool self_collision = false;
+    /**
+     * Let the islands of the cloth that stay slower than sleep_speed for sleep_frames frames in a
+     * row fall asleep, the solver skips them until they are woken up (see Islands)
+    */
+    bool sleeping = false;
+    float sleep_speed = 0.01f;
+    int sleep_frames = 30;
+    /**
+     * Tear the cloth where a stretch constraint is strained past tear_strain (relative to its rest
+     * length), splitting at most max_tears nodes per frame (see Cloth::XPBD_tear)
+    */
+    bool tearing = false;
+    float tear_strain = 0.5f;
+    int max_tears = 64;
+    /**
+     * Gravity acceleration applied to every free node
+    */
+    glm::vec3 gravity {0.0, 0.0, -9.81};
+};
+}
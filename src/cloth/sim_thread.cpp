@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Contains the implementation of class SimulationThread.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <chrono>
+#include <utility>
+#include "cloth/sim_thread.h"
+
+namespace cloth{
+
+SimulationThread::SimulationThread(Cloth& cloth, const SimSettings& settings)
+    : cloth(cloth), settings(settings), step(settings.frame_time) {
+    // size every slot now, so the simulation thread never allocates
+    for (int i=0; i<3; ++i)
+        snapshots.slot(i).capture(cloth.particles);
+}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    if (active.exchange(true))
+        return;
+    publish();
+    thread = std::thread(&SimulationThread::loop, this);
+}
+
+void SimulationThread::stop() {
+    active.store(false);
+    if (thread.joinable())
+        thread.join();
+}
+
+void SimulationThread::post(Command command) {
+    std::lock_guard<std::mutex> lock(commands_mutex);
+    commands.push_back(std::move(command));
+}
+
+const Snapshot* SimulationThread::poll() {
+    if (!snapshots.acquire())
+        return nullptr;
+    return &snapshots.read_buffer();
+}
+
+void SimulationThread::publish() {
+    Snapshot& s = snapshots.write_buffer();
+    s.capture(cloth.particles);
+    s.frame = frame;
+    s.sim_time = frame * settings.frame_time;
+    s.published = Snapshot::clock::now();
+    snapshots.publish();
+}
+
+void SimulationThread::loop() {
+    using clock = Snapshot::clock;
+    std::vector<Command> pending;
+    FixedTimestep timestep {settings.frame_time, settings.max_frames_per_update};
+    clock::time_point last = clock::now();
+    while (active.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(commands_mutex);
+            pending.swap(commands);
+        }
+        for (auto& c : pending)
+            c(cloth, settings);
+        pending.clear();
+        timestep.step = settings.frame_time;
+        timestep.max_frames = settings.max_frames_per_update;
+        step.store(settings.frame_time, std::memory_order_relaxed);
+
+        const clock::time_point now = clock::now();
+        const int frames = timestep.advance(std::chrono::duration<double>(now - last).count());
+        last = now;
+        for (int f=0; f<frames; ++f) {
+            cloth.simulate_XPBD(settings);
+            ++frame;
+        }
+        if (frames > 0)
+            publish();
+
+        const double wait = timestep.step - timestep.accumulator;
+        std::this_thread::sleep_until(now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(wait)));
+    }
+}
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ * @brief Contains the class SimulationThread, which steps a cloth on its own thread.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cloth/cloth.h"
+#include "cloth/settings.h"
+#include "cloth/snapshot.h"
+#include "cloth/timestep.h"
+#include "parallel/triple_buffer.h"
+
+namespace cloth{
+/**
+ * @class SimulationThread
+ * @brief Runs Cloth::simulate_XPBD at a fixed rate of 1 / frame_time on a dedicated thread, so
+ * the physics rate does not depend on the render rate (vsync, slow frames) and vice versa. The
+ * frames to run are counted by a FixedTimestep.
+ *
+ * After every frame the positions are published through a TripleBuffer of Snapshot: the render
+ * thread never waits on the simulation and never reads the cloth while it is being solved. Changes
+ * to the cloth or to the settings from other threads go through post(), they are applied between
+ * two frames. While the thread runs the cloth must not be touched directly.
+ */
+class SimulationThread
+{
+public:
+    using Command = std::function<void(Cloth&, SimSettings&)>;
+
+    SimulationThread(Cloth& cloth, const SimSettings& settings);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void start();
+    /**
+     * Finish the current frame and join the thread; the cloth can be used directly again
+     */
+    void stop();
+    bool running() const { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * Queue command to run on the simulation thread before the next frame
+     */
+    void post(Command command);
+
+    /**
+     * Newest snapshot published since the last call, or nullptr. The pointer is valid until the
+     * next call. Only one thread may poll.
+     */
+    const Snapshot* poll();
+
+    /**
+     * Wall seconds between two frames
+     */
+    double step_seconds() const { return step.load(std::memory_order_relaxed); }
+
+private:
+    void loop();
+    void publish();
+
+    Cloth& cloth;
+    SimSettings settings;
+    TripleBuffer<Snapshot> snapshots;
+    std::mutex commands_mutex;
+    std::vector<Command> commands;
+    std::atomic<bool> active {false};
+    std::atomic<double> step;
+    std::uint64_t frame = 0;
+    std::thread thread;
+};
+}
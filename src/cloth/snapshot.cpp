@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @brief Contains the implementation of Snapshot and SnapshotInterpolator.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <utility>
+#include "cloth/snapshot.h"
+
+namespace cloth{
+
+void Snapshot::capture(const Particles& p) {
+    x.assign(p.x.begin(), p.x.end());
+    y.assign(p.y.begin(), p.y.end());
+    z.assign(p.z.begin(), p.z.end());
+}
+
+void Snapshot::blend(const Snapshot& a, const Snapshot& b, float t) {
+    const std::size_t n = b.size();
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    for (std::size_t i=0; i<n; ++i) {
+        x[i] = a.x[i] + (b.x[i] - a.x[i]) * t;
+        y[i] = a.y[i] + (b.y[i] - a.y[i]) * t;
+        z[i] = a.z[i] + (b.z[i] - a.z[i]) * t;
+    }
+    frame = b.frame;
+    sim_time = b.sim_time;
+    published = b.published;
+}
+
+void SnapshotInterpolator::push(const Snapshot& s) {
+    std::swap(previous, newest);
+    newest = s; // reuses the capacity of the buffers
+    ++received;
+}
+
+const Snapshot& SnapshotInterpolator::at(Snapshot::clock::time_point now, double step) {
+    if (received < 2 || previous.size() != newest.size())
+        return newest;
+    const double elapsed = std::chrono::duration<double>(now - newest.published).count();
+    const float alpha = static_cast<float>(std::clamp(step > 0.0 ? elapsed / step : 1.0, 0.0, 1.0));
+    if (alpha >= 1.0f)
+        return newest;
+    blended.blend(previous, newest, alpha);
+    return blended;
+}
+}
@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @brief Contains the struct Snapshot and the class SnapshotInterpolator, the state handed from
+ * the simulation thread to the render thread.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "node/aligned_allocator.h"
+#include "node/particles.h"
+
+namespace cloth{
+/**
+ * @struct Snapshot
+ * @brief Copy of the node positions at the end of a simulated frame. Topology, uvs and everything
+ * else the renderer needs is constant, so positions are all that crosses threads.
+ */
+struct Snapshot
+{
+    using clock = std::chrono::steady_clock;
+
+    aligned_vector<float> x, y, z;
+    /**
+     * Number of frames simulated when the snapshot was taken
+    */
+    std::uint64_t frame = 0;
+    /**
+     * Simulated time of the snapshot, in seconds
+    */
+    double sim_time = 0.0;
+    /**
+     * Wall clock time at which the snapshot was published
+    */
+    clock::time_point published;
+
+    std::size_t size() const { return x.size(); }
+
+    /**
+     * Copy the positions of p. No allocation once the snapshot has the size of p.
+     */
+    void capture(const Particles& p);
+
+    /**
+     * Set the positions to a + (b - a) * t, the time stamps to those of b
+     */
+    void blend(const Snapshot& a, const Snapshot& b, float t);
+};
+
+/**
+ * @class SnapshotInterpolator
+ * @brief Render side of the hand off: it keeps the last two snapshots received and blends them,
+ * so the displayed state moves smoothly whatever the ratio between render and physics rate.
+ *
+ * The view runs one physics step behind the newest snapshot: at wall time now it shows
+ * previous + (newest - previous) * alpha with alpha = (now - newest.published) / step, clamped to
+ * [0, 1]. When the simulation stalls the view stops on the newest state instead of extrapolating.
+ */
+class SnapshotInterpolator
+{
+public:
+    /**
+     * Take newest as the latest state; the one received before becomes the previous state
+     */
+    void push(const Snapshot& newest);
+
+    /**
+     * State to display at wall time now
+     * @param now wall clock time
+     * @param step wall seconds between two snapshots (the physics period)
+     */
+    const Snapshot& at(Snapshot::clock::time_point now, double step);
+
+    /**
+     * True once at least one snapshot was pushed
+     */
+    bool ready() const { return received > 0; }
+
+private:
+    Snapshot previous, newest, blended;
+    std::uint64_t received = 0;
+};
+}
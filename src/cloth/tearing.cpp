@@ -0,0 +1,378 @@
+/**
+ * @file
+ * @brief Contains the implementation of the tearing of class Cloth.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <glm.hpp>
+#include "cloth/cloth.h"
+#include "constraints/color_edit.h"
+
+namespace cloth{
+
+namespace {
+
+// constraints per block of the strain search, fixed so the candidates do not depend on the pool
+constexpr std::size_t tear_grain = 8192;
+
+using Triangle = Cloth::triangle_struct;
+
+bool has(const Triangle& t, std::uint32_t i) {
+    const int n = static_cast<int>(i);
+    return t.a == n || t.b == n || t.c == n;
+}
+
+/**
+ * Vertex of t that is neither i nor j
+ */
+std::uint32_t third(const Triangle& t, std::uint32_t i, std::uint32_t j) {
+    for (int n : {t.a, t.b, t.c})
+        if (static_cast<std::uint32_t>(n) != i && static_cast<std::uint32_t>(n) != j)
+            return static_cast<std::uint32_t>(n);
+    return i;
+}
+
+void rename(Triangle& t, std::uint32_t from, std::uint32_t to) {
+    for (int* n : {&t.a, &t.b, &t.c})
+        if (*n == static_cast<int>(from))
+            *n = static_cast<int>(to);
+}
+
+/**
+ * Number of triangles of node (in node_tris) that also hold j, and k when k is not node
+ */
+std::size_t count_triangles(const Adjacency& node_tris, const std::vector<Triangle>& tris, std::uint32_t node,
+                            std::uint32_t j, std::uint32_t k) {
+    std::size_t n = 0;
+    for (std::uint32_t e=node_tris.begin(node); e<node_tris.end(node); ++e) {
+        const Triangle& t = tris[node_tris.items[e]];
+        n += has(t, j) && has(t, k);
+    }
+    return n;
+}
+
+template <typename Hinges>
+void build_hinge_table(Adjacency& table, const Hinges& cs, std::size_t particle_count) {
+    std::vector<std::uint32_t> members;
+    members.reserve(4 * cs.size());
+    for (std::size_t i=0; i<cs.size(); ++i)
+        members.insert(members.end(), {cs.p0[i], cs.p1[i], cs.p2[i], cs.p3[i]});
+    table.build(members.data(), cs.size(), 4, particle_count);
+}
+
+void build_distance_table(Adjacency& table, const DistanceConstraints& cs, std::size_t particle_count) {
+    std::vector<std::uint32_t> members;
+    members.reserve(2 * cs.size());
+    for (std::size_t i=0; i<cs.size(); ++i)
+        members.insert(members.end(), {cs.first(i), cs.second(i)});
+    table.build(members.data(), cs.size(), 2, particle_count);
+}
+
+/**
+ * Keep the table of a hinge set up to date while its hinges move
+ */
+template <typename Hinges>
+auto hinge_mover(Adjacency& table, const Hinges& cs) {
+    return [&table, &cs](std::size_t from, std::size_t to) {
+        for (std::uint32_t p : {cs.p0[to], cs.p1[to], cs.p2[to], cs.p3[to]})
+            table.replace(p, static_cast<std::uint32_t>(from), static_cast<std::uint32_t>(to));
+    };
+}
+
+auto distance_mover(Adjacency& table, const DistanceConstraints& cs) {
+    return [&table, &cs](std::size_t from, std::size_t to) {
+        for (std::uint32_t p : {cs.first(to), cs.second(to)})
+            table.replace(p, static_cast<std::uint32_t>(from), static_cast<std::uint32_t>(to));
+    };
+}
+
+/**
+ * Constraints of key k, sorted, so a split does not depend on the order of the table
+ */
+std::vector<std::uint32_t> sorted_items(const Adjacency& table, std::size_t k) {
+    std::vector<std::uint32_t> items(table.items.begin() + table.begin(k), table.items.begin() + table.end(k));
+    std::sort(items.begin(), items.end());
+    return items;
+}
+
+/**
+ * Drop the hinge whose edge is (e0, e1) and whose opposite vertices are a and b
+ */
+template <typename Hinges>
+void remove_hinge(Hinges& cs, Adjacency& table, std::uint32_t e0, std::uint32_t e1, std::uint32_t a, std::uint32_t b) {
+    for (std::uint32_t k=table.begin(e0); k<table.end(e0); ++k) {
+        const std::uint32_t h = table.items[k];
+        const bool edge = (cs.p0[h] == e0 && cs.p1[h] == e1) || (cs.p0[h] == e1 && cs.p1[h] == e0);
+        const bool wings = (cs.p2[h] == a && cs.p3[h] == b) || (cs.p2[h] == b && cs.p3[h] == a);
+        if (!edge || !wings)
+            continue;
+        for (std::uint32_t p : {cs.p0[h], cs.p1[h], cs.p2[h], cs.p3[h]})
+            table.remove(p, h);
+        cs.remove(h, hinge_mover(table, cs));
+        return;
+    }
+}
+
+/**
+ * Give the hinges of v whose triangle holding v moved to w their new node
+ */
+template <typename Hinges>
+void rename_hinges(Hinges& cs, Adjacency& table, const Adjacency& node_tris, const std::vector<Triangle>& tris,
+                   std::uint32_t v, std::uint32_t w) {
+    for (std::uint32_t h : sorted_items(table, v)) {
+        // a triangle of the hinge that holds v: (p0, p1, p3) when v is p3, (p0, p1, p2) otherwise
+        std::uint32_t j, k;
+        if (cs.p3[h] == v) {
+            j = cs.p0[h];
+            k = cs.p1[h];
+        } else {
+            const std::uint32_t others[3] = {cs.p0[h], cs.p1[h], cs.p2[h]};
+            std::uint32_t rest[2] = {v, v};
+            int n = 0;
+            for (std::uint32_t p : others)
+                if (p != v && n < 2)
+                    rest[n++] = p;
+            j = rest[0];
+            k = rest[1];
+        }
+        if (count_triangles(node_tris, tris, w, j, k) == 0)
+            continue;
+        for (std::vector<std::uint32_t>* p : {&cs.p0, &cs.p1, &cs.p2, &cs.p3})
+            if ((*p)[h] == v)
+                (*p)[h] = w;
+        table.remove(v, h);
+        table.add(w, h);
+    }
+}
+}
+
+void Cloth::prepare_tearing() {
+    if (tearing.revision == constraint_revision && tearing.stretch.keys() == particles.size())
+        return;
+    build_distance_table(tearing.stretch, s_cs, particles.size());
+    switch (bend_model) {
+        case BendModel::Distance: build_distance_table(tearing.bend, b_cs, particles.size()); break;
+        case BendModel::Dihedral: build_hinge_table(tearing.bend, dihedral_cs, particles.size()); break;
+        case BendModel::Isometric: build_hinge_table(tearing.bend, isometric_cs, particles.size()); break;
+    }
+    tearing.revision = constraint_revision;
+}
+
+int Cloth::XPBD_tear(const SimSettings& s) {
+    ScopedPhase phase {profiler, Phase::Tearing};
+    if (s_cs.empty() || all_tris.empty() || s.max_tears <= 0)
+        return 0;
+
+    const float limit = s.tear_strain;
+    std::vector<std::pair<float, std::uint32_t>> strained;
+    parallel_gather(pool, 0, s_cs.size(), tear_grain, tearing.block_candidates, strained,
+                    [&](std::size_t begin, std::size_t end, std::vector<std::pair<float, std::uint32_t>>& out) {
+        for (std::size_t c=begin; c<end; ++c) {
+            const float rest = s_cs.rest_dist[c];
+            if (rest <= 0.0f)
+                continue;
+            const float strain = (particles.distance(s_cs.first(c), s_cs.second(c)) - rest) / rest;
+            if (strain > limit)
+                out.emplace_back(strain, static_cast<std::uint32_t>(c));
+        }
+    });
+    if (strained.empty())
+        return 0;
+    // the most strained first, ties by index so that the order does not depend on the pool
+    std::sort(strained.begin(), strained.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+    // constraints move while nodes are split, they are found again from their particles
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    edges.reserve(strained.size());
+    for (const auto& c : strained)
+        edges.emplace_back(s_cs.first(c.second), s_cs.second(c.second));
+
+    prepare_tearing();
+    int split = 0;
+    for (auto [a, b] : edges) {
+        if (split >= s.max_tears)
+            break;
+        // an earlier split of a or b may have given the constraint another node
+        bool found = false;
+        for (std::uint32_t k=tearing.stretch.begin(a); k<tearing.stretch.end(a) && !found; ++k) {
+            const std::uint32_t c = tearing.stretch.items[k];
+            found = s_cs.first(c) == b || s_cs.second(c) == b;
+        }
+        if (!found)
+            continue;
+        // split the node with more triangles first, so the crack runs into the cloth
+        if (node_tris.count(b) > node_tris.count(a))
+            std::swap(a, b);
+        if (split_node(a, b) || split_node(b, a))
+            ++split;
+    }
+    if (split == 0)
+        return 0;
+
+    tearing.splits += static_cast<std::size_t>(split);
+    tearing.topology_stale = true;
+    s_jacobi.invalidate();
+    b_jacobi.invalidate();
+    // the geodesic distances of the tethers follow the stretch constraints
+    if (!tethers.empty())
+        generate_tethers();
+    ++constraint_revision;
+    tearing.revision = constraint_revision;
+    return split;
+}
+
+bool Cloth::split_node(std::uint32_t v, std::uint32_t toward) {
+    // a pinned node holds, the crack starts next to it
+    if (particles.w[v] == 0.0f)
+        return false;
+    const glm::vec3 origin = particles.position(v);
+    const glm::vec3 normal = particles.position(toward) - origin;
+    std::vector<std::uint32_t> moving;
+    for (std::uint32_t k=node_tris.begin(v); k<node_tris.end(v); ++k) {
+        const Triangle& t = all_tris[node_tris.items[k]];
+        const glm::vec3 center = (particles.position(t.a) + particles.position(t.b) + particles.position(t.c)) / 3.0f;
+        if (glm::dot(center - origin, normal) > 0.0f)
+            moving.push_back(node_tris.items[k]);
+    }
+    if (moving.empty() || moving.size() == node_tris.count(v))
+        return false;
+
+    // the width set_index_width gives for the new particle count, which checkpoints rely on; add
+    // would only widen once a constraint reaches the new node
+    if (particles.size() > std::numeric_limits<std::uint16_t>::max()) {
+        s_cs.widen();
+        b_cs.widen();
+    }
+    const std::uint32_t w = static_cast<std::uint32_t>(particles.split(v));
+    const glm::vec3 n = normals[v];
+    const glm::vec2 uv = uvs[v];
+    normals.push_back(n);
+    uvs.push_back(uv);
+    self_collision.add_split(v);
+
+    // the triangles beyond the plane take the new node; the grid keeps its two halves in step
+    const bool grid = up_left_tris.size() + low_right_tris.size() == all_tris.size();
+    for (std::uint32_t t : moving) {
+        rename(all_tris[t], v, w);
+        if (grid) {
+            if (t < up_left_tris.size())
+                up_left_tris[t] = all_tris[t];
+            else
+                low_right_tris[t - up_left_tris.size()] = all_tris[t];
+        }
+        tearing.changed_triangles.push_back(t);
+    }
+    node_tris.split(v, [&](std::uint32_t t) { return has(all_tris[t], w); });
+    tearing.stretch.add_key();
+    tearing.bend.add_key();
+
+    // stretch constraints follow their triangles; an edge left with triangles on both sides is the
+    // crack, it gets a constraint for each side
+    struct Crack { std::uint32_t other; bool first; float rest, compliance; };
+    std::vector<Crack> cracks;
+    for (std::uint32_t c : sorted_items(tearing.stretch, v)) {
+        const bool first = s_cs.first(c) == v;
+        const std::uint32_t o = first ? s_cs.second(c) : s_cs.first(c);
+        if (count_triangles(node_tris, all_tris, w, o, w) == 0)
+            continue;
+        if (count_triangles(node_tris, all_tris, v, o, v) > 0) {
+            cracks.push_back({o, first, s_cs.rest_dist[c], s_cs.compliance[c]});
+            continue;
+        }
+        s_cs.set_particles(c, first ? w : o, first ? o : w);
+        tearing.stretch.remove(v, c);
+        tearing.stretch.add(w, c);
+    }
+    for (const Crack& crack : cracks) {
+        // the first colour that holds neither w nor the other node
+        std::vector<std::uint8_t> used(s_cs.colors() + 1, 0);
+        if (s_cs.colors() > 0)
+            for (std::uint32_t p : {w, crack.other})
+                for (std::uint32_t k=tearing.stretch.begin(p); k<tearing.stretch.end(p); ++k)
+                    used[color_of(s_cs.color_offsets, tearing.stretch.items[k])] = 1;
+        const std::size_t color = static_cast<std::size_t>(std::find(used.begin(), used.end(), 0) - used.begin());
+        const std::size_t c = s_cs.insert(color, crack.first ? w : crack.other, crack.first ? crack.other : w,
+                                          crack.compliance, crack.rest, distance_mover(tearing.stretch, s_cs));
+        tearing.stretch.add(w, static_cast<std::uint32_t>(c));
+        tearing.stretch.add(crack.other, static_cast<std::uint32_t>(c));
+    }
+
+    // the hinges across the crack are torn, found from the triangles since an edge may have no
+    // stretch constraint (the diagonals of a grid)
+    std::vector<std::uint32_t> crack_nodes;
+    for (std::uint32_t j=node_tris.begin(w); j<node_tris.end(w); ++j) {
+        const Triangle& t = all_tris[node_tris.items[j]];
+        for (int n : {t.a, t.b, t.c}) {
+            const std::uint32_t o = static_cast<std::uint32_t>(n);
+            if (o != w && count_triangles(node_tris, all_tris, v, o, v) > 0)
+                crack_nodes.push_back(o);
+        }
+    }
+    std::sort(crack_nodes.begin(), crack_nodes.end());
+    crack_nodes.erase(std::unique(crack_nodes.begin(), crack_nodes.end()), crack_nodes.end());
+    for (std::uint32_t other : crack_nodes) {
+        for (std::uint32_t i=node_tris.begin(v); i<node_tris.end(v); ++i) {
+            const Triangle& ta = all_tris[node_tris.items[i]];
+            if (!has(ta, other))
+                continue;
+            for (std::uint32_t j=node_tris.begin(w); j<node_tris.end(w); ++j) {
+                const Triangle& tb = all_tris[node_tris.items[j]];
+                if (!has(tb, other))
+                    continue;
+                const std::uint32_t a = third(ta, v, other);
+                const std::uint32_t b = third(tb, w, other);
+                switch (bend_model) {
+                    case BendModel::Distance:
+                        for (std::uint32_t k=tearing.bend.begin(a); k<tearing.bend.end(a); ++k) {
+                            const std::uint32_t h = tearing.bend.items[k];
+                            if ((b_cs.first(h) == a && b_cs.second(h) == b) || (b_cs.first(h) == b && b_cs.second(h) == a)) {
+                                tearing.bend.remove(a, h);
+                                tearing.bend.remove(b, h);
+                                b_cs.remove(h, distance_mover(tearing.bend, b_cs));
+                                break;
+                            }
+                        }
+                        break;
+                    case BendModel::Dihedral: remove_hinge(dihedral_cs, tearing.bend, v, other, a, b); break;
+                    case BendModel::Isometric: remove_hinge(isometric_cs, tearing.bend, v, other, a, b); break;
+                }
+            }
+        }
+    }
+
+    // bending constraints follow the triangle that holds v
+    switch (bend_model) {
+        case BendModel::Distance:
+            for (std::uint32_t h : sorted_items(tearing.bend, v)) {
+                // v is a wing of the hinge: its triangle (v, j, k) faces the triangle (j, k, o)
+                const bool first = b_cs.first(h) == v;
+                const std::uint32_t o = first ? b_cs.second(h) : b_cs.first(h);
+                bool moved = false;
+                for (std::uint32_t i=node_tris.begin(w); i<node_tris.end(w) && !moved; ++i) {
+                    const Triangle& t = all_tris[node_tris.items[i]];
+                    const std::uint32_t j = third(t, w, third(t, w, w));
+                    const std::uint32_t k = third(t, w, j);
+                    moved = count_triangles(node_tris, all_tris, j, k, o) > 0;
+                }
+                if (!moved)
+                    continue;
+                b_cs.set_particles(h, first ? w : o, first ? o : w);
+                tearing.bend.remove(v, h);
+                tearing.bend.add(w, h);
+            }
+            break;
+        case BendModel::Dihedral: rename_hinges(dihedral_cs, tearing.bend, node_tris, all_tris, v, w); break;
+        case BendModel::Isometric: rename_hinges(isometric_cs, tearing.bend, node_tris, all_tris, v, w); break;
+    }
+    return true;
+}
+}
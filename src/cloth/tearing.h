@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @brief Contains the struct Tearing, the bookkeeping of a cloth that tears.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "cloth/adjacency.h"
+
+namespace cloth{
+/**
+ * @struct Tearing
+ * @brief What Cloth::XPBD_tear keeps between two tears. A tear splits a node in two and rewrites only
+ * the triangles and constraints around it, so it needs the constraints of every particle; these
+ * tables are built on the first tear and edited with the constraints afterwards, they are built
+ * again only when a constraint set is regenerated.
+ *
+ * Every triangle rewritten by a split is appended to changed_triangles. The journal is never
+ * cleared: a view of the cloth (e.g. render::ClothRenderer) remembers how much of it it has applied
+ * and uploads only the triangles that follow, and the particles past the ones it has.
+ */
+struct Tearing
+{
+    /**
+     * Stretch constraints of every particle, indices in Cloth::s_cs
+    */
+    Adjacency stretch;
+    /**
+     * Bending constraints of every particle, indices in the set of the bending model
+    */
+    Adjacency bend;
+    /**
+     * Revision of the constraints the tables were built from
+    */
+    std::uint64_t revision = ~std::uint64_t(0);
+    /**
+     * Triangles whose nodes changed, in the order of the splits
+    */
+    std::vector<std::uint32_t> changed_triangles;
+    /**
+     * Nodes split so far
+    */
+    std::size_t splits = 0;
+    /**
+     * Set by a split: Cloth::topology no longer matches the triangles
+    */
+    bool topology_stale = false;
+    /**
+     * Strained constraints of every block of the last search, (strain, constraint)
+    */
+    std::vector<std::vector<std::pair<float, std::uint32_t>>> block_candidates;
+};
+}
@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Contains the implementation of FixedTimestep and SubstepController.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "cloth/timestep.h"
+
+namespace cloth{
+
+static constexpr std::size_t particle_grain = 4096;
+
+int FixedTimestep::advance(double real_delta) {
+    if (step <= 0.0)
+        return 0;
+    accumulator += std::max(real_delta, 0.0);
+    int frames = static_cast<int>(accumulator / step);
+    if (frames > max_frames) {
+        dropped += static_cast<std::uint64_t>(frames - max_frames);
+        frames = max_frames;
+        accumulator = 0.0;
+        return frames;
+    }
+    accumulator -= frames * step;
+    return frames;
+}
+
+float max_particle_speed(const Particles& p, ThreadPool* pool) {
+    const float result = parallel_reduce(pool, 0, p.size(), particle_grain, 0.0f, [&](std::size_t begin, std::size_t end) {
+        float m = 0.0f;
+        for (std::size_t i=begin; i<end; ++i) {
+            if (p.w[i] == 0.0f)
+                continue;
+            m = std::max(m, p.vx[i]*p.vx[i] + p.vy[i]*p.vy[i] + p.vz[i]*p.vz[i]);
+        }
+        return m;
+    }, [](float a, float b) { return std::max(a, b); });
+    return std::sqrt(result);
+}
+
+int SubstepController::next(const Particles& p, const DistanceConstraints& stretch, const SimSettings& s, ThreadPool* pool) {
+    const int lo = std::max(1, s.min_substeps);
+    const int hi = std::max(lo, s.max_substeps);
+    if (substeps == 0)
+        substeps = std::clamp(s.iteration_per_frame, lo, hi);
+
+    if (rest_of != stretch.size()) {
+        shortest_rest = 0.0f;
+        for (float r : stretch.rest_dist)
+            if (r > 0.0f && (shortest_rest == 0.0f || r < shortest_rest))
+                shortest_rest = r;
+        rest_of = stretch.size();
+    }
+
+    strain = stretch.residual(p, pool).rms;
+    int by_error = substeps;
+    if (s.target_strain > 0.0f)
+        by_error = static_cast<int>(std::ceil(substeps * std::sqrt(strain / s.target_strain)));
+
+    max_speed = max_particle_speed(p, pool);
+    int by_motion = lo;
+    const double travel = s.max_substep_travel * shortest_rest;
+    if (travel > 0.0)
+        by_motion = static_cast<int>(std::ceil(max_speed * s.frame_time / travel));
+
+    int wanted = std::max(by_error, by_motion);
+    const int slowest_decrease = static_cast<int>(std::ceil(0.9 * substeps));
+    if (wanted < slowest_decrease)
+        wanted = slowest_decrease;
+    substeps = std::clamp(wanted, lo, hi);
+    return substeps;
+}
+}
@@ -0,0 +1,107 @@
+/**
+ * @file
+ * @brief Contains the classes FixedTimestep and SubstepController, which decide how much and how
+ * finely the simulation advances.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "cloth/settings.h"
+#include "constraints/d_constr.h"
+#include "node/particles.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class FixedTimestep
+ * @brief Accumulates real elapsed time and turns it into a whole number of fixed frames, so the
+ * simulation runs in real time whatever the render rate.
+ *
+ * When a frame takes longer to simulate than it simulates, the accumulator would grow without
+ * bound (spiral of death); at most max_frames frames are handed out per call and the excess
+ * time is dropped, the simulation then runs in slow motion instead of freezing.
+ */
+class FixedTimestep
+{
+public:
+    /**
+     * Simulated seconds per frame
+    */
+    double step;
+    /**
+     * Maximum number of frames returned by a single advance()
+    */
+    int max_frames;
+    /**
+     * Time not yet simulated, in [0, step) after advance()
+    */
+    double accumulator = 0.0;
+    /**
+     * Total frames dropped by the clamp
+    */
+    std::uint64_t dropped = 0;
+
+    explicit FixedTimestep(double step = 1.0 / 60.0, int max_frames = 4) : step(step), max_frames(max_frames) {}
+
+    /**
+     * Add real_delta seconds and return the number of frames to simulate now
+     */
+    int advance(double real_delta);
+
+    /**
+     * Fraction of a frame left in the accumulator, to blend the last two frames for display
+     */
+    double alpha() const { return step > 0.0 ? accumulator / step : 0.0; }
+};
+
+/**
+ * @class SubstepController
+ * @brief Chooses the number of XPBD substeps of the next frame from the state of the cloth.
+ *
+ * Two bounds are taken, the larger wins:
+ * - error: the rms relative strain of the stretch constraints (which are stiff, so any strain is
+ *   solver error) is compared with target_strain. XPBD error falls roughly with the square of the
+ *   substep count, so the count is scaled by sqrt(strain / target_strain).
+ * - motion: no particle may travel more than max_substep_travel times the shortest rest length in
+ *   one substep, so fast motion is resolved without tunnelling through the constraints.
+ *
+ * Increases apply at once, decreases by at most 10% per frame to avoid oscillating between
+ * counts. The result is clamped to [min_substeps, max_substeps].
+ */
+class SubstepController
+{
+public:
+    /**
+     * Number of substeps for the next frame
+     * @param p particles
+     * @param stretch stretch constraints of the cloth
+     * @param s settings (frame_time, limits and targets)
+     * @param pool worker pool, may be null
+     */
+    int next(const Particles& p, const DistanceConstraints& stretch, const SimSettings& s, ThreadPool* pool);
+
+    /**
+     * Substeps chosen by the last call to next(), 0 before
+    */
+    int substeps = 0;
+    /**
+     * Strain and maximum speed measured by the last call to next()
+    */
+    double strain = 0.0;
+    float max_speed = 0.0f;
+
+private:
+    float shortest_rest = 0.0f;
+    std::size_t rest_of = 0;
+};
+
+/**
+ * Largest particle speed, the same for any number of threads
+ */
+float max_particle_speed(const Particles& p, ThreadPool* pool);
+}
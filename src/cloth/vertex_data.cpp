@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @brief Contains the implementation of the cloth vertex packing.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "cloth/vertex_data.h"
+
+namespace cloth{
+
+void pack_stream_vertices(const Cloth& c, float* out) {
+    ScopedPhase phase {c.profiler, Phase::Packing};
+    const Particles& p = c.particles;
+    const std::size_t n = p.size();
+    for (std::size_t i=0; i<n; ++i) {
+        out[0] = p.x[i];
+        out[1] = p.y[i];
+        out[2] = p.z[i];
+        out[3] = c.normals[i].x;
+        out[4] = c.normals[i].y;
+        out[5] = c.normals[i].z;
+        out += stream_vertex_floats;
+    }
+}
+
+static void gather_stream_vertices(const Adjacency& node_tris, std::size_t n,
+                                   const float* x, const float* y, const float* z,
+                                   const glm::vec3* faces, float* out, ThreadPool* pool) {
+    parallel_for(pool, 0, n, 4096, [&](std::size_t begin, std::size_t end) {
+        float* o = out + begin * stream_vertex_floats;
+        for (std::size_t i=begin; i<end; ++i) {
+            const glm::vec3 nrm = gather_normal(node_tris, faces, i);
+            o[0] = x[i];
+            o[1] = y[i];
+            o[2] = z[i];
+            o[3] = nrm.x;
+            o[4] = nrm.y;
+            o[5] = nrm.z;
+            o += stream_vertex_floats;
+        }
+    });
+}
+
+void write_stream_vertices(Cloth& c, float* out) {
+    {
+        ScopedPhase phase {c.profiler, Phase::Normals};
+        c.compute_face_normals();
+    }
+    ScopedPhase phase {c.profiler, Phase::Packing};
+    const Particles& p = c.particles;
+    gather_stream_vertices(c.node_tris, p.size(), p.x.data(), p.y.data(), p.z.data(), c.face_normals.data(), out, c.pool);
+}
+
+void write_stream_vertices(const Cloth& topology, const float* x, const float* y, const float* z,
+                           glm::vec3* faces, float* out, ThreadPool* pool) {
+    compute_face_normals(topology.tri_indices(), topology.all_tris.size(), x, y, z, faces, pool);
+    gather_stream_vertices(topology.node_tris, topology.particles.size(), x, y, z, faces, out, pool);
+}
+
+std::vector<unsigned> triangle_indices(const Cloth& c) {
+    std::vector<unsigned> indices;
+    indices.reserve(3 * c.all_tris.size());
+    for (const auto& t : c.all_tris) {
+        indices.push_back(static_cast<unsigned>(t.a));
+        indices.push_back(static_cast<unsigned>(t.b));
+        indices.push_back(static_cast<unsigned>(t.c));
+    }
+    return indices;
+}
+}
@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @brief Contains the CPU side packing of cloth vertices for the renderer.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "cloth/cloth.h"
+
+namespace cloth{
+/**
+ * Floats per streamed vertex: position (3), normal (3). One vertex per particle.
+ */
+constexpr std::size_t stream_vertex_floats = 6;
+
+/**
+ * Write position and normal of every particle of c, interleaved (see stream_vertex_floats)
+ * @param c cloth
+ * @param out buffer of at least c.particles.size() * stream_vertex_floats floats
+ */
+void pack_stream_vertices(const Cloth& c, float* out);
+
+/**
+ * Compute the normals of c and write position and normal of every particle straight into out
+ * (same layout as pack_stream_vertices), without going through c.normals. Face normals are
+ * computed once per triangle, then each vertex gathers its incident faces, both passes in
+ * parallel on c.pool.
+ * @param c cloth
+ * @param out buffer of at least c.particles.size() * stream_vertex_floats floats
+ */
+void write_stream_vertices(Cloth& c, float* out);
+
+/**
+ * Same as write_stream_vertices(Cloth&, float*) for positions that are not those of the cloth,
+ * e.g. a Snapshot taken by the simulation thread
+ * @param topology cloth whose triangles and node adjacency are used, its positions are not read
+ * @param x,y,z positions, one per node of topology
+ * @param faces scratch of at least topology.all_tris.size() face normals
+ * @param out buffer of at least topology.particles.size() * stream_vertex_floats floats
+ * @param pool worker pool, may be null
+ */
+void write_stream_vertices(const Cloth& topology, const float* x, const float* y, const float* z,
+                           glm::vec3* faces, float* out, ThreadPool* pool);
+
+/**
+ * Triangle list of c as three particle indices per triangle, for a static index buffer
+ */
+std::vector<unsigned> triangle_indices(const Cloth& c);
+}
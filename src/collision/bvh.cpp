@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @brief Contains the implementation of class Bvh.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <limits>
+#include "collision/bvh.h"
+#include "collision/geometry.h"
+
+namespace cloth{
+
+static float area(const glm::vec3& lo, const glm::vec3& hi) {
+    const glm::vec3 e = glm::max(hi - lo, glm::vec3(0.0f));
+    return e.x*e.y + e.y*e.z + e.z*e.x;
+}
+
+void Bvh::build(const glm::vec3* vertices, const std::uint32_t* indices, std::size_t triangles) {
+    nodes.clear();
+    order.resize(triangles);
+    if (triangles == 0)
+        return;
+    std::vector<Item> items(triangles);
+    for (std::size_t t=0; t<triangles; ++t) {
+        const glm::vec3& a = vertices[indices[3*t]];
+        const glm::vec3& b = vertices[indices[3*t + 1]];
+        const glm::vec3& c = vertices[indices[3*t + 2]];
+        items[t].lo = glm::min(a, glm::min(b, c));
+        items[t].hi = glm::max(a, glm::max(b, c));
+        items[t].centroid = (items[t].lo + items[t].hi) * 0.5f;
+        order[t] = static_cast<std::uint32_t>(t);
+    }
+    nodes.reserve(2 * triangles / max_leaf + 1);
+    build_node(items, 0, static_cast<std::uint32_t>(triangles));
+}
+
+void Bvh::build_node(std::vector<Item>& items, std::uint32_t begin, std::uint32_t end) {
+    const std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back({});
+    glm::vec3 lo {std::numeric_limits<float>::max()}, hi {std::numeric_limits<float>::lowest()};
+    glm::vec3 clo = lo, chi = hi;
+    for (std::uint32_t k=begin; k<end; ++k) {
+        const Item& it = items[order[k]];
+        lo = glm::min(lo, it.lo);
+        hi = glm::max(hi, it.hi);
+        clo = glm::min(clo, it.centroid);
+        chi = glm::max(chi, it.centroid);
+    }
+    nodes[index].lo = lo;
+    nodes[index].hi = hi;
+    const std::uint32_t count = end - begin;
+
+    // binned SAH: best plane among bins - 1 candidates per axis
+    int best_axis = -1;
+    std::uint32_t best_bin = 0;
+    float best_cost = std::numeric_limits<float>::max();
+    for (int axis=0; axis<3 && count > 1; ++axis) {
+        const float extent = chi[axis] - clo[axis];
+        if (extent <= 0.0f)
+            continue;
+        glm::vec3 blo[bins], bhi[bins];
+        std::uint32_t bcount[bins] = {};
+        for (unsigned b=0; b<bins; ++b) {
+            blo[b] = glm::vec3(std::numeric_limits<float>::max());
+            bhi[b] = glm::vec3(std::numeric_limits<float>::lowest());
+        }
+        const float scale = bins / extent;
+        for (std::uint32_t k=begin; k<end; ++k) {
+            const Item& it = items[order[k]];
+            const unsigned b = std::min(bins - 1, static_cast<unsigned>((it.centroid[axis] - clo[axis]) * scale));
+            ++bcount[b];
+            blo[b] = glm::min(blo[b], it.lo);
+            bhi[b] = glm::max(bhi[b], it.hi);
+        }
+        // sweep from the right for the suffix areas, then from the left
+        float right_area[bins];
+        std::uint32_t right_count[bins];
+        glm::vec3 rlo {std::numeric_limits<float>::max()}, rhi {std::numeric_limits<float>::lowest()};
+        std::uint32_t rc = 0;
+        for (unsigned b=bins - 1; b>0; --b) {
+            rlo = glm::min(rlo, blo[b]);
+            rhi = glm::max(rhi, bhi[b]);
+            rc += bcount[b];
+            right_area[b] = area(rlo, rhi);
+            right_count[b] = rc;
+        }
+        glm::vec3 llo {std::numeric_limits<float>::max()}, lhi {std::numeric_limits<float>::lowest()};
+        std::uint32_t lc = 0;
+        for (unsigned b=0; b<bins - 1; ++b) {
+            llo = glm::min(llo, blo[b]);
+            lhi = glm::max(lhi, bhi[b]);
+            lc += bcount[b];
+            if (lc == 0 || right_count[b + 1] == 0)
+                continue;
+            const float cost = lc * area(llo, lhi) + right_count[b + 1] * right_area[b + 1];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = b;
+            }
+        }
+    }
+
+    // costs in triangle tests: a split pays one more node visit plus the children weighted by area
+    const float node_area = area(lo, hi);
+    const float split_cost = node_area > 0.0f ? traversal_cost + best_cost / node_area : traversal_cost;
+    if (count <= max_leaf && (best_axis < 0 || split_cost >= static_cast<float>(count))) {
+        nodes[index].prims = begin << 4 | count;
+        nodes[index].escape = index + 1;
+        return;
+    }
+
+    std::uint32_t mid;
+    if (best_axis >= 0) {
+        const float scale = bins / (chi[best_axis] - clo[best_axis]);
+        const auto split = std::partition(order.begin() + begin, order.begin() + end, [&](std::uint32_t t) {
+            const unsigned b = std::min(bins - 1, static_cast<unsigned>((items[t].centroid[best_axis] - clo[best_axis]) * scale));
+            return b <= best_bin;
+        });
+        mid = static_cast<std::uint32_t>(split - order.begin());
+    } else {
+        // every centroid in the same place: split the list in half
+        mid = begin + count / 2;
+    }
+    nodes[index].prims = 0;
+    build_node(items, begin, mid);
+    build_node(items, mid, end);
+    nodes[index].escape = static_cast<std::uint32_t>(nodes.size());
+}
+
+void Bvh::refit(const glm::vec3* vertices, const std::uint32_t* indices) {
+    for (std::size_t i=nodes.size(); i-- > 0;) {
+        BvhNode& node = nodes[i];
+        if (node.leaf()) {
+            node.lo = glm::vec3(std::numeric_limits<float>::max());
+            node.hi = glm::vec3(std::numeric_limits<float>::lowest());
+            for (std::uint32_t k=node.first(); k<node.first() + node.count(); ++k) {
+                const std::uint32_t t = order[k];
+                for (int v=0; v<3; ++v) {
+                    node.lo = glm::min(node.lo, vertices[indices[3*t + v]]);
+                    node.hi = glm::max(node.hi, vertices[indices[3*t + v]]);
+                }
+            }
+        } else {
+            const BvhNode& left = nodes[i + 1];
+            const BvhNode& right = nodes[left.escape];
+            node.lo = glm::min(left.lo, right.lo);
+            node.hi = glm::max(left.hi, right.hi);
+        }
+    }
+}
+
+const BvhNode* Bvh::greedy_leaf(const glm::vec3& p) const {
+    if (nodes.empty())
+        return nullptr;
+    std::size_t i = 0;
+    while (!nodes[i].leaf()) {
+        const std::size_t left = i + 1;
+        const std::size_t right = nodes[left].escape;
+        i = box_distance2(p, nodes[left].lo, nodes[left].hi) <= box_distance2(p, nodes[right].lo, nodes[right].hi) ? left : right;
+    }
+    return &nodes[i];
+}
+}
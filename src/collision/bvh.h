@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @brief Contains the class Bvh, a bounding volume hierarchy over the triangles of a mesh.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include "collision/collider.h"
+
+namespace cloth{
+/**
+ * @struct BvhNode
+ * @brief 32 bytes, two nodes per cache line. Nodes are stored in depth first order, so the first
+ * child of an inner node is the next node; escape is the node that follows the whole subtree.
+ */
+struct BvhNode
+{
+    glm::vec3 lo;
+    std::uint32_t escape;
+    glm::vec3 hi;
+    /**
+     * first leaf triangle << 4 | triangle count, count 0 for inner nodes
+     */
+    std::uint32_t prims;
+
+    bool leaf() const { return (prims & 0xF) != 0; }
+    std::uint32_t first() const { return prims >> 4; }
+    std::uint32_t count() const { return prims & 0xF; }
+};
+
+/**
+ * @class Bvh
+ * @brief Binary BVH built with the binned surface area heuristic.
+ *
+ * Traversal needs no stack: a node whose box is rejected jumps to its escape index, an accepted
+ * node goes on with the next one, so a query is one forward pass over a contiguous array. When
+ * the vertices move without changing the topology (animated obstacles), refit() updates the
+ * boxes bottom up in one reverse pass, keeping the tree structure.
+ */
+class Bvh
+{
+public:
+    static constexpr unsigned max_leaf = 4;
+    static constexpr unsigned bins = 12;
+    /**
+     * Cost of visiting a node relative to a triangle test, for the SAH
+     */
+    static constexpr float traversal_cost = 1.0f;
+
+    std::vector<BvhNode> nodes;
+    /**
+     * Triangle ids in leaf order, a leaf covers order[first() .. first() + count())
+     */
+    std::vector<std::uint32_t> order;
+
+    /**
+     * @param vertices mesh vertices
+     * @param indices three vertex indices per triangle
+     * @param triangles number of triangles
+     */
+    void build(const glm::vec3* vertices, const std::uint32_t* indices, std::size_t triangles);
+    void refit(const glm::vec3* vertices, const std::uint32_t* indices);
+
+    Aabb bounds() const {
+        return nodes.empty() ? Aabb{} : Aabb{nodes[0].lo, nodes[0].hi};
+    }
+
+    /**
+     * Leaf reached from the root by always entering the child whose box is closer to p, a cheap
+     * first guess for nearest neighbour searches
+     */
+    const BvhNode* greedy_leaf(const glm::vec3& p) const;
+
+    /**
+     * Visit the tree: accept(node) tells whether to enter a node, leaf(triangle) is called for
+     * every triangle of the accepted leaves. accept may tighten its own test as it goes (e.g.
+     * a nearest neighbour search shrinking its radius).
+     */
+    template <typename Accept, typename Leaf>
+    void traverse(Accept&& accept, Leaf&& leaf) const {
+        std::size_t i = 0;
+        const std::size_t n = nodes.size();
+        while (i < n) {
+            const BvhNode& node = nodes[i];
+            if (!accept(node)) {
+                i = node.escape;
+                continue;
+            }
+            if (node.leaf())
+                for (std::uint32_t k=node.first(); k<node.first() + node.count(); ++k)
+                    leaf(order[k]);
+            ++i;
+        }
+    }
+
+private:
+    struct Item
+    {
+        glm::vec3 lo, hi, centroid;
+    };
+    void build_node(std::vector<Item>& items, std::uint32_t begin, std::uint32_t end);
+};
+}
@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief Contains the implementation of the analytic colliders.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include "collision/collider.h"
+
+namespace cloth{
+
+bool PlaneCollider::distance(const glm::vec3& p, float& d, glm::vec3& n) const {
+    d = glm::dot(p - point, normal);
+    n = normal;
+    return true;
+}
+
+/**
+ * Distance from a point to a sphere of centre c; at the centre the normal is arbitrary (up)
+ */
+static void sphere_distance(const glm::vec3& p, const glm::vec3& c, float radius, float& d, glm::vec3& n) {
+    const glm::vec3 e = p - c;
+    const float len = glm::length(e);
+    n = len > 0.0f ? e / len : glm::vec3(0.0, 0.0, 1.0);
+    d = len - radius;
+}
+
+bool SphereCollider::distance(const glm::vec3& p, float& d, glm::vec3& n) const {
+    sphere_distance(p, center, radius, d, n);
+    return true;
+}
+
+bool CapsuleCollider::distance(const glm::vec3& p, float& d, glm::vec3& n) const {
+    const glm::vec3 ab = b - a;
+    const float len2 = glm::dot(ab, ab);
+    const float t = len2 > 0.0f ? std::clamp(glm::dot(p - a, ab) / len2, 0.0f, 1.0f) : 0.0f;
+    sphere_distance(p, a + ab * t, radius, d, n);
+    return true;
+}
+}
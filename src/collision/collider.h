@@ -0,0 +1,140 @@
+/**
+ * @file
+ * @brief Contains the class Collider and the analytic static colliders (plane, sphere, capsule).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <limits>
+#include <glm.hpp>
+
+namespace cloth{
+/**
+ * @struct Aabb
+ * @brief Axis aligned box, empty when lo > hi
+ */
+struct Aabb
+{
+    glm::vec3 lo {std::numeric_limits<float>::max()};
+    glm::vec3 hi {std::numeric_limits<float>::lowest()};
+
+    static Aabb infinite() {
+        return {glm::vec3(std::numeric_limits<float>::lowest()), glm::vec3(std::numeric_limits<float>::max())};
+    }
+    void expand(const glm::vec3& p) {
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    void expand(const Aabb& b) {
+        lo = glm::min(lo, b.lo);
+        hi = glm::max(hi, b.hi);
+    }
+    bool overlaps(const Aabb& b, float margin) const {
+        return lo.x - margin <= b.hi.x && b.lo.x <= hi.x + margin
+            && lo.y - margin <= b.hi.y && b.lo.y <= hi.y + margin
+            && lo.z - margin <= b.hi.z && b.lo.z <= hi.z + margin;
+    }
+    bool contains(float x, float y, float z, float margin) const {
+        return x >= lo.x - margin && x <= hi.x + margin
+            && y >= lo.y - margin && y <= hi.y + margin
+            && z >= lo.z - margin && z <= hi.z + margin;
+    }
+};
+
+/**
+ * @class Collider
+ * @brief Static obstacle described by its signed distance: negative inside, positive outside.
+ *
+ * A particle at distance d from the surface, closer than the cloth thickness, is in contact; the
+ * contact is an inequality constraint d - thickness >= 0 solved by ColliderContacts.
+ */
+class Collider
+{
+public:
+    /**
+     * Friction coefficients: static (sticking) and dynamic (sliding)
+     */
+    float static_friction = 0.4f;
+    float dynamic_friction = 0.3f;
+    /**
+     * XPBD compliance of the contact, 0 = rigid
+     */
+    float compliance = 0.0f;
+
+    virtual ~Collider() = default;
+
+    /**
+     * Bounds of the solid, particles farther than the contact distance from them are culled
+     */
+    virtual Aabb bounds() const = 0;
+
+    /**
+     * Signed distance of p from the surface and outward unit normal at the closest point
+     * @return false when p is outside the domain of the collider (e.g. outside an SDF grid)
+     */
+    virtual bool distance(const glm::vec3& p, float& d, glm::vec3& normal) const = 0;
+
+    /**
+     * First crossing of the surface by the segment from - to, for colliders thin enough to be
+     * passed through within a substep
+     * @param hit crossing point
+     * @param normal unit normal of the surface on the side of from
+     * @return false when the segment does not cross, or the collider has no continuous test
+     */
+    virtual bool sweep(const glm::vec3& from, const glm::vec3& to, glm::vec3& hit, glm::vec3& normal) const {
+        (void)from; (void)to; (void)hit; (void)normal;
+        return false;
+    }
+};
+
+/**
+ * @class PlaneCollider
+ * @brief Half space below the plane through point with the given normal
+ */
+class PlaneCollider : public Collider
+{
+public:
+    glm::vec3 point;
+    glm::vec3 normal;
+
+    PlaneCollider(const glm::vec3& point, const glm::vec3& normal) : point(point), normal(glm::normalize(normal)) {}
+
+    Aabb bounds() const override { return Aabb::infinite(); }
+    bool distance(const glm::vec3& p, float& d, glm::vec3& n) const override;
+};
+
+/**
+ * @class SphereCollider
+ */
+class SphereCollider : public Collider
+{
+public:
+    glm::vec3 center;
+    float radius;
+
+    SphereCollider(const glm::vec3& center, float radius) : center(center), radius(radius) {}
+
+    Aabb bounds() const override { return {center - radius, center + radius}; }
+    bool distance(const glm::vec3& p, float& d, glm::vec3& n) const override;
+};
+
+/**
+ * @class CapsuleCollider
+ * @brief Points within radius of the segment a - b
+ */
+class CapsuleCollider : public Collider
+{
+public:
+    glm::vec3 a;
+    glm::vec3 b;
+    float radius;
+
+    CapsuleCollider(const glm::vec3& a, const glm::vec3& b, float radius) : a(a), b(b), radius(radius) {}
+
+    Aabb bounds() const override { return {glm::min(a, b) - radius, glm::max(a, b) + radius}; }
+    bool distance(const glm::vec3& p, float& d, glm::vec3& n) const override;
+};
+}
@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @brief Contains the implementation of class ColliderContacts.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include "collision/collider_set.h"
+
+namespace cloth{
+
+static constexpr std::size_t particle_grain = 4096;
+
+void ColliderContacts::broadphase(const ColliderSet& set, const Particles& p, float margin, ThreadPool* pool) {
+    const std::size_t n = p.size();
+    candidates.resize(set.size());
+    const float reach = set.thickness + std::max(margin, 0.0f);
+
+    Aabb cloth_box;
+    for (std::size_t i=0; i<n; ++i)
+        cloth_box.expand(p.position(i));
+
+    for (std::size_t c=0; c<set.size(); ++c) {
+        const Collider& collider = *set.colliders[c];
+        std::vector<std::uint32_t>& out = candidates[c];
+        out.clear();
+        const Aabb box = collider.bounds();
+        if (n == 0 || !box.overlaps(cloth_box, reach))
+            continue;
+        parallel_gather(pool, 0, n, particle_grain, block_candidates, out, [&](std::size_t begin, std::size_t end, std::vector<std::uint32_t>& list) {
+            for (std::size_t i=begin; i<end; ++i) {
+                if (p.w[i] == 0.0f || !box.contains(p.x[i], p.y[i], p.z[i], reach))
+                    continue;
+                float d;
+                glm::vec3 normal;
+                if (collider.distance(p.position(i), d, normal) && d < reach)
+                    list.push_back(static_cast<std::uint32_t>(i));
+            }
+        });
+    }
+}
+
+void ColliderContacts::solve(const ColliderSet& set, Particles& p, float timeStep, ThreadPool* pool) {
+    float* x = p.x.data();
+    float* y = p.y.data();
+    float* z = p.z.data();
+    const float* w = p.w.data();
+    // colliders one after the other, a particle appears at most once per collider
+    for (std::size_t c=0; c<candidates.size() && c<set.size(); ++c) {
+        const Collider& collider = *set.colliders[c];
+        const std::vector<std::uint32_t>& list = candidates[c];
+        const float alpha = collider.compliance / (timeStep * timeStep);
+        parallel_for(pool, 0, list.size(), particle_grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k=begin; k<end; ++k) {
+                const std::uint32_t i = list[k];
+                glm::vec3 pos {x[i], y[i], z[i]};
+                const glm::vec3 prev {p.px[i], p.py[i], p.pz[i]};
+                glm::vec3 hit, n;
+                // continuous test first: a particle that crossed a thin surface goes back to its front side
+                if (w[i] > 0.0f && collider.sweep(prev, pos, hit, n))
+                    pos = hit + n * set.thickness;
+                float d;
+                const float C = collider.distance(pos, d, n) ? d - set.thickness : 0.0f;
+                if (C < 0.0f) {
+                    const float delta_lambda = -C / (w[i] + alpha);
+                    const float depth = w[i] * delta_lambda;
+                    pos += depth * n;
+
+                    // friction on the motion of this substep
+                    const glm::vec3 motion = pos - prev;
+                    const glm::vec3 tangential = motion - glm::dot(motion, n) * n;
+                    const float slide = glm::length(tangential);
+                    if (slide < collider.static_friction * depth)
+                        pos -= tangential;
+                    else if (slide > 0.0f)
+                        pos -= tangential * std::min(collider.dynamic_friction * depth / slide, 1.0f);
+                }
+                x[i] = pos.x;
+                y[i] = pos.y;
+                z[i] = pos.z;
+            }
+        });
+    }
+}
+
+std::size_t ColliderContacts::candidate_count() const {
+    std::size_t count = 0;
+    for (const auto& list : candidates)
+        count += list.size();
+    return count;
+}
+}
@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Contains the class ColliderSet, the static obstacles of a scene, and ColliderContacts,
+ * the contacts of a cloth with them.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "collision/collider.h"
+#include "node/particles.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class ColliderSet
+ * @brief Static colliders shared by every cloth of a scene
+ */
+class ColliderSet
+{
+public:
+    /**
+     * Distance the cloth keeps from every collider surface
+     */
+    float thickness = 0.005f;
+    std::vector<std::unique_ptr<Collider>> colliders;
+
+    template <typename T, typename... Args>
+    T& add(Args&&... args) {
+        colliders.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        return static_cast<T&>(*colliders.back());
+    }
+    std::size_t size() const { return colliders.size(); }
+    bool empty() const { return colliders.empty(); }
+};
+
+/**
+ * @class ColliderContacts
+ * @brief Contacts between the particles of one cloth and a ColliderSet.
+ *
+ * broadphase() runs once per frame: a particle becomes a candidate of a collider when it lies in
+ * the collider bounds and within thickness + margin of its surface, margin being how far the
+ * particle can move in the frame. Every substep solve() then only looks at the candidates, so its
+ * cost follows the particles near an obstacle rather than the size of the cloth.
+ *
+ * A contact is the XPBD inequality constraint C = d - thickness >= 0, d signed distance from the
+ * surface, with the compliance of the collider; it is solved only while violated. Friction then
+ * removes the tangential motion of the substep (relative to the static surface): completely when
+ * it is below static_friction times the normal correction, otherwise by dynamic_friction times it.
+ */
+class ColliderContacts
+{
+public:
+    /**
+     * Candidate particles of every collider, in index order
+     */
+    std::vector<std::vector<std::uint32_t>> candidates;
+
+    void broadphase(const ColliderSet& set, const Particles& p, float margin, ThreadPool* pool);
+    void solve(const ColliderSet& set, Particles& p, float timeStep, ThreadPool* pool);
+
+    std::size_t candidate_count() const;
+
+private:
+    std::vector<std::vector<std::uint32_t>> block_candidates;
+};
+}
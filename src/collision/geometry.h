@@ -0,0 +1,92 @@
+/**
+ * @file
+ * @brief Contains the point / segment / triangle / box primitives used by the colliders.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <glm.hpp>
+
+namespace cloth{
+
+/**
+ * Closest point to p on the triangle a b c (Ericson, Real-Time Collision Detection 5.1.5)
+ */
+inline glm::vec3 closest_on_triangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return a;
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return b;
+    const float vc = d1*d4 - d3*d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return a + ab * (d1 / (d1 - d3));
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return c;
+    const float vb = d5*d2 - d1*d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return a + ac * (d2 / (d2 - d6));
+    const float va = d3*d6 - d5*d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    const float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+ * Crossing of the segment from + t * (to - from), t in [0, 1], with the triangle a b c
+ * (Moller - Trumbore, both faces)
+ * @return false when they do not cross
+ */
+inline bool segment_triangle(const glm::vec3& from, const glm::vec3& to,
+                             const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t) {
+    const glm::vec3 dir = to - from;
+    const glm::vec3 e1 = b - a, e2 = c - a;
+    const glm::vec3 h = glm::cross(dir, e2);
+    const float det = glm::dot(e1, h);
+    if (std::abs(det) < 1.0e-12f)
+        return false;
+    const float inv = 1.0f / det;
+    const glm::vec3 s = from - a;
+    const float u = glm::dot(s, h) * inv;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+    const glm::vec3 q = glm::cross(s, e1);
+    const float v = glm::dot(dir, q) * inv;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+    t = glm::dot(e2, q) * inv;
+    return t >= 0.0f && t <= 1.0f;
+}
+
+/**
+ * Squared distance from p to the box [lo, hi], 0 inside
+ */
+inline float box_distance2(const glm::vec3& p, const glm::vec3& lo, const glm::vec3& hi) {
+    const glm::vec3 d = glm::max(glm::max(lo - p, p - hi), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+/**
+ * Whether the segment from + t * dir, t in [0, 1], meets the box [lo, hi] (slab test)
+ * @param inv_dir 1 / dir per component (infinite for zero components)
+ */
+inline bool segment_box(const glm::vec3& from, const glm::vec3& inv_dir, const glm::vec3& lo, const glm::vec3& hi) {
+    const glm::vec3 t0 = (lo - from) * inv_dir;
+    const glm::vec3 t1 = (hi - from) * inv_dir;
+    const glm::vec3 near = glm::min(t0, t1), far = glm::max(t0, t1);
+    const float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    const float exit = std::min(std::min(far.x, far.y), std::min(far.z, 1.0f));
+    return enter <= exit;
+}
+}
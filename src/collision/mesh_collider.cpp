@@ -0,0 +1,92 @@
+/**
+ * @file
+ * @brief Contains the implementation of class MeshCollider.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "collision/mesh_collider.h"
+#include "collision/geometry.h"
+
+namespace cloth{
+
+MeshCollider::MeshCollider(std::vector<glm::vec3> vertices, std::vector<std::uint32_t> indices)
+    : vertices(std::move(vertices)), indices(std::move(indices)) {
+    bvh.build(this->vertices.data(), this->indices.data(), triangle_count());
+}
+
+void MeshCollider::update(const std::vector<glm::vec3>& moved) {
+    vertices = moved;
+    bvh.refit(vertices.data(), indices.data());
+}
+
+glm::vec3 MeshCollider::face_normal(std::uint32_t t) const {
+    const glm::vec3& a = vertices[indices[3*t]];
+    const glm::vec3& b = vertices[indices[3*t + 1]];
+    const glm::vec3& c = vertices[indices[3*t + 2]];
+    const glm::vec3 n = glm::cross(b - a, c - a);
+    const float len = glm::length(n);
+    return len > 0.0f ? n / len : glm::vec3(0.0, 0.0, 1.0);
+}
+
+bool MeshCollider::distance(const glm::vec3& p, float& d, glm::vec3& n) const {
+    float best2 = std::numeric_limits<float>::max();
+    std::uint32_t best_tri = 0;
+    glm::vec3 best_point {0.0};
+    const auto closest = [&](std::uint32_t t) {
+        const glm::vec3 c = closest_on_triangle(p, vertices[indices[3*t]], vertices[indices[3*t + 1]], vertices[indices[3*t + 2]]);
+        const glm::vec3 e = p - c;
+        const float d2 = glm::dot(e, e);
+        if (d2 < best2) {
+            best2 = d2;
+            best_tri = t;
+            best_point = c;
+        }
+    };
+    // the traversal order is fixed, start it with the radius of a nearby leaf or it enters most of the tree
+    if (const BvhNode* guess = bvh.greedy_leaf(p))
+        for (std::uint32_t k=guess->first(); k<guess->first() + guess->count(); ++k)
+            closest(bvh.order[k]);
+    bvh.traverse([&](const BvhNode& node) { return box_distance2(p, node.lo, node.hi) < best2; }, closest);
+    if (best2 == std::numeric_limits<float>::max())
+        return false;
+    const glm::vec3 face = face_normal(best_tri);
+    const glm::vec3 e = p - best_point;
+    const float len = std::sqrt(best2);
+    const bool inside = glm::dot(e, face) < 0.0f;
+    d = inside ? -len : len;
+    // on an edge or a vertex the direction to the closest point is the true normal, on a face they agree
+    n = len > 1.0e-6f ? (inside ? -e : e) / len : face;
+    return true;
+}
+
+bool MeshCollider::sweep(const glm::vec3& from, const glm::vec3& to, glm::vec3& hit, glm::vec3& n) const {
+    const glm::vec3 dir = to - from;
+    glm::vec3 inv_dir;
+    for (int k=0; k<3; ++k)
+        inv_dir[k] = 1.0f / (std::abs(dir[k]) > 1.0e-20f ? dir[k] : std::copysign(1.0e-20f, dir[k]));
+    float first = 2.0f;
+    std::uint32_t first_tri = 0;
+    bvh.traverse([&](const BvhNode& node) { return segment_box(from, inv_dir, node.lo, node.hi); },
+                 [&](std::uint32_t t) {
+        float s;
+        if (segment_triangle(from, to, vertices[indices[3*t]], vertices[indices[3*t + 1]], vertices[indices[3*t + 2]], s) && s < first) {
+            first = s;
+            first_tri = t;
+        }
+    });
+    if (first > 1.0f)
+        return false;
+    hit = from + dir * first;
+    // normal on the side the particle comes from
+    n = face_normal(first_tri);
+    if (glm::dot(n, dir) > 0.0f)
+        n = -n;
+    return true;
+}
+}
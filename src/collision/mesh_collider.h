@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @brief Contains the class MeshCollider, an obstacle given by a triangle mesh.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+#include "collision/bvh.h"
+#include "collision/collider.h"
+
+namespace cloth{
+/**
+ * @class MeshCollider
+ * @brief Closed triangle mesh (e.g. an avatar) with outward facing triangles (counter clockwise),
+ * accelerated by a Bvh.
+ *
+ * distance() finds the closest triangle; its sign comes from the side of that triangle. sweep()
+ * finds the first triangle crossed by the motion of a particle during a substep, so thin parts
+ * (fingers, a sheet) are not tunnelled through. For an animated obstacle, update() moves the
+ * vertices and refits the tree.
+ */
+class MeshCollider : public Collider
+{
+public:
+    std::vector<glm::vec3> vertices;
+    std::vector<std::uint32_t> indices;
+    Bvh bvh;
+
+    MeshCollider(std::vector<glm::vec3> vertices, std::vector<std::uint32_t> indices);
+
+    /**
+     * New vertex positions, same count and topology as before
+     */
+    void update(const std::vector<glm::vec3>& moved);
+
+    std::size_t triangle_count() const { return indices.size() / 3; }
+
+    Aabb bounds() const override { return bvh.bounds(); }
+    bool distance(const glm::vec3& p, float& d, glm::vec3& n) const override;
+    bool sweep(const glm::vec3& from, const glm::vec3& to, glm::vec3& hit, glm::vec3& n) const override;
+
+private:
+    glm::vec3 face_normal(std::uint32_t t) const;
+};
+}
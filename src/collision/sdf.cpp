@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief Contains the implementation of SdfGrid and SdfCollider.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "collision/sdf.h"
+#include "collision/geometry.h"
+
+namespace cloth{
+
+void SdfGrid::resize(const Aabb& box, float c) {
+    cell = c;
+    origin = box.lo;
+    const glm::vec3 size = box.hi - box.lo;
+    nx = std::max(2, static_cast<int>(std::ceil(size.x / cell)) + 1);
+    ny = std::max(2, static_cast<int>(std::ceil(size.y / cell)) + 1);
+    nz = std::max(2, static_cast<int>(std::ceil(size.z / cell)) + 1);
+    values.assign(static_cast<std::size_t>(nx) * ny * nz, 0.0f);
+}
+
+SdfGrid SdfGrid::from_mesh(const std::vector<glm::vec3>& vertices, const std::vector<unsigned>& indices, float cell, float band) {
+    Aabb box;
+    for (const auto& v : vertices)
+        box.expand(v);
+    box.lo -= glm::vec3(band + cell);
+    box.hi += glm::vec3(band + cell);
+    SdfGrid g;
+    g.resize(box, cell);
+    std::fill(g.values.begin(), g.values.end(), band);
+
+    auto node_range = [&](float lo, float hi, float o, int n, int& first, int& last) {
+        first = std::max(0, static_cast<int>(std::floor((lo - o) / cell)));
+        last = std::min(n - 1, static_cast<int>(std::ceil((hi - o) / cell)));
+    };
+
+    const std::size_t tris = indices.size() / 3;
+    // unsigned distance in a band around every triangle
+    for (std::size_t t=0; t<tris; ++t) {
+        const glm::vec3& a = vertices[indices[3*t]];
+        const glm::vec3& b = vertices[indices[3*t + 1]];
+        const glm::vec3& c = vertices[indices[3*t + 2]];
+        const glm::vec3 lo = glm::min(a, glm::min(b, c)) - band;
+        const glm::vec3 hi = glm::max(a, glm::max(b, c)) + band;
+        int i0, i1, j0, j1, k0, k1;
+        node_range(lo.x, hi.x, g.origin.x, g.nx, i0, i1);
+        node_range(lo.y, hi.y, g.origin.y, g.ny, j0, j1);
+        node_range(lo.z, hi.z, g.origin.z, g.nz, k0, k1);
+        for (int k=k0; k<=k1; ++k)
+            for (int j=j0; j<=j1; ++j)
+                for (int i=i0; i<=i1; ++i) {
+                    const glm::vec3 p = g.node(i, j, k);
+                    float& v = g.values[g.index(i, j, k)];
+                    v = std::min(v, glm::length(p - closest_on_triangle(p, a, b, c)));
+                }
+    }
+
+    // sign: parity of the crossings of a ray along +x through every row of nodes. The rays are
+    // shifted off the node rows by a fraction of a cell so they do not graze edges and vertices.
+    const float sy = 1.0e-3f * cell * 0.7071f;
+    const float sz = 1.0e-3f * cell * 0.5773f;
+    std::vector<std::vector<float>> crossings(static_cast<std::size_t>(g.ny) * g.nz);
+    for (std::size_t t=0; t<tris; ++t) {
+        const glm::vec3& a = vertices[indices[3*t]];
+        const glm::vec3& b = vertices[indices[3*t + 1]];
+        const glm::vec3& c = vertices[indices[3*t + 2]];
+        int j0, j1, k0, k1;
+        node_range(std::min({a.y, b.y, c.y}) - sy, std::max({a.y, b.y, c.y}) - sy, g.origin.y, g.ny, j0, j1);
+        node_range(std::min({a.z, b.z, c.z}) - sz, std::max({a.z, b.z, c.z}) - sz, g.origin.z, g.nz, k0, k1);
+        for (int k=k0; k<=k1; ++k)
+            for (int j=j0; j<=j1; ++j) {
+                const float y = g.origin.y + j * cell + sy;
+                const float z = g.origin.z + k * cell + sz;
+                // barycentric coordinates of (y, z) in the projection of the triangle on yz
+                const float det = (b.y - a.y) * (c.z - a.z) - (c.y - a.y) * (b.z - a.z);
+                if (det == 0.0f)
+                    continue;
+                const float u = ((y - a.y) * (c.z - a.z) - (c.y - a.y) * (z - a.z)) / det;
+                const float v = ((b.y - a.y) * (z - a.z) - (y - a.y) * (b.z - a.z)) / det;
+                if (u < 0.0f || v < 0.0f || u + v > 1.0f)
+                    continue;
+                crossings[static_cast<std::size_t>(k) * g.ny + j].push_back(a.x + u * (b.x - a.x) + v * (c.x - a.x));
+            }
+    }
+    for (int k=0; k<g.nz; ++k)
+        for (int j=0; j<g.ny; ++j) {
+            std::vector<float>& row = crossings[static_cast<std::size_t>(k) * g.ny + j];
+            std::sort(row.begin(), row.end());
+            std::size_t passed = 0;
+            for (int i=0; i<g.nx; ++i) {
+                const float x = g.origin.x + i * cell;
+                while (passed < row.size() && row[passed] < x)
+                    ++passed;
+                if (passed % 2 == 1)
+                    g.values[g.index(i, j, k)] = -g.values[g.index(i, j, k)];
+            }
+        }
+    return g;
+}
+
+bool SdfGrid::sample(const glm::vec3& p, float& d, glm::vec3& gradient) const {
+    const glm::vec3 q = (p - origin) / cell;
+    if (q.x < 0.0f || q.y < 0.0f || q.z < 0.0f || q.x > nx - 1 || q.y > ny - 1 || q.z > nz - 1)
+        return false;
+    const int i = std::min(static_cast<int>(q.x), nx - 2);
+    const int j = std::min(static_cast<int>(q.y), ny - 2);
+    const int k = std::min(static_cast<int>(q.z), nz - 2);
+    const float fx = q.x - i, fy = q.y - j, fz = q.z - k;
+    const std::size_t base = index(i, j, k);
+    const std::size_t sy = nx, sz = static_cast<std::size_t>(nx) * ny;
+    const float v000 = values[base],           v100 = values[base + 1];
+    const float v010 = values[base + sy],      v110 = values[base + sy + 1];
+    const float v001 = values[base + sz],      v101 = values[base + sz + 1];
+    const float v011 = values[base + sy + sz], v111 = values[base + sy + sz + 1];
+
+    const float x00 = v000 + (v100 - v000) * fx, x10 = v010 + (v110 - v010) * fx;
+    const float x01 = v001 + (v101 - v001) * fx, x11 = v011 + (v111 - v011) * fx;
+    const float y0 = x00 + (x10 - x00) * fy, y1 = x01 + (x11 - x01) * fy;
+    d = y0 + (y1 - y0) * fz;
+
+    // derivatives of the trilinear interpolant
+    const float dx0 = (v100 - v000) + ((v110 - v010) - (v100 - v000)) * fy;
+    const float dx1 = (v101 - v001) + ((v111 - v011) - (v101 - v001)) * fy;
+    gradient.x = (dx0 + (dx1 - dx0) * fz) / cell;
+    gradient.y = ((x10 - x00) + ((x11 - x01) - (x10 - x00)) * fz) / cell;
+    gradient.z = (y1 - y0) / cell;
+    return true;
+}
+
+bool SdfCollider::distance(const glm::vec3& p, float& d, glm::vec3& n) const {
+    glm::vec3 g;
+    if (!grid.sample(p, d, g))
+        return false;
+    const float len = glm::length(g);
+    if (len == 0.0f)
+        return false;
+    n = g / len;
+    return true;
+}
+}
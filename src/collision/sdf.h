@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Contains the class SdfGrid, a signed distance field sampled on a voxel grid, and
+ * SdfCollider, the collider it describes.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <glm.hpp>
+#include "collision/collider.h"
+
+namespace cloth{
+/**
+ * @class SdfGrid
+ * @brief Signed distance at the nodes of a regular grid of nx * ny * nz nodes spaced by cell,
+ * starting at origin (x fastest). Between nodes the distance is trilinear, and so is its gradient.
+ */
+class SdfGrid
+{
+public:
+    glm::vec3 origin {0.0};
+    float cell = 1.0f;
+    int nx = 0, ny = 0, nz = 0;
+    std::vector<float> values;
+
+    /**
+     * Signed distance of a closed triangle mesh. Exact within band of the surface, clamped to
+     * +-band farther away; inside/outside comes from the parity of the crossings of a ray along x.
+     * @param vertices mesh vertices
+     * @param indices three vertex indices per triangle
+     * @param cell node spacing
+     * @param band distance computed exactly around the surface, also the padding of the grid
+     */
+    static SdfGrid from_mesh(const std::vector<glm::vec3>& vertices, const std::vector<unsigned>& indices, float cell, float band);
+
+    /**
+     * Grid covering box with f(p) at every node
+     */
+    template <typename F>
+    static SdfGrid from_function(const Aabb& box, float cell, F&& f) {
+        SdfGrid g;
+        g.resize(box, cell);
+        for (int k=0; k<g.nz; ++k)
+            for (int j=0; j<g.ny; ++j)
+                for (int i=0; i<g.nx; ++i)
+                    g.values[g.index(i, j, k)] = f(g.node(i, j, k));
+        return g;
+    }
+
+    std::size_t index(int i, int j, int k) const {
+        return (static_cast<std::size_t>(k) * ny + j) * nx + i;
+    }
+    glm::vec3 node(int i, int j, int k) const {
+        return origin + cell * glm::vec3(i, j, k);
+    }
+    Aabb bounds() const {
+        return {origin, node(nx - 1, ny - 1, nz - 1)};
+    }
+
+    /**
+     * Trilinear distance and gradient at p
+     * @return false when p is outside the grid
+     */
+    bool sample(const glm::vec3& p, float& d, glm::vec3& gradient) const;
+
+private:
+    void resize(const Aabb& box, float cell);
+};
+
+/**
+ * @class SdfCollider
+ * @brief Static obstacle of arbitrary shape, given by a precomputed SdfGrid
+ */
+class SdfCollider : public Collider
+{
+public:
+    SdfGrid grid;
+
+    explicit SdfCollider(SdfGrid grid) : grid(std::move(grid)) {}
+
+    Aabb bounds() const override { return grid.bounds(); }
+    bool distance(const glm::vec3& p, float& d, glm::vec3& n) const override;
+};
+}
@@ -0,0 +1,150 @@
+/**
+ * @file
+ * @brief Contains the implementation of class SelfCollision.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <utility>
+#include "collision/self_collision.h"
+
+namespace cloth{
+
+static constexpr std::size_t particle_grain = 2048;
+
+void SelfCollision::set_links(const DistanceConstraints& stretch, std::size_t particle_count) {
+    origin.clear();
+    link_offsets.assign(particle_count + 1, 0);
+    for (std::size_t c=0; c<stretch.size(); ++c) {
+        ++link_offsets[stretch.first(c) + 1];
+        ++link_offsets[stretch.second(c) + 1];
+    }
+    for (std::size_t i=0; i<particle_count; ++i)
+        link_offsets[i + 1] += link_offsets[i];
+    links.resize(link_offsets.back());
+    std::vector<std::uint32_t> fill(link_offsets.begin(), link_offsets.end() - 1);
+    default_thickness = 0.0f;
+    for (std::size_t c=0; c<stretch.size(); ++c) {
+        const std::uint32_t a = stretch.first(c);
+        const std::uint32_t b = stretch.second(c);
+        links[fill[a]++] = b;
+        links[fill[b]++] = a;
+        const float r = stretch.rest_dist[c];
+        if (r > 0.0f && (default_thickness == 0.0f || r < default_thickness))
+            default_thickness = r;
+    }
+    for (std::size_t i=0; i<particle_count; ++i)
+        std::sort(links.begin() + link_offsets[i], links.begin() + link_offsets[i + 1]);
+}
+
+void SelfCollision::add_split(std::uint32_t original) {
+    if (origin.empty()) {
+        origin.resize(link_offsets.empty() ? 0 : link_offsets.size() - 1);
+        std::iota(origin.begin(), origin.end(), 0u);
+    }
+    const std::uint32_t root = original < origin.size() ? origin[original] : original;
+    origin.push_back(root);
+}
+
+void SelfCollision::restore_links(std::vector<std::uint32_t> offsets, std::vector<std::uint32_t> table, std::vector<std::uint32_t> origins) {
+    link_offsets = std::move(offsets);
+    links = std::move(table);
+    origin = std::move(origins);
+}
+
+bool SelfCollision::linked(std::uint32_t i, std::uint32_t j) const {
+    if (!origin.empty()) {
+        i = origin[i];
+        j = origin[j];
+        if (i == j)
+            return true;
+    }
+    if (i + 1 >= link_offsets.size())
+        return false;
+    return std::binary_search(links.begin() + link_offsets[i], links.begin() + link_offsets[i + 1], j);
+}
+
+void SelfCollision::find_candidates(const Particles& p, float margin, ThreadPool* pool) {
+    const std::size_t n = p.size();
+    const float radius = distance() + std::max(margin, 0.0f);
+    offsets.assign(n + 1, 0);
+    candidates.clear();
+    if (radius <= 0.0f || n == 0)
+        return;
+    grid.build(p.x.data(), p.y.data(), p.z.data(), n, 2.0f * radius, pool);
+
+    const float r2 = radius * radius;
+    const float* gx = grid.ex.data();
+    const float* gy = grid.ey.data();
+    const float* gz = grid.ez.data();
+    const std::uint32_t* entries = grid.entries.data();
+    parallel_gather(pool, 0, n, particle_grain, block_candidates, candidates, [&](std::size_t begin, std::size_t end, std::vector<std::uint32_t>& out) {
+        for (std::size_t i=begin; i<end; ++i) {
+            const std::size_t before = out.size();
+            const float xi = p.x[i], yi = p.y[i], zi = p.z[i];
+            grid.for_each_near(xi, yi, zi, radius, [&](std::uint32_t e) {
+                const float dx = gx[e] - xi, dy = gy[e] - yi, dz = gz[e] - zi;
+                if (dx*dx + dy*dy + dz*dz >= r2)
+                    return;
+                const std::uint32_t j = entries[e];
+                if (j != i && !linked(static_cast<std::uint32_t>(i), j))
+                    out.push_back(j);
+            });
+            offsets[i + 1] = static_cast<std::uint32_t>(out.size() - before);
+        }
+    });
+    // the candidates of particle i follow those of i - 1
+    for (std::size_t i=0; i<n; ++i)
+        offsets[i + 1] += offsets[i];
+}
+
+void SelfCollision::solve(Particles& p, ThreadPool* pool) {
+    const std::size_t n = p.size();
+    if (candidates.empty() || offsets.size() != n + 1)
+        return;
+    dx.resize(n);
+    dy.resize(n);
+    dz.resize(n);
+    const float h = distance();
+    const float h2 = h * h;
+    float* x = p.x.data();
+    float* y = p.y.data();
+    float* z = p.z.data();
+    const float* w = p.w.data();
+    parallel_for(pool, 0, n, particle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i=begin; i<end; ++i) {
+            float cx = 0.0f, cy = 0.0f, cz = 0.0f;
+            if (w[i] != 0.0f) {
+                for (std::uint32_t k=offsets[i]; k<offsets[i + 1]; ++k) {
+                    const std::uint32_t j = candidates[k];
+                    const float ex = x[i] - x[j], ey = y[i] - y[j], ez = z[i] - z[j];
+                    const float d2 = ex*ex + ey*ey + ez*ez;
+                    if (d2 >= h2 || d2 == 0.0f)
+                        continue;
+                    const float d = std::sqrt(d2);
+                    // i takes its share w_i / (w_i + w_j) of the penetration, j does the same from its side
+                    const float s = (h - d) / d * w[i] / (w[i] + w[j]);
+                    cx += ex * s;
+                    cy += ey * s;
+                    cz += ez * s;
+                }
+            }
+            dx[i] = cx;
+            dy[i] = cy;
+            dz[i] = cz;
+        }
+    });
+    parallel_for(pool, 0, n, particle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i=begin; i<end; ++i) {
+            x[i] += dx[i];
+            y[i] += dy[i];
+            z[i] += dz[i];
+        }
+    });
+}
+}
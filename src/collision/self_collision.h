@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @brief Contains the class SelfCollision, particle-particle contacts inside a cloth.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "collision/spatial_hash.h"
+#include "constraints/d_constr.h"
+#include "node/particles.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class SelfCollision
+ * @brief Keeps the particles of a cloth at least thickness apart, except pairs joined by a
+ * stretch constraint, which are held at their rest distance already.
+ *
+ * Once per frame find_candidates() hashes the particles and stores, for every particle, the
+ * particles within thickness + margin, where margin covers how far particles can move in the
+ * frame. Every substep solve() then only tests those pairs. The solve is Jacobi style: each
+ * particle sums the corrections of its own pairs, so threads never write to the same particle
+ * and the result does not depend on the number of threads.
+ */
+class SelfCollision
+{
+public:
+    /**
+     * Minimum distance between two particles, 0 = shortest stretch rest length
+     */
+    float thickness = 0.0f;
+
+    SpatialHash grid;
+    /**
+     * Candidate pairs of the current frame, candidates[offsets[i] .. offsets[i+1]) for particle i
+     */
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> candidates;
+
+    /**
+     * Record the pairs of stretch that never collide
+     */
+    void set_links(const DistanceConstraints& stretch, std::size_t particle_count);
+    /**
+     * Register the particle just appended as split from particle original: it never collides with
+     * the original nor with the particles linked to it, and neither do the particles split from those
+     */
+    void add_split(std::uint32_t original);
+    /**
+     * The links of set_links and the origins of add_split, as saved in a checkpoint
+     */
+    const std::vector<std::uint32_t>& link_table_offsets() const { return link_offsets; }
+    const std::vector<std::uint32_t>& link_table() const { return links; }
+    const std::vector<std::uint32_t>& split_origins() const { return origin; }
+    /**
+     * Replace the links and the origins with saved ones, after set_links
+     */
+    void restore_links(std::vector<std::uint32_t> offsets, std::vector<std::uint32_t> table, std::vector<std::uint32_t> origins);
+
+    /**
+     * Distance actually enforced (thickness, or the default from the links)
+     */
+    float distance() const { return thickness > 0.0f ? thickness : default_thickness; }
+
+    /**
+     * Rebuild the grid and the candidate pairs from the current positions
+     * @param margin extra search distance, at least the largest relative motion of two particles
+     * in the coming frame
+     */
+    void find_candidates(const Particles& p, float margin, ThreadPool* pool);
+
+    /**
+     * Push apart the candidate pairs closer than distance(), in proportion to their inverse masses
+     */
+    void solve(Particles& p, ThreadPool* pool);
+
+    std::size_t pair_count() const { return candidates.size() / 2; }
+
+private:
+    bool linked(std::uint32_t i, std::uint32_t j) const;
+
+    std::vector<std::uint32_t> link_offsets;
+    std::vector<std::uint32_t> links;
+    /**
+     * Particle of set_links every particle comes from, empty until a particle is split
+     */
+    std::vector<std::uint32_t> origin;
+    float default_thickness = 0.0f;
+    std::vector<std::vector<std::uint32_t>> block_candidates;
+    aligned_vector<float> dx, dy, dz;
+};
+}
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Contains the implementation of class SpatialHash.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "collision/spatial_hash.h"
+
+namespace cloth{
+
+static constexpr std::size_t point_grain = 4096;
+static constexpr std::size_t bucket_grain = 16384;
+
+void SpatialHash::build(const float* x, const float* y, const float* z, std::size_t n, float cell, ThreadPool* pool) {
+    cell_size = cell;
+    std::size_t table = 1024;
+    while (table < 2 * n)
+        table *= 2;
+    mask = static_cast<std::uint32_t>(table - 1);
+
+    if (counters_size != table) {
+        counters.reset(new std::atomic<std::uint32_t>[table]);
+        counters_size = table;
+    }
+    start.resize(table + 1);
+    entries.resize(n);
+    ex.resize(n);
+    ey.resize(n);
+    ez.resize(n);
+    bucket_of.resize(n);
+
+    // histogram
+    parallel_for(pool, 0, table, bucket_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b=begin; b<end; ++b)
+            counters[b].store(0, std::memory_order_relaxed);
+    });
+    parallel_for(pool, 0, n, point_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i=begin; i<end; ++i) {
+            const std::uint32_t b = bucket(coord(x[i]), coord(y[i]), coord(z[i]));
+            bucket_of[i] = b;
+            counters[b].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // exclusive prefix sum: per block totals, scan of the totals, then each block scans itself
+    const std::size_t blocks = (table + bucket_grain - 1) / bucket_grain;
+    std::vector<std::uint32_t> block_base(blocks + 1, 0);
+    parallel_for(pool, 0, blocks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k=begin; k<end; ++k) {
+            std::uint32_t sum = 0;
+            for (std::size_t b=k*bucket_grain; b<std::min(table, (k + 1)*bucket_grain); ++b)
+                sum += counters[b].load(std::memory_order_relaxed);
+            block_base[k + 1] = sum;
+        }
+    });
+    for (std::size_t k=0; k<blocks; ++k)
+        block_base[k + 1] += block_base[k];
+    parallel_for(pool, 0, blocks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k=begin; k<end; ++k) {
+            std::uint32_t sum = block_base[k];
+            for (std::size_t b=k*bucket_grain; b<std::min(table, (k + 1)*bucket_grain); ++b) {
+                const std::uint32_t c = counters[b].load(std::memory_order_relaxed);
+                start[b] = sum;
+                counters[b].store(sum, std::memory_order_relaxed);
+                sum += c;
+            }
+        }
+    });
+    start[table] = static_cast<std::uint32_t>(n);
+
+    // scatter, then restore index order inside every bucket
+    parallel_for(pool, 0, n, point_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i=begin; i<end; ++i)
+            entries[counters[bucket_of[i]].fetch_add(1, std::memory_order_relaxed)] = static_cast<std::uint32_t>(i);
+    });
+    parallel_for(pool, 0, table, bucket_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b=begin; b<end; ++b) {
+            if (start[b + 1] - start[b] > 1)
+                std::sort(entries.begin() + start[b], entries.begin() + start[b + 1]);
+            for (std::uint32_t e=start[b]; e<start[b + 1]; ++e) {
+                ex[e] = x[entries[e]];
+                ey[e] = y[entries[e]];
+                ez[e] = z[entries[e]];
+            }
+        }
+    });
+}
+}
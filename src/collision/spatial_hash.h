@@ -0,0 +1,92 @@
+/**
+ * @file
+ * @brief Contains the class SpatialHash, a uniform grid over the particles stored in a hash table.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class SpatialHash
+ * @brief Unbounded uniform grid of cubic cells of side cell_size, hashed into a table of about
+ * twice as many buckets as points. Points are sorted by bucket with a counting sort, so a bucket
+ * is a contiguous range of entries and the structure is two flat arrays.
+ *
+ * build() runs in parallel: bucket histogram with atomic counters, blocked prefix sum, scatter
+ * with atomic cursors, then every bucket is sorted by point index so the layout does not depend
+ * on the scheduling of the threads. Positions are copied in entry order as well, so a query
+ * reads every bucket from contiguous memory.
+ */
+class SpatialHash
+{
+public:
+    float cell_size = 1.0f;
+    /**
+     * Entries of bucket b are entries[start[b] .. start[b+1])
+     */
+    std::vector<std::uint32_t> start;
+    std::vector<std::uint32_t> entries;
+    /**
+     * Position of entries[e] at build time
+     */
+    std::vector<float> ex, ey, ez;
+
+    /**
+     * Hash the n points (x, y, z) into cells of side cell_size
+     */
+    void build(const float* x, const float* y, const float* z, std::size_t n, float cell_size, ThreadPool* pool);
+
+    std::size_t buckets() const { return start.empty() ? 0 : start.size() - 1; }
+
+    /**
+     * Call f(e) once for every entry e (point entries[e], at ex[e], ey[e], ez[e]) hashed in the
+     * cells overlapped by the box of half side radius around (px, py, pz). With radius up to
+     * cell_size / 2 that box spans at most 2 cells per axis, so 8 buckets are read. Farther
+     * points (same cells, hash collisions) are reported too, the caller filters by distance.
+     */
+    template <typename F>
+    void for_each_near(float px, float py, float pz, float radius, F&& f) const {
+        if (entries.empty())
+            return;
+        const int cx = coord(px - radius), cy = coord(py - radius), cz = coord(pz - radius);
+        std::uint32_t visited[8];
+        int count = 0;
+        for (int dz=0; dz<=1; ++dz)
+            for (int dy=0; dy<=1; ++dy)
+                for (int dx=0; dx<=1; ++dx)
+                    visited[count++] = bucket(cx + dx, cy + dy, cz + dz);
+        // distinct cells may share a bucket, visit each bucket once
+        std::sort(visited, visited + count);
+        count = static_cast<int>(std::unique(visited, visited + count) - visited);
+        for (int k=0; k<count; ++k)
+            for (std::uint32_t e=start[visited[k]]; e<start[visited[k] + 1]; ++e)
+                f(e);
+    }
+
+private:
+    int coord(float v) const { return static_cast<int>(std::floor(v / cell_size)); }
+    std::uint32_t bucket(int ix, int iy, int iz) const {
+        const std::uint32_t h = (static_cast<std::uint32_t>(ix) * 92837111u)
+                              ^ (static_cast<std::uint32_t>(iy) * 689287499u)
+                              ^ (static_cast<std::uint32_t>(iz) * 283923481u);
+        return h & mask;
+    }
+
+    std::uint32_t mask = 0;
+    std::vector<std::uint32_t> bucket_of;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> counters;
+    std::size_t counters_size = 0;
+};
+}
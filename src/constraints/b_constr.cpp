@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief Contains the implementation of class BendConstraint.
+ * @brief Contains the implementation of class BendConstraints.
  * @author Davide Furlani
  * @version 0.1
  * @date January, 2023
@@ -10,23 +10,9 @@
 #include "constraints/b_constr.h"
 
 namespace cloth{
-
-BendConstraint::BendConstraint(Node& node1, Node& node2) : nodes(node1,node2){
-    rest_dist = node1.distance(node2);
-}
-
-BendConstraint::BendConstraint(Node& node1, Node& node2, float compliance) : nodes(node1,node2){
-    rest_dist = node1.distance(node2);
-    BendConstraint::compliance = compliance;
-}
-
-BendConstraint::BendConstraint(Node& node1, Node& node2, float compliance, float rest_distance) : nodes(node1,node2) {
-    BendConstraint::rest_dist = rest_distance;
-    BendConstraint::compliance = compliance;
-}
-std::ostream& operator<<(std::ostream& os, const BendConstraint& b) {
-        os << "Bend:     node <- " << b.rest_dist << " -> node";
+std::ostream& operator<<(std::ostream& os, const BendConstraints& b) {
+        os << "Bend:     " << static_cast<const DistanceConstraints&>(b);
         
         return os;
 }
-}
\ No newline at end of file
+}
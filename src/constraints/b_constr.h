@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief Contains the struct BendConstraint.
+ * @brief Contains the struct BendConstraints.
  * @author Davide Furlani
  * @version 0.1
  * @date January, 2023
@@ -8,26 +8,19 @@
  */
 
 #pragma once
-#include <utility>
-#include "node/node.h"
+#include <ostream>
+#include "constraints/d_constr.h"
 
 namespace cloth{
-struct BendConstraint
+/**
+ * @struct BendConstraints
+ * @brief Bending constraints of a cloth, distance constraints between the two vertices opposite each
+ * shared edge, one per hinge of the mesh topology.
+ */
+struct BendConstraints : public DistanceConstraints
 {   
-    /**
-     * Node pair on which a bending constraint is set
-    */
-    std::pair<Node&, Node&> nodes;
-    /**
-     * Distance between nodes at rest
-    */
-    float rest_dist;
-    float compliance = 0.03;
-
-    BendConstraint(Node& node1, Node& node2);
-    BendConstraint(Node& node1, Node& node2, float compliance);
-    BendConstraint(Node& node1, Node& node2, float compliance, float rest_distance);
+    static constexpr float default_compliance = 0.03;
 
-    friend std::ostream& operator<<(std::ostream& os, const BendConstraint& b);
+    friend std::ostream& operator<<(std::ostream& os, const BendConstraints& b);
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @brief Contains the scalar hinge kernels and the runtime dispatch of the vector ones.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/bending_kernel.h"
+#include "constraints/bending_kernel_impl.h"
+
+namespace cloth{
+namespace kernel{
+
+void solve_dihedral_scalar(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    for (std::size_t c=begin; c<end; ++c)
+        dihedral_batch<ScalarLane>(d, c);
+}
+
+void solve_isometric_scalar(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    for (std::size_t c=begin; c<end; ++c)
+        isometric_batch<ScalarLane>(d, c);
+}
+}
+
+float hinge_atan2(float y, float x) {
+    return kernel::atan2_poly<kernel::ScalarLane>(y, x);
+}
+
+void solve_dihedral_range(SimdLevel level, const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    switch (level) {
+#ifdef XPBD_X86_KERNELS
+        case SimdLevel::AVX512:
+            kernel::solve_dihedral_avx512(d, begin, end);
+            return;
+        case SimdLevel::AVX2:
+            kernel::solve_dihedral_avx2(d, begin, end);
+            return;
+        case SimdLevel::SSE41:
+            kernel::solve_dihedral_sse41(d, begin, end);
+            return;
+#endif
+        default:
+            kernel::solve_dihedral_scalar(d, begin, end);
+    }
+}
+
+void solve_isometric_range(SimdLevel level, const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    switch (level) {
+#ifdef XPBD_X86_KERNELS
+        case SimdLevel::AVX512:
+            kernel::solve_isometric_avx512(d, begin, end);
+            return;
+        case SimdLevel::AVX2:
+            kernel::solve_isometric_avx2(d, begin, end);
+            return;
+        case SimdLevel::SSE41:
+            kernel::solve_isometric_sse41(d, begin, end);
+            return;
+#endif
+        default:
+            kernel::solve_isometric_scalar(d, begin, end);
+    }
+}
+}
@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @brief Contains the batched hinge bending kernels (dihedral and isometric) and their dispatch.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "constraints/distance_kernel.h"
+
+namespace cloth{
+/**
+ * Arrays read and written by the hinge kernels. rest is used by the dihedral kernel, k and scale
+ * by the isometric one.
+ */
+struct HingeKernelData {
+    float* x;
+    float* y;
+    float* z;
+    const float* w;
+    const std::uint32_t* p0;
+    const std::uint32_t* p1;
+    const std::uint32_t* p2;
+    const std::uint32_t* p3;
+    const float* compliance;
+    const float* rest;
+    const float* k0;
+    const float* k1;
+    const float* k2;
+    const float* k3;
+    const float* scale;
+    float timeStep;
+};
+
+/**
+ * Project dihedral constraints [begin, end) in order. As for solve_distance_range, no two
+ * constraints of the range may share a particle and every level gives bitwise the same result.
+ */
+void solve_dihedral_range(SimdLevel level, const HingeKernelData& d, std::size_t begin, std::size_t end);
+/**
+ * Project isometric bending constraints [begin, end) in order, same rules as solve_dihedral_range
+ */
+void solve_isometric_range(SimdLevel level, const HingeKernelData& d, std::size_t begin, std::size_t end);
+
+/**
+ * atan2 by a degree 11 odd polynomial (error below 2e-6 rad) made only of operations the vector
+ * kernels have, so every level computes the same angle
+ */
+float hinge_atan2(float y, float x);
+}
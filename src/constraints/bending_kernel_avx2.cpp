@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Contains the AVX2 hinge bending kernels (8 hinges per instruction).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/bending_kernel_impl.h"
+#include <immintrin.h>
+
+namespace cloth{
+namespace kernel{
+namespace {
+
+struct Avx2Lane
+{
+    struct F
+    {
+        __m256 v;
+        friend F operator+(F a, F b) { return {_mm256_add_ps(a.v, b.v)}; }
+        friend F operator-(F a, F b) { return {_mm256_sub_ps(a.v, b.v)}; }
+        friend F operator*(F a, F b) { return {_mm256_mul_ps(a.v, b.v)}; }
+        friend F operator/(F a, F b) { return {_mm256_div_ps(a.v, b.v)}; }
+    };
+    using M = __m256;
+    static constexpr std::size_t width = 8;
+
+    static F set(float v) { return {_mm256_set1_ps(v)}; }
+    static F load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static F gather(const float* base, const std::uint32_t* index) {
+        return {_mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index)), 4)};
+    }
+    static void scatter(float* base, const std::uint32_t* index, F v, M active) {
+        alignas(32) float out[width];
+        _mm256_store_ps(out, v.v);
+        const int mask = _mm256_movemask_ps(active);
+        for (std::size_t l=0; l<width; ++l)
+            if (mask & (1 << l))
+                base[index[l]] = out[l];
+    }
+    static F select(M m, F a, F b) { return {_mm256_blendv_ps(b.v, a.v, m)}; }
+    static F sqrt(F v) { return {_mm256_sqrt_ps(v.v)}; }
+    static F abs(F v) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), v.v)}; }
+    static F min(F a, F b) { return {_mm256_min_ps(b.v, a.v)}; }
+    static F max(F a, F b) { return {_mm256_max_ps(b.v, a.v)}; }
+    static M lt(F a, F b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    static M gt(F a, F b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+    static M both(M a, M b) { return _mm256_and_ps(a, b); }
+    static bool any(M m) { return _mm256_movemask_ps(m) != 0; }
+};
+}
+
+void solve_dihedral_avx2(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    solve_dihedral_vector<Avx2Lane>(d, begin, end);
+}
+
+void solve_isometric_avx2(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    solve_isometric_vector<Avx2Lane>(d, begin, end);
+}
+}
+}
@@ -0,0 +1,61 @@
+/**
+ * @file
+ * @brief Contains the AVX-512 hinge bending kernels (16 hinges per instruction).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/bending_kernel_impl.h"
+#include <immintrin.h>
+
+namespace cloth{
+namespace kernel{
+namespace {
+
+struct Avx512Lane
+{
+    struct F
+    {
+        __m512 v;
+        friend F operator+(F a, F b) { return {_mm512_add_ps(a.v, b.v)}; }
+        friend F operator-(F a, F b) { return {_mm512_sub_ps(a.v, b.v)}; }
+        friend F operator*(F a, F b) { return {_mm512_mul_ps(a.v, b.v)}; }
+        friend F operator/(F a, F b) { return {_mm512_div_ps(a.v, b.v)}; }
+    };
+    using M = __mmask16;
+    static constexpr std::size_t width = 16;
+
+    static F set(float v) { return {_mm512_set1_ps(v)}; }
+    static F load(const float* p) { return {_mm512_loadu_ps(p)}; }
+    static F gather(const float* base, const std::uint32_t* index) {
+        return {_mm512_i32gather_ps(_mm512_loadu_si512(index), base, 4)};
+    }
+    static void scatter(float* base, const std::uint32_t* index, F v, M active) {
+        _mm512_mask_i32scatter_ps(base, active, _mm512_loadu_si512(index), v.v, 4);
+    }
+    static F select(M m, F a, F b) { return {_mm512_mask_blend_ps(m, b.v, a.v)}; }
+    static F sqrt(F v) { return {_mm512_sqrt_ps(v.v)}; }
+    // through the integer unit, _mm512_andnot_ps needs AVX512DQ
+    static F abs(F v) {
+        return {_mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v.v), _mm512_set1_epi32(0x7FFFFFFF)))};
+    }
+    static F min(F a, F b) { return {_mm512_min_ps(b.v, a.v)}; }
+    static F max(F a, F b) { return {_mm512_max_ps(b.v, a.v)}; }
+    static M lt(F a, F b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+    static M gt(F a, F b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ); }
+    static M both(M a, M b) { return a & b; }
+    static bool any(M m) { return m != 0; }
+};
+}
+
+void solve_dihedral_avx512(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    solve_dihedral_vector<Avx512Lane>(d, begin, end);
+}
+
+void solve_isometric_avx512(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    solve_isometric_vector<Avx512Lane>(d, begin, end);
+}
+}
+}
@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Contains the hinge bending kernels written once for any vector width (private to the
+ * constr library).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ *
+ * A lane type V provides the float vector F, the mask M, width, and load / gather / scatter /
+ * select / sqrt / abs / min / max / comparisons; F has the four arithmetic operators. The scalar
+ * lane and the vector lanes run this same sequence of IEEE operations (no contraction, no
+ * approximate reciprocal), which is what makes every level bitwise identical.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "constraints/bending_kernel.h"
+
+namespace cloth{
+namespace kernel{
+
+/**
+ * One constraint at a time
+ */
+struct ScalarLane
+{
+    using F = float;
+    using M = bool;
+    static constexpr std::size_t width = 1;
+
+    static F set(float v) { return v; }
+    static F load(const float* p) { return *p; }
+    static F gather(const float* base, const std::uint32_t* index) { return base[*index]; }
+    static void scatter(float* base, const std::uint32_t* index, F v, M active) {
+        if (active)
+            base[*index] = v;
+    }
+    static F select(M m, F a, F b) { return m ? a : b; }
+    static F sqrt(F v) { return std::sqrt(v); }
+    static F abs(F v) { return std::fabs(v); }
+    static F min(F a, F b) { return b < a ? b : a; }
+    static F max(F a, F b) { return a < b ? b : a; }
+    static M lt(F a, F b) { return a < b; }
+    static M gt(F a, F b) { return a > b; }
+    static M both(M a, M b) { return a && b; }
+    static bool any(M m) { return m; }
+};
+
+template <typename V>
+inline typename V::F atan2_poly(typename V::F y, typename V::F x) {
+    using F = typename V::F;
+    const F zero = V::set(0.0f);
+    const F one = V::set(1.0f);
+    const F ax = V::abs(x), ay = V::abs(y);
+    const F big = V::max(ax, ay);
+    const F a = V::min(ax, ay) / V::select(V::gt(big, zero), big, one);
+    const F s = a * a;
+    F r = V::set(-0.01172120f);
+    r = r * s + V::set(0.05265332f);
+    r = r * s + V::set(-0.11643287f);
+    r = r * s + V::set(0.19354346f);
+    r = r * s + V::set(-0.33262347f);
+    r = r * s + V::set(0.99997726f);
+    r = r * a;
+    r = V::select(V::gt(ay, ax), V::set(1.57079637f) - r, r);
+    r = V::select(V::lt(x, zero), V::set(3.14159274f) - r, r);
+    return V::select(V::lt(y, zero), zero - r, r);
+}
+
+/**
+ * Dihedral constraints [c, c + V::width). With e = x1 - x0, N1 = (x2 - x0) x (x2 - x1) and
+ * N2 = (x3 - x1) x (x3 - x0), theta = atan2((N1 x N2) . e / |e|, N1 . N2); u0 .. u3 are the
+ * gradient vectors of Bridson et al. 2003.
+ */
+template <typename V>
+inline void dihedral_batch(const HingeKernelData& d, std::size_t c) {
+    using F = typename V::F;
+    const F zero = V::set(0.0f);
+    const F one = V::set(1.0f);
+    const std::uint32_t* i0 = d.p0 + c;
+    const std::uint32_t* i1 = d.p1 + c;
+    const std::uint32_t* i2 = d.p2 + c;
+    const std::uint32_t* i3 = d.p3 + c;
+    const F w0 = V::gather(d.w, i0), w1 = V::gather(d.w, i1), w2 = V::gather(d.w, i2), w3 = V::gather(d.w, i3);
+    const F x0 = V::gather(d.x, i0), y0 = V::gather(d.y, i0), z0 = V::gather(d.z, i0);
+    const F x1 = V::gather(d.x, i1), y1 = V::gather(d.y, i1), z1 = V::gather(d.z, i1);
+    const F x2 = V::gather(d.x, i2), y2 = V::gather(d.y, i2), z2 = V::gather(d.z, i2);
+    const F x3 = V::gather(d.x, i3), y3 = V::gather(d.y, i3), z3 = V::gather(d.z, i3);
+
+    const F ex = x1 - x0, ey = y1 - y0, ez = z1 - z0;
+    const F ax = x2 - x0, ay = y2 - y0, az = z2 - z0;
+    const F bx = x2 - x1, by = y2 - y1, bz = z2 - z1;
+    const F cx = x3 - x1, cy = y3 - y1, cz = z3 - z1;
+    const F gx = x3 - x0, gy = y3 - y0, gz = z3 - z0;
+    const F n1x = ay * bz - az * by, n1y = az * bx - ax * bz, n1z = ax * by - ay * bx;
+    const F n2x = cy * gz - cz * gy, n2y = cz * gx - cx * gz, n2z = cx * gy - cy * gx;
+    const F n1sq = n1x * n1x + n1y * n1y + n1z * n1z;
+    const F n2sq = n2x * n2x + n2y * n2y + n2z * n2z;
+    const F esq = ex * ex + ey * ey + ez * ez;
+    const typename V::M valid = V::both(V::both(V::gt(n1sq, zero), V::gt(n2sq, zero)),
+                                        V::both(V::gt(esq, zero), V::gt(w0 + w1 + w2 + w3, zero)));
+    if (!V::any(valid))
+        return;
+
+    const F elen = V::sqrt(V::select(valid, esq, one));
+    const F inv_e = one / elen;
+    const F inv1 = one / V::select(valid, n1sq, one);
+    const F inv2 = one / V::select(valid, n2sq, one);
+
+    // signed angle, both arguments scaled by |N1| |N2| |e|
+    const F crx = n1y * n2z - n1z * n2y, cry = n1z * n2x - n1x * n2z, crz = n1x * n2y - n1y * n2x;
+    const F sin_t = crx * ex + cry * ey + crz * ez;
+    const F cos_t = (n1x * n2x + n1y * n2y + n1z * n2z) * elen;
+    const F pi = V::set(3.14159274f), two_pi = V::set(6.28318548f);
+    F C = atan2_poly<V>(sin_t, cos_t) - V::load(d.rest + c);
+    C = V::select(V::gt(C, pi), C - two_pi, C);
+    C = V::select(V::lt(C, zero - pi), C + two_pi, C);
+
+    // opposite vertices move along their normal, the edge vertices by their lever on the edge
+    const F f2 = elen * inv1, f3 = elen * inv2;
+    const F u2x = n1x * f2, u2y = n1y * f2, u2z = n1z * f2;
+    const F u3x = n2x * f3, u3y = n2y * f3, u3z = n2z * f3;
+    const F h0a = (bx * ex + by * ey + bz * ez) * inv_e * inv1;
+    const F h0b = (cx * ex + cy * ey + cz * ez) * inv_e * inv2;
+    const F h1a = (ax * ex + ay * ey + az * ez) * inv_e * inv1;
+    const F h1b = (gx * ex + gy * ey + gz * ez) * inv_e * inv2;
+    const F u0x = n1x * h0a + n2x * h0b, u0y = n1y * h0a + n2y * h0b, u0z = n1z * h0a + n2z * h0b;
+    const F u1x = zero - (n1x * h1a + n2x * h1b), u1y = zero - (n1y * h1a + n2y * h1b), u1z = zero - (n1z * h1a + n2z * h1b);
+
+    const F wsum = w0 * (u0x * u0x + u0y * u0y + u0z * u0z) + w1 * (u1x * u1x + u1y * u1y + u1z * u1z)
+                 + w2 * (u2x * u2x + u2y * u2y + u2z * u2z) + w3 * (u3x * u3x + u3y * u3y + u3z * u3z);
+    const F dt = V::set(d.timeStep);
+    const F alpha = V::load(d.compliance + c) / dt / dt;
+    const F den = wsum + alpha;
+    const typename V::M active = V::both(valid, V::gt(den, zero));
+    // the u are the gradients of -theta, hence +C
+    const F s = C / V::select(active, den, one);
+
+    V::scatter(d.x, i0, x0 + u0x * s * w0, active);
+    V::scatter(d.y, i0, y0 + u0y * s * w0, active);
+    V::scatter(d.z, i0, z0 + u0z * s * w0, active);
+    V::scatter(d.x, i1, x1 + u1x * s * w1, active);
+    V::scatter(d.y, i1, y1 + u1y * s * w1, active);
+    V::scatter(d.z, i1, z1 + u1z * s * w1, active);
+    V::scatter(d.x, i2, x2 + u2x * s * w2, active);
+    V::scatter(d.y, i2, y2 + u2y * s * w2, active);
+    V::scatter(d.z, i2, z2 + u2z * s * w2, active);
+    V::scatter(d.x, i3, x3 + u3x * s * w3, active);
+    V::scatter(d.y, i3, y3 + u3y * s * w3, active);
+    V::scatter(d.z, i3, z3 + u3z * s * w3, active);
+}
+
+/**
+ * Isometric constraints [c, c + V::width): v = sum K_i x_i, every vertex moves by
+ * -w_i K_i v scale / (scale sum w_j K_j^2 + alpha)
+ */
+template <typename V>
+inline void isometric_batch(const HingeKernelData& d, std::size_t c) {
+    using F = typename V::F;
+    const F zero = V::set(0.0f);
+    const F one = V::set(1.0f);
+    const std::uint32_t* i0 = d.p0 + c;
+    const std::uint32_t* i1 = d.p1 + c;
+    const std::uint32_t* i2 = d.p2 + c;
+    const std::uint32_t* i3 = d.p3 + c;
+    const F w0 = V::gather(d.w, i0), w1 = V::gather(d.w, i1), w2 = V::gather(d.w, i2), w3 = V::gather(d.w, i3);
+    const F k0 = V::load(d.k0 + c), k1 = V::load(d.k1 + c), k2 = V::load(d.k2 + c), k3 = V::load(d.k3 + c);
+    const F scale = V::load(d.scale + c);
+    const F dt = V::set(d.timeStep);
+    const F alpha = V::load(d.compliance + c) / dt / dt;
+    const F den = scale * (w0 * (k0 * k0) + w1 * (k1 * k1) + w2 * (k2 * k2) + w3 * (k3 * k3)) + alpha;
+    const typename V::M active = V::gt(den, zero);
+    if (!V::any(active))
+        return;
+
+    const F x0 = V::gather(d.x, i0), y0 = V::gather(d.y, i0), z0 = V::gather(d.z, i0);
+    const F x1 = V::gather(d.x, i1), y1 = V::gather(d.y, i1), z1 = V::gather(d.z, i1);
+    const F x2 = V::gather(d.x, i2), y2 = V::gather(d.y, i2), z2 = V::gather(d.z, i2);
+    const F x3 = V::gather(d.x, i3), y3 = V::gather(d.y, i3), z3 = V::gather(d.z, i3);
+    const F f = (zero - scale) / V::select(active, den, one);
+    const F vx = (k0 * x0 + k1 * x1 + k2 * x2 + k3 * x3) * f;
+    const F vy = (k0 * y0 + k1 * y1 + k2 * y2 + k3 * y3) * f;
+    const F vz = (k0 * z0 + k1 * z1 + k2 * z2 + k3 * z3) * f;
+    const F c0 = w0 * k0, c1 = w1 * k1, c2 = w2 * k2, c3 = w3 * k3;
+
+    V::scatter(d.x, i0, x0 + vx * c0, active);
+    V::scatter(d.y, i0, y0 + vy * c0, active);
+    V::scatter(d.z, i0, z0 + vz * c0, active);
+    V::scatter(d.x, i1, x1 + vx * c1, active);
+    V::scatter(d.y, i1, y1 + vy * c1, active);
+    V::scatter(d.z, i1, z1 + vz * c1, active);
+    V::scatter(d.x, i2, x2 + vx * c2, active);
+    V::scatter(d.y, i2, y2 + vy * c2, active);
+    V::scatter(d.z, i2, z2 + vz * c2, active);
+    V::scatter(d.x, i3, x3 + vx * c3, active);
+    V::scatter(d.y, i3, y3 + vy * c3, active);
+    V::scatter(d.z, i3, z3 + vz * c3, active);
+}
+
+void solve_dihedral_scalar(const HingeKernelData& d, std::size_t begin, std::size_t end);
+void solve_isometric_scalar(const HingeKernelData& d, std::size_t begin, std::size_t end);
+
+/**
+ * Full vectors of V, the tail through the scalar kernel of the dispatch translation unit
+ */
+template <typename V>
+void solve_dihedral_vector(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    std::size_t c = begin;
+    for (; c + V::width <= end; c += V::width)
+        dihedral_batch<V>(d, c);
+    solve_dihedral_scalar(d, c, end);
+}
+template <typename V>
+void solve_isometric_vector(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    std::size_t c = begin;
+    for (; c + V::width <= end; c += V::width)
+        isometric_batch<V>(d, c);
+    solve_isometric_scalar(d, c, end);
+}
+
+#ifdef XPBD_X86_KERNELS
+void solve_dihedral_sse41(const HingeKernelData& d, std::size_t begin, std::size_t end);
+void solve_dihedral_avx2(const HingeKernelData& d, std::size_t begin, std::size_t end);
+void solve_dihedral_avx512(const HingeKernelData& d, std::size_t begin, std::size_t end);
+void solve_isometric_sse41(const HingeKernelData& d, std::size_t begin, std::size_t end);
+void solve_isometric_avx2(const HingeKernelData& d, std::size_t begin, std::size_t end);
+void solve_isometric_avx512(const HingeKernelData& d, std::size_t begin, std::size_t end);
+#endif
+}
+}
@@ -0,0 +1,63 @@
+/**
+ * @file
+ * @brief Contains the SSE4.1 hinge bending kernels (4 hinges per instruction).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/bending_kernel_impl.h"
+#include <smmintrin.h>
+
+namespace cloth{
+namespace kernel{
+namespace {
+
+struct Sse41Lane
+{
+    struct F
+    {
+        __m128 v;
+        friend F operator+(F a, F b) { return {_mm_add_ps(a.v, b.v)}; }
+        friend F operator-(F a, F b) { return {_mm_sub_ps(a.v, b.v)}; }
+        friend F operator*(F a, F b) { return {_mm_mul_ps(a.v, b.v)}; }
+        friend F operator/(F a, F b) { return {_mm_div_ps(a.v, b.v)}; }
+    };
+    using M = __m128;
+    static constexpr std::size_t width = 4;
+
+    static F set(float v) { return {_mm_set1_ps(v)}; }
+    static F load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static F gather(const float* base, const std::uint32_t* index) {
+        return {_mm_setr_ps(base[index[0]], base[index[1]], base[index[2]], base[index[3]])};
+    }
+    static void scatter(float* base, const std::uint32_t* index, F v, M active) {
+        alignas(16) float out[width];
+        _mm_store_ps(out, v.v);
+        const int mask = _mm_movemask_ps(active);
+        for (std::size_t l=0; l<width; ++l)
+            if (mask & (1 << l))
+                base[index[l]] = out[l];
+    }
+    static F select(M m, F a, F b) { return {_mm_blendv_ps(b.v, a.v, m)}; }
+    static F sqrt(F v) { return {_mm_sqrt_ps(v.v)}; }
+    static F abs(F v) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), v.v)}; }
+    static F min(F a, F b) { return {_mm_min_ps(b.v, a.v)}; }
+    static F max(F a, F b) { return {_mm_max_ps(b.v, a.v)}; }
+    static M lt(F a, F b) { return _mm_cmplt_ps(a.v, b.v); }
+    static M gt(F a, F b) { return _mm_cmpgt_ps(a.v, b.v); }
+    static M both(M a, M b) { return _mm_and_ps(a, b); }
+    static bool any(M m) { return _mm_movemask_ps(m) != 0; }
+};
+}
+
+void solve_dihedral_sse41(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    solve_dihedral_vector<Sse41Lane>(d, begin, end);
+}
+
+void solve_isometric_sse41(const HingeKernelData& d, std::size_t begin, std::size_t end) {
+    solve_isometric_vector<Sse41Lane>(d, begin, end);
+}
+}
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Contains the functions that add and remove constraints of a coloured set in place.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cloth{
+/**
+ * Colour of constraint i of a coloured set
+ */
+inline std::size_t color_of(const std::vector<std::uint32_t>& color_offsets, std::size_t i) {
+    return static_cast<std::size_t>(std::upper_bound(color_offsets.begin(), color_offsets.end(), i) - color_offsets.begin()) - 1;
+}
+
+/**
+ * Free slot i of a set of size constraints so that the last slot can be dropped. The hole goes to
+ * the end of its colour, then through every following colour, filled each time by the last
+ * constraint of the colour, so the colours stay contiguous; trailing empty colours are dropped.
+ * Without colours the last constraint fills the hole. O(colours)
+ * @param move move(from, to) copies a constraint
+ */
+template <typename Move>
+void remove_colored(std::vector<std::uint32_t>& color_offsets, std::size_t size, std::size_t i, Move&& move) {
+    if (color_offsets.empty()) {
+        if (i + 1 != size)
+            move(size - 1, i);
+        return;
+    }
+    std::size_t hole = i;
+    for (std::size_t k=color_of(color_offsets, i); k+1<color_offsets.size(); ++k) {
+        const std::size_t last = color_offsets[k + 1] - 1;
+        if (last != hole)
+            move(last, hole);
+        hole = last;
+        --color_offsets[k + 1];
+    }
+    while (color_offsets.size() > 1 && color_offsets[color_offsets.size() - 2] == color_offsets.back())
+        color_offsets.pop_back();
+}
+
+/**
+ * Make room in colour c of a set that has just grown to size constraints, its last slot being free:
+ * the first constraint of every following colour moves to the end of its colour. A colour past the
+ * last one is appended. O(colours)
+ * @param move move(from, to) copies a constraint
+ * @return the free slot, the last of colour c (the last slot when the set has no colours)
+ */
+template <typename Move>
+std::size_t insert_colored(std::vector<std::uint32_t>& color_offsets, std::size_t size, std::size_t c, Move&& move) {
+    if (color_offsets.empty())
+        return size - 1;
+    const std::size_t colors = color_offsets.size() - 1;
+    if (c >= colors) {
+        color_offsets.push_back(static_cast<std::uint32_t>(size));
+        return size - 1;
+    }
+    std::size_t free = size - 1;
+    ++color_offsets.back();
+    for (std::size_t k=colors-1; k>c; --k) {
+        const std::size_t first = color_offsets[k];
+        if (first != free)
+            move(first, free);
+        free = first;
+        ++color_offsets[k];
+    }
+    return free;
+}
+}
@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Contains the implementation of the constraint graph colouring.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/coloring.h"
+#include <cstdint>
+#include <vector>
+
+namespace cloth{
+
+/**
+ * Greedy colouring of n constraints, particles(c, out) writes the K particles of constraint c
+ * @return the constraint order, colour after colour, and the colour offsets
+ */
+template <std::size_t K, typename Particles>
+static std::vector<std::uint32_t> greedy_colors(std::size_t n, std::size_t particle_count, Particles&& particles,
+                                                std::vector<std::uint32_t>& offsets) {
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    offsets.assign(1, 0);
+
+    std::vector<std::uint32_t> remaining(n);
+    for (std::size_t i=0; i<n; ++i)
+        remaining[i] = static_cast<std::uint32_t>(i);
+
+    // stamp[p] == colour + 1 when particle p is already used by the colour being built
+    std::vector<std::uint32_t> stamp(particle_count, 0);
+    std::vector<std::uint32_t> next;
+    std::uint32_t nodes[K];
+    for (std::uint32_t color=1; !remaining.empty(); ++color) {
+        next.clear();
+        for (auto c : remaining) {
+            particles(c, nodes);
+            bool taken = false;
+            for (std::size_t k=0; k<K; ++k)
+                taken = taken || stamp[nodes[k]] == color;
+            if (taken) {
+                next.push_back(c);
+                continue;
+            }
+            for (std::size_t k=0; k<K; ++k)
+                stamp[nodes[k]] = color;
+            order.push_back(c);
+        }
+        offsets.push_back(static_cast<std::uint32_t>(order.size()));
+        remaining.swap(next);
+    }
+    return order;
+}
+
+void color_constraints(DistanceConstraints& cs, std::size_t particle_count) {
+    std::vector<std::uint32_t> offsets;
+    const auto order = greedy_colors<2>(cs.size(), particle_count, [&](std::uint32_t c, std::uint32_t* out) {
+        out[0] = cs.first(c);
+        out[1] = cs.second(c);
+    }, offsets);
+    cs.permute(order);
+    cs.color_offsets = std::move(offsets);
+}
+
+template <typename Hinges>
+static void color_hinges(Hinges& cs, std::size_t particle_count) {
+    std::vector<std::uint32_t> offsets;
+    const auto order = greedy_colors<4>(cs.size(), particle_count, [&](std::uint32_t c, std::uint32_t* out) {
+        out[0] = cs.p0[c];
+        out[1] = cs.p1[c];
+        out[2] = cs.p2[c];
+        out[3] = cs.p3[c];
+    }, offsets);
+    cs.permute(order);
+    cs.color_offsets = std::move(offsets);
+}
+
+void color_constraints(DihedralBendConstraints& cs, std::size_t particle_count) {
+    color_hinges(cs, particle_count);
+}
+
+void color_constraints(IsometricBendConstraints& cs, std::size_t particle_count) {
+    color_hinges(cs, particle_count);
+}
+}
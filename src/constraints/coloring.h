@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @brief Contains the graph colouring of constraint sets.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include "constraints/d_constr.h"
+#include "constraints/h_constr.h"
+
+namespace cloth{
+/**
+ * Colour the constraint graph (two constraints are adjacent when they share a particle), reorder
+ * the set so that each colour is contiguous and fill cs.color_offsets.
+ * Colours are filled greedily one at a time, so the first colours are the largest ones.
+ * @param cs constraint set
+ * @param particle_count number of particles referenced by cs
+ */
+void color_constraints(DistanceConstraints& cs, std::size_t particle_count);
+void color_constraints(DihedralBendConstraints& cs, std::size_t particle_count);
+void color_constraints(IsometricBendConstraints& cs, std::size_t particle_count);
+}
@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @brief Contains the implementation of class DistanceConstraints.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/d_constr.h"
+#include <cassert>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace cloth{
+
+void DistanceConstraints::set_index_width(std::size_t particle_count) {
+    assert(empty());
+    is_narrow = particle_count <= static_cast<std::size_t>(std::numeric_limits<std::uint16_t>::max()) + 1;
+}
+
+void DistanceConstraints::reserve(std::size_t n) {
+    rest_dist.reserve(n);
+    compliance.reserve(n);
+    if (is_narrow) {
+        first16.reserve(n);
+        second16.reserve(n);
+    } else {
+        first32.reserve(n);
+        second32.reserve(n);
+    }
+}
+
+void DistanceConstraints::clear() {
+    color_offsets.clear();
+    rest_dist.clear();
+    compliance.clear();
+    first16.clear();
+    second16.clear();
+    first32.clear();
+    second32.clear();
+}
+
+void DistanceConstraints::add(const Particles& p, std::uint32_t node1, std::uint32_t node2, float compliance) {
+    add(node1, node2, compliance, p.distance(node1, node2));
+}
+
+void DistanceConstraints::add(std::uint32_t node1, std::uint32_t node2, float compliance, float rest_distance) {
+    color_offsets.clear();
+    fit(std::max(node1, node2));
+    if (is_narrow) {
+        first16.push_back(static_cast<std::uint16_t>(node1));
+        second16.push_back(static_cast<std::uint16_t>(node2));
+    } else {
+        first32.push_back(node1);
+        second32.push_back(node2);
+    }
+    rest_dist.push_back(rest_distance);
+    DistanceConstraints::compliance.push_back(compliance);
+}
+
+template <typename Index>
+void DistanceConstraints::assign(const Index* first, const Index* second, const float* rest, const float* compliance, std::size_t n) {
+    clear();
+    if (is_narrow && sizeof(Index) > sizeof(std::uint16_t) && n > 0)
+        fit(std::max(*std::max_element(first, first + n), *std::max_element(second, second + n)));
+    if (is_narrow) {
+        first16.assign(first, first + n);
+        second16.assign(second, second + n);
+    } else {
+        first32.assign(first, first + n);
+        second32.assign(second, second + n);
+    }
+    rest_dist.assign(rest, rest + n);
+    DistanceConstraints::compliance.assign(compliance, compliance + n);
+}
+
+template void DistanceConstraints::assign(const std::uint16_t*, const std::uint16_t*, const float*, const float*, std::size_t);
+template void DistanceConstraints::assign(const std::uint32_t*, const std::uint32_t*, const float*, const float*, std::size_t);
+
+template <typename T>
+static void apply_permutation(std::vector<T>& v, const std::vector<std::uint32_t>& order) {
+    if (v.empty())
+        return;
+    std::vector<T> out(v.size());
+    for (std::size_t i=0; i<order.size(); ++i)
+        out[i] = v[order[i]];
+    v.swap(out);
+}
+
+void DistanceConstraints::permute(const std::vector<std::uint32_t>& order) {
+    assert(order.size() == size());
+    apply_permutation(rest_dist, order);
+    apply_permutation(compliance, order);
+    apply_permutation(first16, order);
+    apply_permutation(second16, order);
+    apply_permutation(first32, order);
+    apply_permutation(second32, order);
+}
+
+void DistanceConstraints::set_particles(std::size_t i, std::uint32_t node1, std::uint32_t node2) {
+    fit(std::max(node1, node2));
+    if (is_narrow) {
+        first16[i] = static_cast<std::uint16_t>(node1);
+        second16[i] = static_cast<std::uint16_t>(node2);
+    } else {
+        first32[i] = node1;
+        second32[i] = node2;
+    }
+}
+
+void DistanceConstraints::widen() {
+    if (!is_narrow)
+        return;
+    first32.assign(first16.begin(), first16.end());
+    second32.assign(second16.begin(), second16.end());
+    first16 = {};
+    second16 = {};
+    is_narrow = false;
+}
+
+void DistanceConstraints::fit(std::uint32_t node) {
+    if (is_narrow && node > std::numeric_limits<std::uint16_t>::max())
+        widen();
+}
+
+void DistanceConstraints::move(std::size_t from, std::size_t to) {
+    if (from == to)
+        return;
+    set_particles(to, first(from), second(from));
+    rest_dist[to] = rest_dist[from];
+    compliance[to] = compliance[from];
+}
+
+void DistanceConstraints::pop_back() {
+    rest_dist.pop_back();
+    compliance.pop_back();
+    if (is_narrow) {
+        first16.pop_back();
+        second16.pop_back();
+    } else {
+        first32.pop_back();
+        second32.pop_back();
+    }
+}
+
+// constraints per block of the residual, fixed so the sum does not depend on the pool
+static constexpr std::size_t residual_grain = 8192;
+
+DistanceConstraints::Residual DistanceConstraints::residual(const Particles& p, ThreadPool* pool) const {
+    Residual r;
+    const std::size_t n = size();
+    if (n == 0)
+        return r;
+    // the rms field holds the sum of squares until the end
+    r = parallel_reduce(pool, 0, n, residual_grain, Residual {}, [&](std::size_t begin, std::size_t end) {
+        Residual part;
+        for (std::size_t c=begin; c<end; ++c) {
+            if (rest_dist[c] == 0.0)
+                continue;
+            const double strain = std::abs((p.distance(first(c), second(c)) - rest_dist[c]) / rest_dist[c]);
+            part.rms += strain * strain;
+            if (strain > part.max)
+                part.max = strain;
+        }
+        return part;
+    }, [](Residual a, const Residual& b) {
+        a.rms += b.rms;
+        a.max = std::max(a.max, b.max);
+        return a;
+    });
+    r.rms = std::sqrt(r.rms / static_cast<double>(n));
+    return r;
+}
+
+std::size_t DistanceConstraints::memory_usage() const {
+    return rest_dist.capacity() * sizeof(float) + compliance.capacity() * sizeof(float)
+         + (first16.capacity() + second16.capacity()) * sizeof(std::uint16_t)
+         + (first32.capacity() + second32.capacity()) * sizeof(std::uint32_t);
+}
+
+std::ostream& operator<<(std::ostream& os, const DistanceConstraints& d) {
+    os << d.size() << " constraints (" << (d.narrow() ? 16 : 32) << " bit indices)";
+    return os;
+}
+}
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief Contains the class DistanceConstraints, the compact storage shared by stretching and bending constraints.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <ostream>
+#include "node/particles.h"
+#include "constraints/color_edit.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class DistanceConstraints
+ * @brief Distance constraints stored as parallel arrays: two particle index arrays, rest distance
+ * and compliance. Indices are 16 bit when the cloth has at most 65536 particles, 32 bit otherwise.
+ */
+class DistanceConstraints
+{
+public:
+    /**
+     * Distance between nodes at rest
+    */
+    std::vector<float> rest_dist;
+    /**
+     * Compliance (inverse stiffness) of each constraint
+    */
+    std::vector<float> compliance;
+    /**
+     * Start offset of every colour, plus the total as last element. Constraints of the same colour
+     * share no particle and can be solved concurrently. Empty until the set is coloured.
+    */
+    std::vector<std::uint32_t> color_offsets;
+
+    /**
+     * Choose the index width for a cloth with particle_count particles. Must be called while empty;
+     * a later node past the 16 bit range switches the set to 32 bit indices (widen).
+     * @param particle_count
+     */
+    void set_index_width(std::size_t particle_count);
+
+    bool narrow() const { return is_narrow; }
+    std::size_t size() const { return rest_dist.size(); }
+    bool empty() const { return rest_dist.empty(); }
+    std::size_t colors() const { return color_offsets.empty() ? 0 : color_offsets.size() - 1; }
+
+    void reserve(std::size_t n);
+    void clear();
+
+    /**
+     * Add a constraint whose rest distance is the current distance of the two particles
+     */
+    void add(const Particles& p, std::uint32_t node1, std::uint32_t node2, float compliance);
+    void add(std::uint32_t node1, std::uint32_t node2, float compliance, float rest_distance);
+
+    /**
+     * Replace the set with n constraints copied from raw arrays, e.g. a mapped checkpoint. The index
+     * width must have been chosen with set_index_width; indices of the same width are copied as
+     * they are, others are converted.
+     */
+    template <typename Index>
+    void assign(const Index* first, const Index* second, const float* rest, const float* compliance, std::size_t n);
+
+    /**
+     * Reorder the constraints so that the i-th one becomes the order[i]-th of the old layout
+     * @param order permutation of [0, size())
+     */
+    void permute(const std::vector<std::uint32_t>& order);
+
+    /**
+     * Remove constraint i in O(colours), the colours stay contiguous (see remove_colored)
+     * @param moved moved(from, to) is called for every constraint that changes place
+     */
+    template <typename Moved>
+    void remove(std::size_t i, Moved&& moved) {
+        remove_colored(color_offsets, size(), i, [&](std::size_t from, std::size_t to) {
+            move(from, to);
+            moved(from, to);
+        });
+        pop_back();
+    }
+    /**
+     * Add a constraint to colour color in O(colours), the caller makes sure that no constraint of
+     * the colour uses its particles; color = colors() opens a new colour
+     * @param moved moved(from, to) is called for every constraint that changes place
+     * @return index of the new constraint
+     */
+    template <typename Moved>
+    std::size_t insert(std::size_t color, std::uint32_t node1, std::uint32_t node2, float compliance, float rest_distance, Moved&& moved) {
+        // add() drops the colours, the new constraint goes to the slot freed in its colour
+        std::vector<std::uint32_t> colors = std::move(color_offsets);
+        add(node1, node2, compliance, rest_distance);
+        color_offsets = std::move(colors);
+        const std::size_t slot = insert_colored(color_offsets, size(), color, [&](std::size_t from, std::size_t to) {
+            move(from, to);
+            moved(from, to);
+        });
+        set_particles(slot, node1, node2);
+        rest_dist[slot] = rest_distance;
+        DistanceConstraints::compliance[slot] = compliance;
+        return slot;
+    }
+    /**
+     * Change the particles of constraint i
+     */
+    void set_particles(std::size_t i, std::uint32_t node1, std::uint32_t node2);
+    /**
+     * Switch to 32 bit indices; add, assign and set_particles do it when a node needs them
+     */
+    void widen();
+
+    std::uint32_t first(std::size_t i) const { return is_narrow ? first16[i] : first32[i]; }
+    std::uint32_t second(std::size_t i) const { return is_narrow ? second16[i] : second32[i]; }
+
+    /**
+     * Call f(first, second) with raw pointers to the index arrays of the active width, so hot loops
+     * are instantiated once per index type instead of branching per constraint.
+     */
+    template <typename F>
+    decltype(auto) with_indices(F&& f) const {
+        if (is_narrow)
+            return f(first16.data(), second16.data());
+        return f(first32.data(), second32.data());
+    }
+
+    /**
+     * Root mean square and maximum of the relative violation |C| / rest_dist over the set. The
+     * sum is reduced in fixed blocks, the result does not depend on the pool.
+     */
+    struct Residual {
+        double rms = 0.0;
+        double max = 0.0;
+    };
+    Residual residual(const Particles& p, ThreadPool* pool = nullptr) const;
+
+    /**
+     * Bytes used by the constraint arrays
+     */
+    std::size_t memory_usage() const;
+
+    friend std::ostream& operator<<(std::ostream& os, const DistanceConstraints& d);
+
+private:
+    void move(std::size_t from, std::size_t to);
+    void pop_back();
+    /**
+     * Widen if node does not fit the current index width
+     */
+    void fit(std::uint32_t node);
+
+    bool is_narrow = false;
+    std::vector<std::uint16_t> first16, second16;
+    std::vector<std::uint32_t> first32, second32;
+};
+}
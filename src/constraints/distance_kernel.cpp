@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @brief Contains the runtime dispatch of the distance kernel.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/distance_kernel.h"
+#include "constraints/distance_kernel_impl.h"
+
+namespace cloth{
+
+bool simd_level_supported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return true;
+#if defined(XPBD_X86_KERNELS) && (defined(__GNUC__) || defined(__clang__))
+        case SimdLevel::SSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case SimdLevel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case SimdLevel::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+SimdLevel best_simd_level() {
+    static const SimdLevel best = [] {
+        for (SimdLevel l : {SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE41})
+            if (simd_level_supported(l))
+                return l;
+        return SimdLevel::Scalar;
+    }();
+    return best;
+}
+
+const char* to_string(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE41:  return "sse41";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        default:                return "scalar";
+    }
+}
+
+bool parse_simd_level(const std::string& name, SimdLevel& level) {
+    if (name == "auto") {
+        level = best_simd_level();
+        return true;
+    }
+    for (SimdLevel l : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (name == to_string(l)) {
+            level = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename I>
+static void dispatch(SimdLevel level, const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end) {
+    switch (level) {
+#ifdef XPBD_X86_KERNELS
+        case SimdLevel::AVX512:
+            kernel::solve_distance_avx512(d, first, second, begin, end);
+            return;
+        case SimdLevel::AVX2:
+            kernel::solve_distance_avx2(d, first, second, begin, end);
+            return;
+        case SimdLevel::SSE41:
+            kernel::solve_distance_sse41(d, first, second, begin, end);
+            return;
+#endif
+        default:
+            kernel::solve_distance_scalar(d, first, second, begin, end);
+    }
+}
+
+void solve_distance_range(SimdLevel level, const DistanceKernelData& d,
+                          const std::uint16_t* first, const std::uint16_t* second,
+                          std::size_t begin, std::size_t end) {
+    dispatch(level, d, first, second, begin, end);
+}
+
+void solve_distance_range(SimdLevel level, const DistanceKernelData& d,
+                          const std::uint32_t* first, const std::uint32_t* second,
+                          std::size_t begin, std::size_t end) {
+    dispatch(level, d, first, second, begin, end);
+}
+}
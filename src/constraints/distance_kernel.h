@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Contains the batched distance constraint kernels and their runtime ISA dispatch.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cloth{
+/**
+ * Instruction sets the distance kernel is compiled for, ordered by width
+ */
+enum class SimdLevel {
+    Scalar,     ///< one constraint at a time, always available
+    SSE41,      ///< 4 constraints per instruction
+    AVX2,       ///< 8 constraints per instruction
+    AVX512      ///< 16 constraints per instruction
+};
+
+/**
+ * Widest level both compiled in and supported by the running CPU
+ */
+SimdLevel best_simd_level();
+
+/**
+ * True when level is compiled in and supported by the running CPU
+ */
+bool simd_level_supported(SimdLevel level);
+
+const char* to_string(SimdLevel level);
+
+/**
+ * Parse "scalar", "sse41", "avx2", "avx512" (or "auto" for best_simd_level())
+ * @returns false when name is not a level
+ */
+bool parse_simd_level(const std::string& name, SimdLevel& level);
+
+/**
+ * Arrays read and written by the distance kernel
+ */
+struct DistanceKernelData {
+    float* x;
+    float* y;
+    float* z;
+    const float* w;
+    const float* rest;
+    const float* compliance;
+    float timeStep;
+};
+
+/**
+ * Project constraints [begin, end) in order. Within the range no two constraints may share a
+ * particle (a colour or part of one), every level then gives bitwise the same positions as Scalar.
+ */
+void solve_distance_range(SimdLevel level, const DistanceKernelData& d,
+                          const std::uint16_t* first, const std::uint16_t* second,
+                          std::size_t begin, std::size_t end);
+void solve_distance_range(SimdLevel level, const DistanceKernelData& d,
+                          const std::uint32_t* first, const std::uint32_t* second,
+                          std::size_t begin, std::size_t end);
+
+/**
+ * Projection of a single distance constraint between particles a and b. The vector kernels
+ * reproduce this exact sequence of operations.
+ */
+inline void solve_distance(const DistanceKernelData& d, std::uint32_t a, std::uint32_t b, std::size_t c) {
+    const float wa = d.w[a];
+    const float wb = d.w[b];
+    if (wa + wb == 0.0f)
+        return;
+    float dx = d.x[a] - d.x[b];
+    float dy = d.y[a] - d.y[b];
+    float dz = d.z[a] - d.z[b];
+    float abs_distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (abs_distance == 0.0f)
+        return;
+    float inv = 1.0f / abs_distance;
+    dx *= inv;
+    dy *= inv;
+    dz *= inv;
+
+    float alpha = d.compliance[c] / d.timeStep / d.timeStep;
+    float C = abs_distance - d.rest[c];
+    float s = -C / ((wa + wb) + alpha);
+
+    d.x[a] += dx * s * wa;
+    d.y[a] += dy * s * wa;
+    d.z[a] += dz * s * wa;
+    d.x[b] += dx * -s * wb;
+    d.y[b] += dy * -s * wb;
+    d.z[b] += dz * -s * wb;
+}
+}
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Contains the AVX2 distance kernel (8 constraints per instruction).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/distance_kernel_impl.h"
+#include <immintrin.h>
+
+namespace cloth{
+namespace kernel{
+
+template <typename I>
+static inline __m256i load_indices(const I* p) {
+    if constexpr (sizeof(I) == 2)
+        return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    else
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+template <typename I>
+void solve_distance_avx2(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end) {
+    constexpr std::size_t W = 8;
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 dt = _mm256_set1_ps(d.timeStep);
+
+    std::size_t c = begin;
+    for (; c + W <= end; c += W) {
+        const __m256i ia = load_indices(first + c);
+        const __m256i ib = load_indices(second + c);
+        const __m256 wa = _mm256_i32gather_ps(d.w, ia, 4);
+        const __m256 wb = _mm256_i32gather_ps(d.w, ib, 4);
+        const __m256 wsum = _mm256_add_ps(wa, wb);
+        const __m256 xa = _mm256_i32gather_ps(d.x, ia, 4);
+        const __m256 ya = _mm256_i32gather_ps(d.y, ia, 4);
+        const __m256 za = _mm256_i32gather_ps(d.z, ia, 4);
+        const __m256 xb = _mm256_i32gather_ps(d.x, ib, 4);
+        const __m256 yb = _mm256_i32gather_ps(d.y, ib, 4);
+        const __m256 zb = _mm256_i32gather_ps(d.z, ib, 4);
+
+        __m256 dx = _mm256_sub_ps(xa, xb);
+        __m256 dy = _mm256_sub_ps(ya, yb);
+        __m256 dz = _mm256_sub_ps(za, zb);
+        const __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz)));
+        const int active = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(wsum, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(len, zero, _CMP_NEQ_UQ)));
+        if (active == 0)
+            continue;
+
+        const __m256 inv = _mm256_div_ps(one, len);
+        dx = _mm256_mul_ps(dx, inv);
+        dy = _mm256_mul_ps(dy, inv);
+        dz = _mm256_mul_ps(dz, inv);
+
+        const __m256 alpha = _mm256_div_ps(_mm256_div_ps(_mm256_loadu_ps(d.compliance + c), dt), dt);
+        const __m256 C = _mm256_sub_ps(len, _mm256_loadu_ps(d.rest + c));
+        const __m256 s = _mm256_div_ps(_mm256_xor_ps(C, sign), _mm256_add_ps(wsum, alpha));
+        const __m256 ns = _mm256_xor_ps(s, sign);
+
+        alignas(32) float out[6][W];
+        alignas(32) std::uint32_t a[W], b[W];
+        _mm256_store_ps(out[0], _mm256_add_ps(xa, _mm256_mul_ps(_mm256_mul_ps(dx, s), wa)));
+        _mm256_store_ps(out[1], _mm256_add_ps(ya, _mm256_mul_ps(_mm256_mul_ps(dy, s), wa)));
+        _mm256_store_ps(out[2], _mm256_add_ps(za, _mm256_mul_ps(_mm256_mul_ps(dz, s), wa)));
+        _mm256_store_ps(out[3], _mm256_add_ps(xb, _mm256_mul_ps(_mm256_mul_ps(dx, ns), wb)));
+        _mm256_store_ps(out[4], _mm256_add_ps(yb, _mm256_mul_ps(_mm256_mul_ps(dy, ns), wb)));
+        _mm256_store_ps(out[5], _mm256_add_ps(zb, _mm256_mul_ps(_mm256_mul_ps(dz, ns), wb)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(a), ia);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(b), ib);
+        for (std::size_t l=0; l<W; ++l) {
+            if (!(active & (1 << l)))
+                continue;
+            d.x[a[l]] = out[0][l];
+            d.y[a[l]] = out[1][l];
+            d.z[a[l]] = out[2][l];
+            d.x[b[l]] = out[3][l];
+            d.y[b[l]] = out[4][l];
+            d.z[b[l]] = out[5][l];
+        }
+    }
+    solve_distance_scalar(d, first, second, c, end);
+}
+
+template void solve_distance_avx2<std::uint16_t>(const DistanceKernelData&, const std::uint16_t*, const std::uint16_t*, std::size_t, std::size_t);
+template void solve_distance_avx2<std::uint32_t>(const DistanceKernelData&, const std::uint32_t*, const std::uint32_t*, std::size_t, std::size_t);
+}
+}
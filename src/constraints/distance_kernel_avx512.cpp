@@ -0,0 +1,81 @@
+/**
+ * @file
+ * @brief Contains the AVX-512 distance kernel (16 constraints per instruction).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/distance_kernel_impl.h"
+#include <immintrin.h>
+
+namespace cloth{
+namespace kernel{
+
+template <typename I>
+static inline __m512i load_indices(const I* p) {
+    if constexpr (sizeof(I) == 2)
+        return _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    else
+        return _mm512_loadu_si512(p);
+}
+
+// sign flip through the integer unit, _mm512_xor_ps needs AVX512DQ
+static inline __m512 negate(__m512 v) {
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), _mm512_set1_epi32(static_cast<int>(0x80000000u))));
+}
+
+template <typename I>
+void solve_distance_avx512(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end) {
+    constexpr std::size_t W = 16;
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 dt = _mm512_set1_ps(d.timeStep);
+
+    std::size_t c = begin;
+    for (; c + W <= end; c += W) {
+        const __m512i ia = load_indices(first + c);
+        const __m512i ib = load_indices(second + c);
+        const __m512 wa = _mm512_i32gather_ps(ia, d.w, 4);
+        const __m512 wb = _mm512_i32gather_ps(ib, d.w, 4);
+        const __m512 wsum = _mm512_add_ps(wa, wb);
+        const __m512 xa = _mm512_i32gather_ps(ia, d.x, 4);
+        const __m512 ya = _mm512_i32gather_ps(ia, d.y, 4);
+        const __m512 za = _mm512_i32gather_ps(ia, d.z, 4);
+        const __m512 xb = _mm512_i32gather_ps(ib, d.x, 4);
+        const __m512 yb = _mm512_i32gather_ps(ib, d.y, 4);
+        const __m512 zb = _mm512_i32gather_ps(ib, d.z, 4);
+
+        __m512 dx = _mm512_sub_ps(xa, xb);
+        __m512 dy = _mm512_sub_ps(ya, yb);
+        __m512 dz = _mm512_sub_ps(za, zb);
+        const __m512 len = _mm512_sqrt_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz)));
+        const __mmask16 active = _mm512_cmp_ps_mask(wsum, zero, _CMP_NEQ_UQ) & _mm512_cmp_ps_mask(len, zero, _CMP_NEQ_UQ);
+        if (active == 0)
+            continue;
+
+        const __m512 inv = _mm512_div_ps(one, len);
+        dx = _mm512_mul_ps(dx, inv);
+        dy = _mm512_mul_ps(dy, inv);
+        dz = _mm512_mul_ps(dz, inv);
+
+        const __m512 alpha = _mm512_div_ps(_mm512_div_ps(_mm512_loadu_ps(d.compliance + c), dt), dt);
+        const __m512 C = _mm512_sub_ps(len, _mm512_loadu_ps(d.rest + c));
+        const __m512 s = _mm512_div_ps(negate(C), _mm512_add_ps(wsum, alpha));
+        const __m512 ns = negate(s);
+
+        _mm512_mask_i32scatter_ps(d.x, active, ia, _mm512_add_ps(xa, _mm512_mul_ps(_mm512_mul_ps(dx, s), wa)), 4);
+        _mm512_mask_i32scatter_ps(d.y, active, ia, _mm512_add_ps(ya, _mm512_mul_ps(_mm512_mul_ps(dy, s), wa)), 4);
+        _mm512_mask_i32scatter_ps(d.z, active, ia, _mm512_add_ps(za, _mm512_mul_ps(_mm512_mul_ps(dz, s), wa)), 4);
+        _mm512_mask_i32scatter_ps(d.x, active, ib, _mm512_add_ps(xb, _mm512_mul_ps(_mm512_mul_ps(dx, ns), wb)), 4);
+        _mm512_mask_i32scatter_ps(d.y, active, ib, _mm512_add_ps(yb, _mm512_mul_ps(_mm512_mul_ps(dy, ns), wb)), 4);
+        _mm512_mask_i32scatter_ps(d.z, active, ib, _mm512_add_ps(zb, _mm512_mul_ps(_mm512_mul_ps(dz, ns), wb)), 4);
+    }
+    solve_distance_scalar(d, first, second, c, end);
+}
+
+template void solve_distance_avx512<std::uint16_t>(const DistanceKernelData&, const std::uint16_t*, const std::uint16_t*, std::size_t, std::size_t);
+template void solve_distance_avx512<std::uint32_t>(const DistanceKernelData&, const std::uint32_t*, const std::uint32_t*, std::size_t, std::size_t);
+}
+}
@@ -0,0 +1,30 @@
+/**
+ * @file
+ * @brief Contains the per-ISA entry points of the distance kernel (private to the constr library).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include "constraints/distance_kernel.h"
+
+namespace cloth{
+namespace kernel{
+template <typename I>
+void solve_distance_scalar(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end) {
+    for (std::size_t c=begin; c<end; ++c)
+        solve_distance(d, first[c], second[c], c);
+}
+
+#ifdef XPBD_X86_KERNELS
+template <typename I>
+void solve_distance_sse41(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end);
+template <typename I>
+void solve_distance_avx2(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end);
+template <typename I>
+void solve_distance_avx512(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end);
+#endif
+}
+}
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Contains the SSE4.1 distance kernel (4 constraints per instruction).
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/distance_kernel_impl.h"
+#include <smmintrin.h>
+
+namespace cloth{
+namespace kernel{
+
+static inline __m128 gather(const float* base, const std::uint32_t* idx) {
+    return _mm_setr_ps(base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]);
+}
+
+template <typename I>
+void solve_distance_sse41(const DistanceKernelData& d, const I* first, const I* second, std::size_t begin, std::size_t end) {
+    constexpr std::size_t W = 4;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 dt = _mm_set1_ps(d.timeStep);
+
+    std::size_t c = begin;
+    for (; c + W <= end; c += W) {
+        std::uint32_t a[W], b[W];
+        for (std::size_t l=0; l<W; ++l) {
+            a[l] = first[c + l];
+            b[l] = second[c + l];
+        }
+        const __m128 wa = gather(d.w, a);
+        const __m128 wb = gather(d.w, b);
+        const __m128 wsum = _mm_add_ps(wa, wb);
+        const __m128 xa = gather(d.x, a), ya = gather(d.y, a), za = gather(d.z, a);
+        const __m128 xb = gather(d.x, b), yb = gather(d.y, b), zb = gather(d.z, b);
+
+        __m128 dx = _mm_sub_ps(xa, xb);
+        __m128 dy = _mm_sub_ps(ya, yb);
+        __m128 dz = _mm_sub_ps(za, zb);
+        const __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        const int active = _mm_movemask_ps(_mm_and_ps(_mm_cmpneq_ps(wsum, zero), _mm_cmpneq_ps(len, zero)));
+        if (active == 0)
+            continue;
+
+        const __m128 inv = _mm_div_ps(one, len);
+        dx = _mm_mul_ps(dx, inv);
+        dy = _mm_mul_ps(dy, inv);
+        dz = _mm_mul_ps(dz, inv);
+
+        const __m128 alpha = _mm_div_ps(_mm_div_ps(_mm_loadu_ps(d.compliance + c), dt), dt);
+        const __m128 C = _mm_sub_ps(len, _mm_loadu_ps(d.rest + c));
+        const __m128 s = _mm_div_ps(_mm_xor_ps(C, sign), _mm_add_ps(wsum, alpha));
+        const __m128 ns = _mm_xor_ps(s, sign);
+
+        alignas(16) float out[6][W];
+        _mm_store_ps(out[0], _mm_add_ps(xa, _mm_mul_ps(_mm_mul_ps(dx, s), wa)));
+        _mm_store_ps(out[1], _mm_add_ps(ya, _mm_mul_ps(_mm_mul_ps(dy, s), wa)));
+        _mm_store_ps(out[2], _mm_add_ps(za, _mm_mul_ps(_mm_mul_ps(dz, s), wa)));
+        _mm_store_ps(out[3], _mm_add_ps(xb, _mm_mul_ps(_mm_mul_ps(dx, ns), wb)));
+        _mm_store_ps(out[4], _mm_add_ps(yb, _mm_mul_ps(_mm_mul_ps(dy, ns), wb)));
+        _mm_store_ps(out[5], _mm_add_ps(zb, _mm_mul_ps(_mm_mul_ps(dz, ns), wb)));
+        for (std::size_t l=0; l<W; ++l) {
+            if (!(active & (1 << l)))
+                continue;
+            d.x[a[l]] = out[0][l];
+            d.y[a[l]] = out[1][l];
+            d.z[a[l]] = out[2][l];
+            d.x[b[l]] = out[3][l];
+            d.y[b[l]] = out[4][l];
+            d.z[b[l]] = out[5][l];
+        }
+    }
+    solve_distance_scalar(d, first, second, c, end);
+}
+
+template void solve_distance_sse41<std::uint16_t>(const DistanceKernelData&, const std::uint16_t*, const std::uint16_t*, std::size_t, std::size_t);
+template void solve_distance_sse41<std::uint32_t>(const DistanceKernelData&, const std::uint32_t*, const std::uint32_t*, std::size_t, std::size_t);
+}
+}
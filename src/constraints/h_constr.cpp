@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Contains the implementation of the hinge bending constraints.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/h_constr.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <gtc/constants.hpp>
+#include "constraints/bending_kernel.h"
+
+namespace cloth{
+
+template <typename T>
+static void apply_permutation(std::vector<T>& v, const std::vector<std::uint32_t>& order) {
+    if (v.empty())
+        return;
+    std::vector<T> out(v.size());
+    for (std::size_t i=0; i<order.size(); ++i)
+        out[i] = v[order[i]];
+    v.swap(out);
+}
+
+void HingeConstraints::reserve_hinges(std::size_t n) {
+    p0.reserve(n);
+    p1.reserve(n);
+    p2.reserve(n);
+    p3.reserve(n);
+    compliance.reserve(n);
+}
+
+void HingeConstraints::clear_hinges() {
+    color_offsets.clear();
+    p0.clear();
+    p1.clear();
+    p2.clear();
+    p3.clear();
+    compliance.clear();
+}
+
+void HingeConstraints::add_hinge(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, float compliance) {
+    color_offsets.clear();
+    p0.push_back(a);
+    p1.push_back(b);
+    p2.push_back(c);
+    p3.push_back(d);
+    HingeConstraints::compliance.push_back(compliance);
+}
+
+void HingeConstraints::permute_hinges(const std::vector<std::uint32_t>& order) {
+    assert(order.size() == size());
+    apply_permutation(p0, order);
+    apply_permutation(p1, order);
+    apply_permutation(p2, order);
+    apply_permutation(p3, order);
+    apply_permutation(compliance, order);
+}
+
+void HingeConstraints::move_hinge(std::size_t from, std::size_t to) {
+    p0[to] = p0[from];
+    p1[to] = p1[from];
+    p2[to] = p2[from];
+    p3[to] = p3[from];
+    compliance[to] = compliance[from];
+}
+
+void HingeConstraints::pop_hinge() {
+    p0.pop_back();
+    p1.pop_back();
+    p2.pop_back();
+    p3.pop_back();
+    compliance.pop_back();
+}
+
+/**
+ * Signed angle between the triangles (x0, x1, x2) and (x1, x0, x3), as computed by the kernel
+ */
+static float hinge_angle(const glm::vec3& x0, const glm::vec3& x1, const glm::vec3& x2, const glm::vec3& x3) {
+    const glm::vec3 e = x1 - x0;
+    const glm::vec3 n1 = glm::cross(x2 - x0, x2 - x1);
+    const glm::vec3 n2 = glm::cross(x3 - x1, x3 - x0);
+    return hinge_atan2(glm::dot(glm::cross(n1, n2), e), glm::dot(n1, n2) * glm::length(e));
+}
+
+void DihedralBendConstraints::reserve(std::size_t n) {
+    reserve_hinges(n);
+    rest_angle.reserve(n);
+}
+
+void DihedralBendConstraints::clear() {
+    clear_hinges();
+    rest_angle.clear();
+}
+
+bool DihedralBendConstraints::add(const Particles& p, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, float compliance) {
+    const glm::vec3 x0 = p.position(a), x1 = p.position(b), x2 = p.position(c), x3 = p.position(d);
+    const float edge2 = glm::dot(x1 - x0, x1 - x0);
+    const float area0 = 0.5f * glm::length(glm::cross(x1 - x0, x2 - x0));
+    const float area1 = 0.5f * glm::length(glm::cross(x1 - x0, x3 - x0));
+    if (edge2 == 0.0f || area0 == 0.0f || area1 == 0.0f)
+        return false;
+    // discrete shell weight: the stiffness of a hinge is 3 |e|^2 / (A0 + A1)
+    add_hinge(a, b, c, d, compliance * (area0 + area1) / (3.0f * edge2));
+    rest_angle.push_back(hinge_angle(x0, x1, x2, x3));
+    return true;
+}
+
+void DihedralBendConstraints::permute(const std::vector<std::uint32_t>& order) {
+    permute_hinges(order);
+    apply_permutation(rest_angle, order);
+}
+
+void DihedralBendConstraints::move(std::size_t from, std::size_t to) {
+    move_hinge(from, to);
+    rest_angle[to] = rest_angle[from];
+}
+
+void DihedralBendConstraints::pop_back() {
+    pop_hinge();
+    rest_angle.pop_back();
+}
+
+DistanceConstraints::Residual DihedralBendConstraints::residual(const Particles& p) const {
+    DistanceConstraints::Residual r;
+    if (empty())
+        return r;
+    double sum = 0.0;
+    for (std::size_t i=0; i<size(); ++i) {
+        float C = hinge_angle(p.position(p0[i]), p.position(p1[i]), p.position(p2[i]), p.position(p3[i])) - rest_angle[i];
+        if (C > glm::pi<float>())
+            C -= glm::two_pi<float>();
+        if (C < -glm::pi<float>())
+            C += glm::two_pi<float>();
+        sum += static_cast<double>(C) * C;
+        r.max = std::max(r.max, static_cast<double>(std::fabs(C)));
+    }
+    r.rms = std::sqrt(sum / size());
+    return r;
+}
+
+void IsometricBendConstraints::reserve(std::size_t n) {
+    reserve_hinges(n);
+    k0.reserve(n);
+    k1.reserve(n);
+    k2.reserve(n);
+    k3.reserve(n);
+    scale.reserve(n);
+}
+
+void IsometricBendConstraints::clear() {
+    clear_hinges();
+    k0.clear();
+    k1.clear();
+    k2.clear();
+    k3.clear();
+    scale.clear();
+}
+
+/**
+ * Cotangent of the angle between u and v
+ */
+static float cotangent(const glm::vec3& u, const glm::vec3& v) {
+    return glm::dot(u, v) / glm::length(glm::cross(u, v));
+}
+
+bool IsometricBendConstraints::add(const Particles& p, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, float compliance) {
+    const glm::vec3 x0 = p.position(a), x1 = p.position(b), x2 = p.position(c), x3 = p.position(d);
+    const float area0 = 0.5f * glm::length(glm::cross(x1 - x0, x2 - x0));
+    const float area1 = 0.5f * glm::length(glm::cross(x1 - x0, x3 - x0));
+    if (area0 == 0.0f || area1 == 0.0f)
+        return false;
+    // angles at the edge vertices, in the first (x2) and the second (x3) triangle
+    const float cot_a0 = cotangent(x1 - x0, x2 - x0);
+    const float cot_a1 = cotangent(x0 - x1, x2 - x1);
+    const float cot_b0 = cotangent(x1 - x0, x3 - x0);
+    const float cot_b1 = cotangent(x0 - x1, x3 - x1);
+    add_hinge(a, b, c, d, compliance);
+    k0.push_back(cot_a1 + cot_b1);
+    k1.push_back(cot_a0 + cot_b0);
+    k2.push_back(-cot_a0 - cot_a1);
+    k3.push_back(-cot_b0 - cot_b1);
+    scale.push_back(3.0f / (area0 + area1));
+    return true;
+}
+
+void IsometricBendConstraints::permute(const std::vector<std::uint32_t>& order) {
+    permute_hinges(order);
+    apply_permutation(k0, order);
+    apply_permutation(k1, order);
+    apply_permutation(k2, order);
+    apply_permutation(k3, order);
+    apply_permutation(scale, order);
+}
+
+void IsometricBendConstraints::move(std::size_t from, std::size_t to) {
+    move_hinge(from, to);
+    k0[to] = k0[from];
+    k1[to] = k1[from];
+    k2[to] = k2[from];
+    k3[to] = k3[from];
+    scale[to] = scale[from];
+}
+
+void IsometricBendConstraints::pop_back() {
+    pop_hinge();
+    k0.pop_back();
+    k1.pop_back();
+    k2.pop_back();
+    k3.pop_back();
+    scale.pop_back();
+}
+
+DistanceConstraints::Residual IsometricBendConstraints::residual(const Particles& p) const {
+    DistanceConstraints::Residual r;
+    if (empty())
+        return r;
+    double sum = 0.0;
+    for (std::size_t i=0; i<size(); ++i) {
+        const glm::vec3 v = k0[i] * p.position(p0[i]) + k1[i] * p.position(p1[i]) + k2[i] * p.position(p2[i]) + k3[i] * p.position(p3[i]);
+        const double C = std::sqrt(scale[i]) * glm::length(v);
+        sum += C * C;
+        r.max = std::max(r.max, C);
+    }
+    r.rms = std::sqrt(sum / size());
+    return r;
+}
+}
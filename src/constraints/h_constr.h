@@ -0,0 +1,141 @@
+/**
+ * @file
+ * @brief Contains the hinge bending constraints: class HingeConstraints and its dihedral-angle and
+ * isometric (quadratic) models.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "node/particles.h"
+#include "constraints/d_constr.h"
+#include "constraints/color_edit.h"
+
+namespace cloth{
+/**
+ * @class HingeConstraints
+ * @brief Constraints on two triangles sharing an edge, stored as parallel arrays. p0 p1 is the
+ * shared edge, p2 the third vertex of the first triangle and p3 of the second.
+ */
+class HingeConstraints
+{
+public:
+    std::vector<std::uint32_t> p0, p1, p2, p3;
+    /**
+     * Compliance (inverse stiffness) of each constraint
+    */
+    std::vector<float> compliance;
+    /**
+     * Start offset of every colour, plus the total as last element, as in DistanceConstraints
+    */
+    std::vector<std::uint32_t> color_offsets;
+
+    std::size_t size() const { return p0.size(); }
+    bool empty() const { return p0.empty(); }
+    std::size_t colors() const { return color_offsets.empty() ? 0 : color_offsets.size() - 1; }
+
+protected:
+    void reserve_hinges(std::size_t n);
+    void clear_hinges();
+    void add_hinge(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, float compliance);
+    void permute_hinges(const std::vector<std::uint32_t>& order);
+    void move_hinge(std::size_t from, std::size_t to);
+    void pop_hinge();
+};
+
+/**
+ * @struct DihedralBendConstraints
+ * @brief C = theta - rest_angle, theta the signed angle between the normals of the two triangles.
+ * The compliance of every hinge is divided by the discrete shell weight 3 |e|^2 / (A0 + A1), so the
+ * bending energy converges as the mesh is refined and one compliance fits every resolution.
+ */
+struct DihedralBendConstraints : public HingeConstraints
+{
+    static constexpr float default_compliance = 1.0f;
+
+    std::vector<float> rest_angle;
+
+    void reserve(std::size_t n);
+    void clear();
+    /**
+     * Add a hinge whose rest angle is the current angle of the particles
+     * @return false when a triangle is degenerate, nothing is added
+     */
+    bool add(const Particles& p, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, float compliance);
+    void permute(const std::vector<std::uint32_t>& order);
+    /**
+     * Remove hinge i in O(colours), the colours stay contiguous (see remove_colored)
+     * @param moved moved(from, to) is called for every hinge that changes place
+     */
+    template <typename Moved>
+    void remove(std::size_t i, Moved&& moved) {
+        remove_colored(color_offsets, size(), i, [&](std::size_t from, std::size_t to) {
+            move(from, to);
+            moved(from, to);
+        });
+        pop_back();
+    }
+
+    /**
+     * Root mean square and maximum of |theta - rest_angle| in radians
+     */
+    DistanceConstraints::Residual residual(const Particles& p) const;
+
+private:
+    void move(std::size_t from, std::size_t to);
+    void pop_back();
+};
+
+/**
+ * @struct IsometricBendConstraints
+ * @brief Quadratic bending of Bergou et al., for surfaces that are flat at rest: the energy of a
+ * hinge is 1/2 x^T Q x over its four positions, Q = scale * K K^T with K the cotangent weights of the
+ * rest shape and scale = 3 / (A0 + A1). The constraint is C = |sum K_i x_i| sqrt(scale), so the
+ * gradient is linear in the positions and a projection costs a fixed handful of flops.
+ */
+struct IsometricBendConstraints : public HingeConstraints
+{
+    static constexpr float default_compliance = 1.0f;
+
+    /**
+     * Rank one factor of Q, one weight per hinge vertex
+     */
+    std::vector<float> k0, k1, k2, k3;
+    std::vector<float> scale;
+
+    void reserve(std::size_t n);
+    void clear();
+    /**
+     * Add a hinge, K and scale come from the current positions, taken as the rest shape
+     * @return false when a triangle is degenerate, nothing is added
+     */
+    bool add(const Particles& p, std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d, float compliance);
+    void permute(const std::vector<std::uint32_t>& order);
+    /**
+     * Remove hinge i in O(colours), the colours stay contiguous (see remove_colored)
+     * @param moved moved(from, to) is called for every hinge that changes place
+     */
+    template <typename Moved>
+    void remove(std::size_t i, Moved&& moved) {
+        remove_colored(color_offsets, size(), i, [&](std::size_t from, std::size_t to) {
+            move(from, to);
+            moved(from, to);
+        });
+        pop_back();
+    }
+
+    /**
+     * Root mean square and maximum of C
+     */
+    DistanceConstraints::Residual residual(const Particles& p) const;
+
+private:
+    void move(std::size_t from, std::size_t to);
+    void pop_back();
+};
+}
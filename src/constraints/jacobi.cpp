@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Contains the implementation of class JacobiSolver.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/jacobi.h"
+#include <cmath>
+
+namespace cloth{
+
+static constexpr std::size_t particle_grain = 2048;
+static constexpr std::size_t constraint_grain = 2048;
+
+void JacobiSolver::invalidate() {
+    offsets.clear();
+    entries.clear();
+}
+
+void JacobiSolver::build_adjacency(const DistanceConstraints& cs, std::size_t particle_count) {
+    const std::size_t n = cs.size();
+    offsets.assign(particle_count + 1, 0);
+    for (std::size_t c=0; c<n; ++c) {
+        ++offsets[cs.first(c) + 1];
+        ++offsets[cs.second(c) + 1];
+    }
+    for (std::size_t i=0; i<particle_count; ++i)
+        offsets[i + 1] += offsets[i];
+
+    entries.resize(2 * n);
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t c=0; c<n; ++c) {
+        entries[fill[cs.first(c)]++] = static_cast<std::uint32_t>(c << 1);
+        entries[fill[cs.second(c)]++] = static_cast<std::uint32_t>((c << 1) | 1);
+    }
+
+    cx.resize(n);
+    cy.resize(n);
+    cz.resize(n);
+    active.resize(n);
+}
+
+void JacobiSolver::solve(Particles& p, const DistanceConstraints& cs, float timeStep, float relaxation, ThreadPool* pool) {
+    const std::size_t n = cs.size();
+    if (offsets.size() != p.size() + 1 || entries.size() != 2 * n)
+        build_adjacency(cs, p.size());
+
+    float* x = p.x.data();
+    float* y = p.y.data();
+    float* z = p.z.data();
+    const float* w = p.w.data();
+    const float* rest = cs.rest_dist.data();
+    const float* compliance = cs.compliance.data();
+
+    /** corrections, every constraint reads the positions of the previous iteration **/
+    cs.with_indices([&](const auto* first, const auto* second) {
+        parallel_for(pool, 0, n, constraint_grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c=begin; c<end; ++c) {
+                active[c] = 0;
+                const auto a = first[c];
+                const auto b = second[c];
+                const float wsum = w[a] + w[b];
+                if (wsum == 0.0)
+                    continue;
+                float dx = x[a] - x[b];
+                float dy = y[a] - y[b];
+                float dz = z[a] - z[b];
+                float abs_distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                if (abs_distance == 0.0)
+                    continue;
+                float inv = 1 / abs_distance;
+                float alpha = compliance[c] / timeStep / timeStep;
+                float s = -(abs_distance - rest[c]) / (wsum + alpha);
+                cx[c] = dx * inv * s;
+                cy[c] = dy * inv * s;
+                cz[c] = dz * inv * s;
+                active[c] = 1;
+            }
+        });
+    });
+
+    /** averaged update, each particle gathers its own corrections in a fixed order **/
+    parallel_for(pool, 0, p.size(), particle_grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i=begin; i<end; ++i) {
+            if (w[i] == 0.0)
+                continue;
+            float sx = 0.0, sy = 0.0, sz = 0.0;
+            unsigned count = 0;
+            for (std::uint32_t k=offsets[i]; k<offsets[i + 1]; ++k) {
+                const std::uint32_t c = entries[k] >> 1;
+                if (!active[c])
+                    continue;
+                const float sign = (entries[k] & 1) ? -1.0f : 1.0f;
+                sx += sign * cx[c];
+                sy += sign * cy[c];
+                sz += sign * cz[c];
+                ++count;
+            }
+            if (count == 0)
+                continue;
+            const float scale = relaxation * w[i] / static_cast<float>(count);
+            x[i] += sx * scale;
+            y[i] += sy * scale;
+            z[i] += sz * scale;
+        }
+    });
+}
+}
@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @brief Contains the class JacobiSolver, the averaged (Jacobi) projection of distance constraints.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "node/particles.h"
+#include "node/aligned_allocator.h"
+#include "constraints/d_constr.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class JacobiSolver
+ * @brief Jacobi iteration over a DistanceConstraints set with the averaging of Macklin et al.:
+ * every constraint computes its correction from the same positions, then each particle moves by
+ * relaxation * (sum of its corrections) / (number of corrections).
+ * The per-particle sums are gathered through a particle -> constraint table built once, always in
+ * the same order, so the result is bitwise identical for any number of threads.
+ */
+class JacobiSolver
+{
+public:
+    /**
+     * Forget the particle -> constraint table, must be called when the constraint set changes
+     */
+    void invalidate();
+
+    /**
+     * One Jacobi iteration over cs
+     * @param p particles
+     * @param cs constraint set
+     * @param timeStep substep length
+     * @param relaxation over-relaxation factor (1 is plain averaging, Macklin suggests values in [1, 2])
+     * @param pool worker pool, may be null
+     */
+    void solve(Particles& p, const DistanceConstraints& cs, float timeStep, float relaxation, ThreadPool* pool);
+
+private:
+    void build_adjacency(const DistanceConstraints& cs, std::size_t particle_count);
+
+    /**
+     * Offsets (one per particle, plus the total) into entries
+    */
+    std::vector<std::uint32_t> offsets;
+    /**
+     * Incident constraints of each particle as constraint_index * 2 + side (0 first, 1 second)
+    */
+    std::vector<std::uint32_t> entries;
+    /**
+     * Correction direction scaled by the constraint multiplier, per constraint
+    */
+    aligned_vector<float> cx, cy, cz;
+    /**
+     * 1 when the constraint produced a correction in this iteration
+    */
+    std::vector<std::uint8_t> active;
+};
+}
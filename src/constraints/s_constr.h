@@ -1,6 +1,6 @@
 /**
  * @file
- * @brief Contains the struct StretchConstraint.
+ * @brief Contains the struct StretchConstraints.
  * @author Davide Furlani
  * @version 0.1
  * @date January, 2023
@@ -8,26 +8,19 @@
  */
 
 #pragma once
-#include <utility>
-#include "node/node.h"
+#include <ostream>
+#include "constraints/d_constr.h"
 
 namespace cloth{
-struct StretchConstraint
+/**
+ * @struct StretchConstraints
+ * @brief Stretching constraints of a cloth, distance constraints between neighbouring nodes.
+ */
+struct StretchConstraints : public DistanceConstraints
 {   
-    /**
-     * Node pair on which a stretching constraint is set
-    */
-    std::pair<Node&, Node&> nodes;
-    /**
-     * Distance between nodes at rest
-    */
-    float rest_dist;
-//    float compliance = 0.0000005; // più piccolo di 0.0000005 comincia a rompersi
-    float compliance = 0.0;
-    StretchConstraint(Node& node1, Node& node2);
-    StretchConstraint(Node& node1, Node& node2, float compliance);
-    StretchConstraint(Node& node1, Node& node2, float compliance, float rest_distance);
+//    static constexpr float default_compliance = 0.0000005; // più piccolo di 0.0000005 comincia a rompersi
+    static constexpr float default_compliance = 0.0;
 
-    friend std::ostream& operator<<(std::ostream& os, const StretchConstraint& s);
+    friend std::ostream& operator<<(std::ostream& os, const StretchConstraints& s);
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief Contains the implementation of class LongRangeAttachments.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "constraints/tethers.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace cloth{
+
+// minimum number of tethers handed to a thread
+static constexpr std::size_t tether_grain = 4096;
+
+void LongRangeAttachments::clear() {
+    anchors.clear();
+    offsets.clear();
+    particle.clear();
+    length.clear();
+}
+
+void LongRangeAttachments::build(const Particles& p, const DistanceConstraints& edges) {
+    clear();
+    const std::size_t n = p.size();
+    for (std::size_t i=0; i<n; ++i)
+        if (p.w[i] == 0.0f)
+            anchors.push_back(static_cast<std::uint32_t>(i));
+    if (anchors.empty() || edges.empty())
+        return;
+    
+    // undirected graph in compressed rows: the neighbours of i are next[start[i] .. start[i+1])
+    std::vector<std::uint32_t> start(n + 1, 0);
+    std::vector<std::uint32_t> next(2 * edges.size());
+    std::vector<float> weight(2 * edges.size());
+    edges.with_indices([&](const auto* first, const auto* second) {
+        for (std::size_t e=0; e<edges.size(); ++e) {
+            ++start[first[e] + 1];
+            ++start[second[e] + 1];
+        }
+        for (std::size_t i=0; i<n; ++i)
+            start[i + 1] += start[i];
+        std::vector<std::uint32_t> fill(start.begin(), start.end() - 1);
+        for (std::size_t e=0; e<edges.size(); ++e) {
+            const std::uint32_t a = first[e], b = second[e];
+            next[fill[a]] = b;
+            weight[fill[a]++] = edges.rest_dist[e];
+            next[fill[b]] = a;
+            weight[fill[b]++] = edges.rest_dist[e];
+        }
+    });
+    
+    // Dijkstra from every anchor, the heap is kept in a vector reused across anchors
+    using Entry = std::pair<float, std::uint32_t>;
+    const auto later = std::greater<Entry>();
+    std::vector<float> dist(n);
+    std::vector<Entry> heap;
+    offsets.reserve(anchors.size() + 1);
+    offsets.push_back(0);
+    for (const std::uint32_t anchor : anchors) {
+        std::fill(dist.begin(), dist.end(), std::numeric_limits<float>::infinity());
+        dist[anchor] = 0.0f;
+        heap.assign(1, {0.0f, anchor});
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            const auto [d, i] = heap.back();
+            heap.pop_back();
+            if (d > dist[i])
+                continue;
+            for (std::uint32_t k=start[i]; k<start[i + 1]; ++k) {
+                const float nd = d + weight[k];
+                if (nd < dist[next[k]]) {
+                    dist[next[k]] = nd;
+                    heap.push_back({nd, next[k]});
+                    std::push_heap(heap.begin(), heap.end(), later);
+                }
+            }
+        }
+        for (std::size_t i=0; i<n; ++i) {
+            if (p.w[i] == 0.0f || std::isinf(dist[i]))
+                continue;
+            particle.push_back(static_cast<std::uint32_t>(i));
+            length.push_back(dist[i]);
+        }
+        offsets.push_back(static_cast<std::uint32_t>(particle.size()));
+    }
+}
+
+void LongRangeAttachments::solve(Particles& p, ThreadPool* pool) const {
+    float* x = p.x.data();
+    float* y = p.y.data();
+    float* z = p.z.data();
+    for (std::size_t g=0; g<anchors.size(); ++g) {
+        const float ax = x[anchors[g]], ay = y[anchors[g]], az = z[anchors[g]];
+        parallel_for(pool, offsets[g], offsets[g + 1], tether_grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t t=begin; t<end; ++t) {
+                const std::uint32_t i = particle[t];
+                const float dx = x[i] - ax, dy = y[i] - ay, dz = z[i] - az;
+                const float d2 = dx*dx + dy*dy + dz*dz;
+                if (d2 <= length[t] * length[t])
+                    continue;
+                const float s = length[t] / std::sqrt(d2);
+                x[i] = ax + dx * s;
+                y[i] = ay + dy * s;
+                z[i] = az + dz * s;
+            }
+        });
+    }
+}
+
+double LongRangeAttachments::overshoot(const Particles& p) const {
+    double worst = 0.0;
+    for (std::size_t g=0; g<anchors.size(); ++g)
+        for (std::uint32_t t=offsets[g]; t<offsets[g + 1]; ++t)
+            if (length[t] > 0.0f)
+                worst = std::max(worst, static_cast<double>((p.distance(anchors[g], particle[t]) - length[t]) / length[t]));
+    return worst;
+}
+}
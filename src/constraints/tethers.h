@@ -0,0 +1,68 @@
+/**
+ * @file
+ * @brief Contains the class LongRangeAttachments, unilateral tethers from the pinned nodes.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "node/particles.h"
+#include "constraints/d_constr.h"
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+/**
+ * @class LongRangeAttachments
+ * @brief Long range attachments (Kim, Chentanez and Muller-Fischer 2012): every free node may not
+ * get farther from a pinned node than their geodesic distance at rest. A Gauss-Seidel sweep moves a
+ * stretch one edge per iteration, a tether pulls the far end of a hanging cloth back at once.
+ *
+ * Tethers are grouped by anchor: the tethers of a group move distinct particles, so a group is
+ * projected in parallel, and the anchors are pinned, so only the tethered particle moves.
+ */
+class LongRangeAttachments
+{
+public:
+    /**
+     * Pinned node of every group
+    */
+    std::vector<std::uint32_t> anchors;
+    /**
+     * Start offset of every group, plus the total as last element
+    */
+    std::vector<std::uint32_t> offsets;
+    /**
+     * Tethered particle and its largest distance from the anchor of its group
+    */
+    std::vector<std::uint32_t> particle;
+    std::vector<float> length;
+
+    std::size_t size() const { return particle.size(); }
+    bool empty() const { return particle.empty(); }
+    void clear();
+
+    /**
+     * Rebuild the tethers from every node with w = 0. The geodesic distances are shortest paths
+     * over the edges of the distance constraints, weighted by their rest lengths; nodes not
+     * connected to an anchor get no tether to it.
+     * @param p particles, the anchors are read from w
+     * @param edges constraint graph, usually the stretch constraints
+     */
+    void build(const Particles& p, const DistanceConstraints& edges);
+    /**
+     * Project every tethered particle that is too far from its anchor back onto the sphere of
+     * radius length; tethers are never compressed.
+     */
+    void solve(Particles& p, ThreadPool* pool) const;
+    /**
+     * Largest relative excess of a tethered distance over its length, 0 when every tether is
+     * slack. It bounds how far a node is from its anchors, not the stretch of the edges in between.
+     */
+    double overshoot(const Particles& p) const;
+};
+}
@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @brief Contains the implementation of class ClothPipeline.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+#include "cloth_pipeline.h"
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include "display/display.h"
+
+namespace render {
+
+    ClothPipeline::ClothPipeline(const State& s) {
+        multi_draw = multi_draw_indirect_proc();
+
+        shader.use();
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)s.scr_width / (float)s.scr_height, 0.1f, 100.0f);
+        shader.setMat4("uniProjMatrix", projection);
+        shader.setMat4("uniModelMatrix", glm::mat4(1.0f));
+
+        shader.setInt("uniTex", 0);
+        shader.setVec3("uniLightPos", glm::vec3(0.0, 0.0, 1.0));
+        shader.setVec3("uniLightColor", glm::vec3(1.0, 1.0, 1.0));
+    }
+
+    unsigned ClothPipeline::texture(const std::filesystem::path& path) {
+        auto found = textures.find(path.string());
+        if (found != textures.end())
+            return found->second;
+        std::filesystem::path p = path;
+        const unsigned t = load_textures(p);
+        textures.emplace(path.string(), t);
+        return t;
+    }
+
+    void ClothPipeline::use(Camera& c, unsigned texture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        shader.use();
+        glm::mat4 view = glm::lookAt(c.pos, c.pos + c.front_v, c.up_v);
+        shader.setMat4("uniViewMatrix", view);
+    }
+
+    void ClothPipeline::free_resources() {
+        for (auto& [path, t] : textures)
+            glDeleteTextures(1, &t);
+        textures.clear();
+        shader.destroy();
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @brief Contains the class ClothPipeline.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <filesystem>
+#include <map>
+#include <string>
+#include <glad.h>
+#include "display/camera.h"
+#include "display/shader.h"
+#include "state/state.h"
+
+namespace render {
+    /**
+     * @class ClothPipeline
+     * @brief GL state shared by every cloth drawn: the cloth program, compiled once, and the
+     * textures, each loaded once whatever the number of cloths using it. It outlives the
+     * ClothRenderer and Scene objects drawing with it.
+     */
+    class ClothPipeline {
+    public:
+        static constexpr const char* default_texture = "resources/Textures/tex1.jpg";
+
+        Shader shader {"resources/Shaders/ClothVS.glsl", "resources/Shaders/ClothFS.glsl"};
+        /**
+         * glMultiDrawElementsIndirect (GL 4.3 or ARB_multi_draw_indirect), null when not available
+         */
+        PFNGLMULTIDRAWELEMENTSINDIRECTPROC multi_draw = nullptr;
+
+        explicit ClothPipeline(const State& s);
+
+        /**
+         * Texture of the image at path, loaded on first use
+         */
+        unsigned texture(const std::filesystem::path& path);
+
+        /**
+         * Bind the program and texture for the next draws and set the camera of the frame
+         */
+        void use(Camera& c, unsigned texture);
+
+        void free_resources();
+
+    private:
+        std::map<std::string, unsigned> textures;
+    };
+}
@@ -0,0 +1,131 @@
+/**
+ * @file
+ * @brief Contains the implementation of class ClothRenderer.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glad.h>
+#include <glm.hpp>
+#include "cloth_renderer.h"
+#include "cloth/vertex_data.h"
+
+namespace render {
+
+    ClothRenderer::ClothRenderer(cloth::Cloth& cloth, ClothPipeline& pipeline) : cloth(cloth), pipeline(pipeline) {
+
+        const std::size_t nodes = cloth.particles.size();
+        uploaded_nodes = node_capacity = nodes;
+        journal_read = cloth.tearing.changed_triangles.size();
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &uv_VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+
+        // topology, static
+        std::vector<unsigned> indices = cloth::triangle_indices(cloth);
+        index_count = indices.size();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+
+        // uv, static
+        glBindBuffer(GL_ARRAY_BUFFER, uv_VBO);
+        glBufferData(GL_ARRAY_BUFFER, nodes * sizeof(glm::vec2), cloth.uvs.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(2);
+
+        // position + normal, streamed through the ring
+        stream.create(nodes * cloth::stream_vertex_floats * sizeof(float));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+
+        cloth::write_stream_vertices(cloth, stream.begin_region());
+        end_region();
+
+        texture = pipeline.texture(ClothPipeline::default_texture);
+    }
+
+    void ClothRenderer::end_region() {
+        const std::size_t offset = stream.end_region();
+        const GLsizei stride = cloth::stream_vertex_floats * sizeof(float);
+        glBindVertexArray(VAO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 3*sizeof(float)));
+    }
+
+    void ClothRenderer::sync_tears() {
+
+        const std::size_t nodes = cloth.particles.size();
+        if (nodes > node_capacity) {
+            // room for a few more tears, the uvs are uploaded again below
+            node_capacity = std::max(nodes, node_capacity + node_capacity / 2);
+            uploaded_nodes = 0;
+            glBindBuffer(GL_ARRAY_BUFFER, uv_VBO);
+            glBufferData(GL_ARRAY_BUFFER, node_capacity * sizeof(glm::vec2), nullptr, GL_STATIC_DRAW);
+            stream.free_resources();
+            stream.create(node_capacity * cloth::stream_vertex_floats * sizeof(float));
+        }
+        if (nodes > uploaded_nodes) {
+            glBindBuffer(GL_ARRAY_BUFFER, uv_VBO);
+            glBufferSubData(GL_ARRAY_BUFFER, uploaded_nodes * sizeof(glm::vec2), (nodes - uploaded_nodes) * sizeof(glm::vec2),
+                            cloth.uvs.data() + uploaded_nodes);
+            uploaded_nodes = nodes;
+        }
+
+        const std::vector<std::uint32_t>& journal = cloth.tearing.changed_triangles;
+        if (journal_read == journal.size())
+            return;
+        std::vector<std::uint32_t> changed(journal.begin() + journal_read, journal.end());
+        journal_read = journal.size();
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        // one upload per run of consecutive triangles
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        for (std::size_t first=0; first<changed.size();) {
+            std::size_t last = first + 1;
+            while (last < changed.size() && changed[last] == changed[last - 1] + 1)
+                ++last;
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, changed[first] * 3 * sizeof(unsigned), (last - first) * 3 * sizeof(unsigned),
+                            cloth.tri_indices() + 3 * changed[first]);
+            first = last;
+        }
+    }
+
+    void ClothRenderer::render(Camera& c) {
+
+        sync_tears();
+        cloth::write_stream_vertices(cloth, stream.begin_region());
+        end_region();
+        draw(c);
+    }
+
+    void ClothRenderer::render(Camera& c, const cloth::Snapshot& s) {
+
+        face_normals.resize(cloth.all_tris.size());
+        cloth::write_stream_vertices(cloth, s.x.data(), s.y.data(), s.z.data(), face_normals.data(), stream.begin_region(), nullptr);
+        end_region();
+        draw(c);
+    }
+
+    void ClothRenderer::draw(Camera& c) {
+
+        pipeline.use(c, texture);
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, (void*)0);
+        stream.fence();
+    }
+
+    void ClothRenderer::free_resources() {
+        stream.free_resources();
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &uv_VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+}
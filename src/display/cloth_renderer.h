@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Contains the definition of class ClothRenderer.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <glad.h>
+#include "cloth/cloth.h"
+#include "cloth/snapshot.h"
+#include "display/cloth_pipeline.h"
+#include "display/stream_buffer.h"
+#include "display/camera.h"
+#include "state/state.h"
+
+namespace render {
+    /**
+     * @class ClothRenderer
+     * @brief OpenGL view of a single cloth::Cloth. It owns the buffers of the cloth and reads the
+     * simulation state at draw time, the cloth itself never calls into GL; the program and the
+     * texture come from a shared ClothPipeline. Several cloths are better drawn by a render::Scene,
+     * with one draw call for all of them.
+     *
+     * Topology (index buffer) and uv coordinates are uploaded once. Positions and normals are
+     * streamed every frame, one vertex per particle, through a StreamBuffer. When the cloth tears,
+     * render(Camera&) uploads only the triangles the tear journal lists since the last frame and the
+     * uvs of the new particles; the buffers grow geometrically.
+     *
+     * render(Camera&, const Snapshot&) draws positions handed over by a cloth::SimulationThread;
+     * only the constant topology of the cloth is read then, so it is safe while the cloth is being
+     * simulated on another thread.
+     */
+    class ClothRenderer {
+    public:
+        cloth::Cloth& cloth;
+
+        unsigned VAO, uv_VBO, EBO;
+        unsigned int texture;
+
+        ClothRenderer(cloth::Cloth& cloth, ClothPipeline& pipeline);
+
+        /**
+         * Draw the current state of the cloth
+         */
+        void render(Camera& c);
+        /**
+         * Draw the cloth with the positions of s. Normals are computed on the calling thread, the
+         * pool of the cloth belongs to the simulation.
+         */
+        void render(Camera& c, const cloth::Snapshot& s);
+
+        void free_resources();
+
+    private:
+        /**
+         * Point the position/normal attributes to the region just written
+         */
+        void end_region();
+        /**
+         * Draw the region just written and fence it
+         */
+        void draw(Camera& c);
+        /**
+         * Upload what the tears since the last frame changed
+         */
+        void sync_tears();
+
+        ClothPipeline& pipeline;
+        StreamBuffer stream;
+        std::size_t index_count;
+        /**
+         * Particles with an uploaded uv, particles the buffers have room for, and entries of the
+         * tear journal already uploaded
+         */
+        std::size_t uploaded_nodes, node_capacity, journal_read;
+        std::vector<glm::vec3> face_normals;
+    };
+}
@@ -11,11 +11,11 @@
 #include <glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <string>
 #include <stb_image.h>
 #include "state/state.h"
 #include "display/camera.h" // TODO camera farà parte della scena
 //#include "display/scene.h"
-#include "cloth/cloth.h"
 #include "display/shader.h"
 
 
@@ -60,6 +60,47 @@ namespace render {
         process_camera_movement(window, state, camera);
     }
     
+    void process_sim_input(GLFWwindow* window, const State& state, const cloth::Cloth& cloth,
+                           std::vector<cloth::SimEvent>& events) {
+        static const int keys[] = {GLFW_KEY_1, GLFW_KEY_2, GLFW_KEY_C, GLFW_KEY_T, GLFW_KEY_Z, GLFW_KEY_R};
+        static bool was_down[6] = {};
+        for (int k=0; k<6; ++k) {
+            const bool down = glfwGetKey(window, keys[k]) == GLFW_PRESS;
+            const bool pressed = down && !was_down[k];
+            was_down[k] = down;
+            if (!pressed)
+                continue;
+            switch (k) {
+                case 0:
+                    events.push_back(cloth.particles.w.at(cloth.pin1_index) == 0.0f
+                                     ? cloth::SimEvent::unpin(cloth::EventType::Unpin1)
+                                     : cloth::SimEvent::pin(cloth::EventType::Pin1, cloth.pin1_index));
+                    break;
+                case 1:
+                    events.push_back(cloth.particles.w.at(cloth.pin2_index) == 0.0f
+                                     ? cloth::SimEvent::unpin(cloth::EventType::Unpin2)
+                                     : cloth::SimEvent::pin(cloth::EventType::Pin2, cloth.pin2_index));
+                    break;
+                case 2:
+                    events.push_back(cloth::SimEvent::setting_change(cloth::SettingId::SelfCollision,
+                                                                     state.self_collision ? 0.0f : 1.0f));
+                    break;
+                case 3:
+                    events.push_back(cloth::SimEvent::setting_change(cloth::SettingId::LongRangeAttachments,
+                                                                     state.long_range_attachments ? 0.0f : 1.0f));
+                    break;
+                case 4:
+                    events.push_back(cloth::SimEvent::setting_change(cloth::SettingId::Sleeping,
+                                                                     state.sleeping ? 0.0f : 1.0f));
+                    break;
+                case 5:
+                    events.push_back(cloth::SimEvent::setting_change(cloth::SettingId::Tearing,
+                                                                     state.tearing ? 0.0f : 1.0f));
+                    break;
+            }
+        }
+    }
+
     GLFWwindow *getWindow(int width, int height) {
         //creo la finestra
         glfwInit();
@@ -101,28 +142,6 @@ namespace render {
         glEnable(GL_MULTISAMPLE);
     }
 
-    vertex_buffer load_vertices(cloth::Cloth& cloth){
-        unsigned int VBO, VAO;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-
-        glBindVertexArray(VAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(&cloth.get_GL_tris()[0]), &cloth.get_GL_tris()[0], GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3*sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6*sizeof(float)));
-        glEnableVertexAttribArray(2);
-        
-        return vertex_buffer{VAO, VBO};
-    }
-
     Shader load_shaders(std::filesystem::path& vert_p, std::filesystem::path& frag_p){
         return Shader(&vert_p.string()[0], &frag_p.string()[0]);
     }
@@ -158,4 +177,32 @@ namespace render {
         
         return texture;
     }
-}
\ No newline at end of file
+
+    bool gl_supports(int major, int minor, const char* extension) {
+        GLint ctx_major = 0, ctx_minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &ctx_major);
+        glGetIntegerv(GL_MINOR_VERSION, &ctx_minor);
+        if (ctx_major > major || (ctx_major == major && ctx_minor >= minor))
+            return true;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i=0; i<count; ++i) {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (name && std::string(name) == extension)
+                return true;
+        }
+        return false;
+    }
+
+    PFNGLBUFFERSTORAGEPROC buffer_storage_proc() {
+        if (!gl_supports(4, 4, "GL_ARB_buffer_storage"))
+            return nullptr;
+        return reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(glfwGetProcAddress("glBufferStorage"));
+    }
+
+    PFNGLMULTIDRAWELEMENTSINDIRECTPROC multi_draw_indirect_proc() {
+        if (!gl_supports(4, 3, "GL_ARB_multi_draw_indirect"))
+            return nullptr;
+        return reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTPROC>(glfwGetProcAddress("glMultiDrawElementsIndirect"));
+    }
+}
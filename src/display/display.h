@@ -11,17 +11,14 @@
 #include <glad.h>
 #include <GLFW/glfw3.h>
 #include <filesystem>
+#include <vector>
+#include "cloth/cloth.h"
+#include "cloth/replay.h"
 #include "state/state.h"
 #include "display/camera.h"
-#include "cloth/cloth.h"
 #include "display/shader.h"
 
 namespace render{
-    
-    struct vertex_buffer{
-        unsigned int VAO;
-        unsigned int VBO;
-    };
 
     void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
@@ -34,15 +31,39 @@ namespace render{
     bool should_close(GLFWwindow* window);
 
     void processInput(GLFWwindow* window, State& state, Camera& camera);
+
+    /**
+     * Keys that change the simulation, turned into events instead of being applied, so that the
+     * caller can record them: 1 and 2 pin / unpin the two pinned nodes, C toggles the self collision
+     * and T the long range attachments, Z toggles sleeping and R tearing. A key gives one event when
+     * it is pressed, not while held.
+     */
+    void process_sim_input(GLFWwindow* window, const State& state, const cloth::Cloth& cloth,
+                           std::vector<cloth::SimEvent>& events);
     
     GLFWwindow* getWindow(int width, int height);
     
     void set_GL_parameters();
 
-    vertex_buffer load_vertices(cloth::Cloth& cloth);
-
     [[nodiscard]] Shader load_shaders(std::filesystem::path& vert_p, std::filesystem::path& frag_p);
 
     unsigned int load_textures(std::filesystem::path& texture);
 
+    /**
+     * True when the current context is at least GL major.minor or exposes extension
+     */
+    bool gl_supports(int major, int minor, const char* extension);
+
+    /**
+     * glBufferStorage (GL 4.4 or ARB_buffer_storage) of the current context, null when not available.
+     * The bundled glad loader only resolves GL 3.3 entry points, newer ones are looked up here.
+     */
+    PFNGLBUFFERSTORAGEPROC buffer_storage_proc();
+
+    /**
+     * glMultiDrawElementsIndirect (GL 4.3 or ARB_multi_draw_indirect) of the current context, null
+     * when not available
+     */
+    PFNGLMULTIDRAWELEMENTSINDIRECTPROC multi_draw_indirect_proc();
+
 }
\ No newline at end of file
@@ -7,3 +7,151 @@
  * @copyright 2023 Davide Furlani
  */
 #include "scene.h"
+#include <algorithm>
+#include <glad.h>
+#include <glm.hpp>
+#include "cloth/vertex_data.h"
+
+namespace render {
+
+    Scene::Scene(cloth::Scene& cloths, ClothPipeline& pipeline) : cloths(cloths), pipeline(pipeline) {
+
+        for (std::size_t k=0; k<cloths.size(); ++k)
+            slots.push_back(cloths.cloth(k).particles.size());
+        upload();
+        texture = pipeline.texture(ClothPipeline::default_texture);
+    }
+
+    void Scene::upload() {
+
+        // one command per cloth; the indices stay local to their cloth, base_vertex moves them
+        std::vector<unsigned> indices;
+        std::vector<glm::vec2> uvs;
+        commands.clear();
+        uploaded_nodes.clear();
+        journal_read.clear();
+        for (std::size_t k=0; k<cloths.size(); ++k) {
+            const cloth::Cloth& c = cloths.cloth(k);
+            std::vector<unsigned> local = cloth::triangle_indices(c);
+            commands.push_back({static_cast<std::uint32_t>(local.size()), 1, static_cast<std::uint32_t>(indices.size()),
+                                static_cast<std::int32_t>(uvs.size()), 0});
+            indices.insert(indices.end(), local.begin(), local.end());
+            uvs.insert(uvs.end(), c.uvs.begin(), c.uvs.end());
+            uvs.resize(uvs.size() + slots[k] - c.uvs.size());
+            uploaded_nodes.push_back(c.uvs.size());
+            journal_read.push_back(c.tearing.changed_triangles.size());
+        }
+
+        if (VAO == 0) {
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &uv_VBO);
+            glGenBuffers(1, &EBO);
+        } else {
+            stream.free_resources();
+        }
+
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, uv_VBO);
+        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), uvs.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(2);
+
+        stream.create(uvs.size() * cloth::stream_vertex_floats * sizeof(float));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+
+        if (pipeline.multi_draw) {
+            if (indirect_buffer == 0)
+                glGenBuffers(1, &indirect_buffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+
+    void Scene::sync_tears() {
+
+        bool outgrown = false;
+        for (std::size_t k=0; k<cloths.size(); ++k) {
+            const std::size_t nodes = cloths.cloth(k).particles.size();
+            if (nodes > slots[k]) {
+                slots[k] = std::max(nodes, slots[k] + slots[k] / 2);
+                outgrown = true;
+            }
+        }
+        if (outgrown) {
+            upload();
+            return;
+        }
+        glBindVertexArray(VAO);
+        for (std::size_t k=0; k<cloths.size(); ++k) {
+            const cloth::Cloth& c = cloths.cloth(k);
+            const std::size_t nodes = c.particles.size();
+            if (nodes > uploaded_nodes[k]) {
+                glBindBuffer(GL_ARRAY_BUFFER, uv_VBO);
+                glBufferSubData(GL_ARRAY_BUFFER, (commands[k].base_vertex + uploaded_nodes[k]) * sizeof(glm::vec2),
+                                (nodes - uploaded_nodes[k]) * sizeof(glm::vec2), c.uvs.data() + uploaded_nodes[k]);
+                uploaded_nodes[k] = nodes;
+            }
+            const std::vector<std::uint32_t>& journal = c.tearing.changed_triangles;
+            if (journal_read[k] == journal.size())
+                continue;
+            std::vector<std::uint32_t> changed(journal.begin() + journal_read[k], journal.end());
+            journal_read[k] = journal.size();
+            std::sort(changed.begin(), changed.end());
+            changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+            // one upload per run of consecutive triangles
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+            for (std::size_t first=0; first<changed.size();) {
+                std::size_t last = first + 1;
+                while (last < changed.size() && changed[last] == changed[last - 1] + 1)
+                    ++last;
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (commands[k].first_index + 3 * changed[first]) * sizeof(unsigned),
+                                (last - first) * 3 * sizeof(unsigned), c.tri_indices() + 3 * changed[first]);
+                first = last;
+            }
+        }
+    }
+
+    void Scene::render(Camera& c) {
+
+        sync_tears();
+        float* out = stream.begin_region();
+        for (std::size_t k=0; k<cloths.size(); ++k)
+            cloth::write_stream_vertices(cloths.cloth(k), out + commands[k].base_vertex * cloth::stream_vertex_floats);
+        const std::size_t offset = stream.end_region();
+        const GLsizei stride = cloth::stream_vertex_floats * sizeof(float);
+        glBindVertexArray(VAO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 3*sizeof(float)));
+
+        pipeline.use(c, texture);
+        if (indirect_buffer) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+            pipeline.multi_draw(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, static_cast<GLsizei>(commands.size()), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            last_draw_calls = 1;
+        } else {
+            for (const DrawCommand& d : commands)
+                glDrawElementsBaseVertex(GL_TRIANGLES, d.count, GL_UNSIGNED_INT,
+                                         (void*)(d.first_index * sizeof(unsigned)), d.base_vertex);
+            last_draw_calls = commands.size();
+        }
+        stream.fence();
+    }
+
+    void Scene::free_resources() {
+        stream.free_resources();
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &uv_VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = 0;
+        if (indirect_buffer)
+            glDeleteBuffers(1, &indirect_buffer);
+        indirect_buffer = 0;
+    }
+}
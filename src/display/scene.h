@@ -7,11 +7,77 @@
  * @copyright 2023 Davide Furlani
  */
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "cloth/scene.h"
+#include "display/camera.h"
+#include "display/cloth_pipeline.h"
+#include "display/stream_buffer.h"
 
+namespace render {
+    /**
+     * @class Scene
+     * @brief OpenGL view of a cloth::Scene, drawn with a constant number of draw calls whatever
+     * the number of cloths. The vertices of every cloth are packed into one StreamBuffer region,
+     * their triangles into one index buffer and their uvs into one buffer; a draw command per
+     * cloth (its index range and first vertex) lives in an indirect buffer, and the whole scene is
+     * one glMultiDrawElementsIndirect. Without GL 4.3 the same commands are issued one
+     * glDrawElementsBaseVertex each.
+     *
+     * A cloth that tears has its changed triangles and new uvs uploaded in place; the vertices of a
+     * cloth have a slot with some room to spare, and every buffer is built again only when a cloth
+     * outgrows its slot.
+     */
+    class Scene {
+    public:
+        cloth::Scene& cloths;
 
+        Scene(cloth::Scene& cloths, ClothPipeline& pipeline);
 
-class scene {
+        /**
+         * Draw the current state of every cloth
+         */
+        void render(Camera& c);
 
-};
+        /**
+         * Draw calls issued by the last render
+         */
+        std::size_t draw_calls() const { return last_draw_calls; }
 
+        void free_resources();
 
+    private:
+        /**
+         * Layout of GL's DrawElementsIndirectCommand
+         */
+        struct DrawCommand {
+            std::uint32_t count;
+            std::uint32_t instance_count;
+            std::uint32_t first_index;
+            std::int32_t base_vertex;
+            std::uint32_t base_instance;
+        };
+
+        /**
+         * (Re)build every buffer from the cloths, with a vertex slot of slots[k] for cloth k
+         */
+        void upload();
+        /**
+         * Upload what the tears since the last frame changed, rebuild when a cloth outgrows its slot
+         */
+        void sync_tears();
+
+        ClothPipeline& pipeline;
+        StreamBuffer stream;
+        unsigned VAO = 0, uv_VBO, EBO, indirect_buffer = 0;
+        /**
+         * Per cloth: vertices of its slot, particles with an uploaded uv, entries of its tear
+         * journal already uploaded
+         */
+        std::vector<std::size_t> slots, uploaded_nodes, journal_read;
+        unsigned texture;
+        std::vector<DrawCommand> commands;
+        std::size_t last_draw_calls = 0;
+    };
+}
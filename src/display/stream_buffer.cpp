@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Contains the implementation of class StreamBuffer.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+#include "stream_buffer.h"
+#include "display/display.h"
+
+namespace render {
+
+    void StreamBuffer::create(std::size_t bytes) {
+        region_bytes = bytes;
+        PFNGLBUFFERSTORAGEPROC buffer_storage = buffer_storage_proc();
+        persistent = buffer_storage != nullptr;
+
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        if (persistent) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            buffer_storage(GL_ARRAY_BUFFER, ring_size * region_bytes, nullptr, flags);
+            mapped = static_cast<float*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, ring_size * region_bytes, flags));
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, ring_size * region_bytes, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    float* StreamBuffer::begin_region() {
+        if (fences[region]) {
+            // normally signalled long ago, the ring is two frames ahead of this region
+            while (glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        }
+        const std::size_t offset = region * region_bytes;
+        if (persistent)
+            return mapped + offset / sizeof(float);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        return static_cast<float*>(glMapBufferRange(GL_ARRAY_BUFFER, offset, region_bytes,
+                                                    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+    }
+
+    std::size_t StreamBuffer::end_region() {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        if (!persistent)
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        return region * region_bytes;
+    }
+
+    void StreamBuffer::fence() {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % ring_size;
+    }
+
+    void StreamBuffer::free_resources() {
+        for (auto& f : fences) {
+            if (f)
+                glDeleteSync(f);
+            f = nullptr;
+        }
+        if (persistent && mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            mapped = nullptr;
+        }
+        glDeleteBuffers(1, &VBO);
+        VBO = 0;
+    }
+}
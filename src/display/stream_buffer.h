@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @brief Contains the class StreamBuffer.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <glad.h>
+
+namespace render {
+    /**
+     * @class StreamBuffer
+     * @brief Vertex buffer rewritten every frame through a ring of ring_size regions of a single
+     * buffer: the CPU writes region k while the GPU may still read the previous ones, and a fence
+     * per region tells when it can be reused. With buffer storage (GL 4.4) the buffer is
+     * persistently mapped, otherwise each region is mapped unsynchronized for the time of the write.
+     */
+    class StreamBuffer {
+    public:
+        static constexpr int ring_size = 3;
+
+        unsigned VBO = 0;
+
+        /**
+         * Create the buffer, region_bytes for every region of the ring
+         */
+        void create(std::size_t region_bytes);
+        /**
+         * Wait until the GPU is done with the current region and return where to write it
+         */
+        float* begin_region();
+        /**
+         * Make the written region visible to GL, the buffer is left bound to GL_ARRAY_BUFFER
+         * @return offset of the region in the buffer, in bytes
+         */
+        std::size_t end_region();
+        /**
+         * Fence the region once the draws reading it are issued and move to the next one
+         */
+        void fence();
+
+        void free_resources();
+
+    private:
+        std::size_t region_bytes = 0;
+        bool persistent = false;
+        float* mapped = nullptr;
+        GLsync fences[ring_size] = {};
+        int region = 0;
+    };
+}
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * @brief Contains the implementation of class CurlNoise.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "forces/curl_noise.h"
+#include <cmath>
+
+namespace cloth{
+
+namespace {
+
+constexpr std::size_t voxels = static_cast<std::size_t>(CurlNoise::size) * CurlNoise::size * CurlNoise::size;
+
+int wrap(int i, int n) {
+    return ((i % n) + n) % n;
+}
+
+std::size_t voxel(int i, int j, int k) {
+    constexpr int n = CurlNoise::size;
+    return (static_cast<std::size_t>(wrap(k, n)) * n + wrap(j, n)) * n + wrap(i, n);
+}
+
+/**
+ * Random value in [-1, 1] of a lattice point, the same on every platform
+ */
+float lattice(std::uint32_t seed, std::uint32_t channel, int i, int j, int k) {
+    constexpr int n = CurlNoise::cells;
+    std::uint64_t h = seed;
+    for (std::uint64_t v : {std::uint64_t(channel), std::uint64_t(wrap(i, n)), std::uint64_t(wrap(j, n)), std::uint64_t(wrap(k, n))}) {
+        h += v + 0x9e3779b97f4a7c15ull;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        h ^= h >> 31;
+    }
+    return static_cast<float>(h >> 40) / static_cast<float>(1ull << 23) - 1.0f;
+}
+
+float smooth(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+/**
+ * Periodic value noise of one channel of the potential at every voxel
+ */
+std::vector<float> potential(std::uint32_t seed, std::uint32_t channel) {
+    constexpr int n = CurlNoise::size;
+    constexpr float step = static_cast<float>(CurlNoise::cells) / n;
+    std::vector<float> out(voxels);
+    for (int k=0; k<n; ++k)
+        for (int j=0; j<n; ++j)
+            for (int i=0; i<n; ++i) {
+                const float x = i * step, y = j * step, z = k * step;
+                const int x0 = static_cast<int>(x), y0 = static_cast<int>(y), z0 = static_cast<int>(z);
+                const float fx = smooth(x - x0), fy = smooth(y - y0), fz = smooth(z - z0);
+                float v = 0.0f;
+                for (int c=0; c<8; ++c) {
+                    const int dx = c & 1, dy = (c >> 1) & 1, dz = c >> 2;
+                    const float weight = (dx ? fx : 1.0f - fx) * (dy ? fy : 1.0f - fy) * (dz ? fz : 1.0f - fz);
+                    v += weight * lattice(seed, channel, x0 + dx, y0 + dy, z0 + dz);
+                }
+                out[voxel(i, j, k)] = v;
+            }
+    return out;
+}
+}
+
+CurlNoise::CurlNoise(std::uint32_t seed) : vx(voxels), vy(voxels), vz(voxels) {
+    constexpr int n = size;
+    const std::vector<float> px = potential(seed, 0), py = potential(seed, 1), pz = potential(seed, 2);
+    // central differences, one voxel is 1 / n of a tile
+    const float h = 0.5f * n;
+    double energy = 0.0;
+    for (int k=0; k<n; ++k)
+        for (int j=0; j<n; ++j)
+            for (int i=0; i<n; ++i) {
+                const float dpz_dy = (pz[voxel(i, j+1, k)] - pz[voxel(i, j-1, k)]) * h;
+                const float dpy_dz = (py[voxel(i, j, k+1)] - py[voxel(i, j, k-1)]) * h;
+                const float dpx_dz = (px[voxel(i, j, k+1)] - px[voxel(i, j, k-1)]) * h;
+                const float dpz_dx = (pz[voxel(i+1, j, k)] - pz[voxel(i-1, j, k)]) * h;
+                const float dpy_dx = (py[voxel(i+1, j, k)] - py[voxel(i-1, j, k)]) * h;
+                const float dpx_dy = (px[voxel(i, j+1, k)] - px[voxel(i, j-1, k)]) * h;
+                const std::size_t v = voxel(i, j, k);
+                vx[v] = dpz_dy - dpy_dz;
+                vy[v] = dpx_dz - dpz_dx;
+                vz[v] = dpy_dx - dpx_dy;
+                energy += vx[v]*vx[v] + vy[v]*vy[v] + vz[v]*vz[v];
+            }
+    const float scale = energy > 0.0 ? static_cast<float>(1.0 / std::sqrt(energy / voxels)) : 0.0f;
+    for (std::size_t v=0; v<voxels; ++v) {
+        vx[v] *= scale;
+        vy[v] *= scale;
+        vz[v] *= scale;
+    }
+}
+
+glm::vec3 CurlNoise::sample(glm::vec3 p) const {
+    const glm::vec3 q = (p - glm::floor(p)) * static_cast<float>(size);
+    const int x0 = static_cast<int>(q.x), y0 = static_cast<int>(q.y), z0 = static_cast<int>(q.z);
+    const float fx = q.x - x0, fy = q.y - y0, fz = q.z - z0;
+    glm::vec3 v {0.0f};
+    for (int c=0; c<8; ++c) {
+        const int dx = c & 1, dy = (c >> 1) & 1, dz = c >> 2;
+        const float weight = (dx ? fx : 1.0f - fx) * (dy ? fy : 1.0f - fy) * (dz ? fz : 1.0f - fz);
+        const std::size_t s = voxel(x0 + dx, y0 + dy, z0 + dz);
+        v += weight * glm::vec3(vx[s], vy[s], vz[s]);
+    }
+    return v;
+}
+}
@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief Contains the class CurlNoise, a tileable divergence free 3D noise texture.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+
+namespace cloth{
+/**
+ * @class CurlNoise
+ * @brief Curl of a smooth random vector potential, precomputed on a periodic size^3 grid. The
+ * field is divergence free (up to the differencing), so it swirls without sources or sinks, and it
+ * tiles: sample() wraps its coordinates, one texture covers any domain. It is built once, the
+ * sampling is a trilinear lookup.
+ */
+class CurlNoise
+{
+public:
+    /**
+     * Samples per side of the texture
+    */
+    static constexpr int size = 32;
+    /**
+     * Lattice points per side of the random potential, the curl has features of size / cells samples
+    */
+    static constexpr int cells = 4;
+
+    /**
+     * Build the texture of seed, scaled to a unit root mean square speed
+     */
+    explicit CurlNoise(std::uint32_t seed = 1);
+
+    /**
+     * Velocity at p, in texture units (one tile per unit), wrapped around
+     */
+    glm::vec3 sample(glm::vec3 p) const;
+
+private:
+    std::vector<float> vx, vy, vz;
+};
+}
@@ -0,0 +1,65 @@
+/**
+ * @file
+ * @brief Contains the implementation of the wind sources and of class WindField.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "forces/wind.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cloth{
+
+void UniformWind::add_velocity(const float*, const float*, const float*, std::size_t n, float,
+                               float* wx, float* wy, float* wz) const {
+    const glm::vec3 v = velocity;
+    for (std::size_t i=0; i<n; ++i) {
+        wx[i] += v.x;
+        wy[i] += v.y;
+        wz[i] += v.z;
+    }
+}
+
+void TurbulentWind::add_velocity(const float* x, const float* y, const float* z, std::size_t n, float time,
+                                 float* wx, float* wy, float* wz) const {
+    const float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+    const glm::vec3 drift = velocity * time;
+    for (std::size_t i=0; i<n; ++i) {
+        const glm::vec3 gust = amplitude * noise.sample((glm::vec3(x[i], y[i], z[i]) - drift) * inv_scale);
+        wx[i] += velocity.x + gust.x;
+        wy[i] += velocity.y + gust.y;
+        wz[i] += velocity.z + gust.z;
+    }
+}
+
+void PointWind::add_velocity(const float* x, const float* y, const float* z, std::size_t n, float,
+                             float* wx, float* wy, float* wz) const {
+    const float inv_radius = radius > 0.0f ? 1.0f / radius : 0.0f;
+    for (std::size_t i=0; i<n; ++i) {
+        const float dx = x[i] - center.x, dy = y[i] - center.y, dz = z[i] - center.z;
+        const float d = std::sqrt(dx*dx + dy*dy + dz*dz);
+        // strength * (1 - d / radius) along the unit direction, nothing past the radius or at the center
+        const float s = d > 0.0f ? strength * std::max(1.0f - d * inv_radius, 0.0f) / d : 0.0f;
+        wx[i] += s * dx;
+        wy[i] += s * dy;
+        wz[i] += s * dz;
+    }
+}
+
+void WindField::velocity(const float* x, const float* y, const float* z, std::size_t n, float* wx, float* wy, float* wz) const {
+    std::fill(wx, wx + n, 0.0f);
+    std::fill(wy, wy + n, 0.0f);
+    std::fill(wz, wz + n, 0.0f);
+    for (const auto& s : sources)
+        s->add_velocity(x, y, z, n, static_cast<float>(time), wx, wy, wz);
+}
+
+glm::vec3 WindField::velocity(glm::vec3 p) const {
+    glm::vec3 w;
+    velocity(&p.x, &p.y, &p.z, 1, &w.x, &w.y, &w.z);
+    return w;
+}
+}
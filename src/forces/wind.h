@@ -0,0 +1,141 @@
+/**
+ * @file
+ * @brief Contains the class WindSource, the uniform, turbulent and point wind sources, and the
+ * class WindField that blows them on the cloths of a scene.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glm.hpp>
+#include "forces/curl_noise.h"
+
+namespace cloth{
+/**
+ * @class WindSource
+ * @brief Velocity of the air, a function of position and time. Sources are sampled in batches of
+ * points (one per triangle of the cloth) so that the simple ones run as plain loops over arrays.
+ */
+class WindSource
+{
+public:
+    virtual ~WindSource() = default;
+
+    /**
+     * Add the velocity of the source at the n points (x, y, z) to (wx, wy, wz)
+     * @param time seconds since the field started blowing
+     */
+    virtual void add_velocity(const float* x, const float* y, const float* z, std::size_t n, float time,
+                              float* wx, float* wy, float* wz) const = 0;
+};
+
+/**
+ * @class UniformWind
+ * @brief The same velocity everywhere
+ */
+class UniformWind : public WindSource
+{
+public:
+    glm::vec3 velocity;
+
+    explicit UniformWind(glm::vec3 velocity) : velocity(velocity) {}
+    void add_velocity(const float* x, const float* y, const float* z, std::size_t n, float time,
+                      float* wx, float* wy, float* wz) const override;
+};
+
+/**
+ * @class TurbulentWind
+ * @brief A mean velocity plus gusts: curl noise of a given length scale, carried along by the mean
+ * velocity (the turbulence is frozen in the flow)
+ */
+class TurbulentWind : public WindSource
+{
+public:
+    glm::vec3 velocity;
+    /**
+     * Root mean square speed of the gusts
+    */
+    float amplitude;
+    /**
+     * Length covered by one tile of the noise texture, the gusts are about scale / CurlNoise::cells wide
+    */
+    float scale;
+
+    TurbulentWind(glm::vec3 velocity, float amplitude, float scale, std::uint32_t seed = 1)
+        : velocity(velocity), amplitude(amplitude), scale(scale), noise(seed) {}
+    void add_velocity(const float* x, const float* y, const float* z, std::size_t n, float time,
+                      float* wx, float* wy, float* wz) const override;
+
+private:
+    CurlNoise noise;
+};
+
+/**
+ * @class PointWind
+ * @brief A fan blowing away from center: strength at the center, fading linearly to nothing at
+ * radius (negative strength sucks the air in)
+ */
+class PointWind : public WindSource
+{
+public:
+    glm::vec3 center;
+    float strength;
+    float radius;
+
+    PointWind(glm::vec3 center, float strength, float radius) : center(center), strength(strength), radius(radius) {}
+    void add_velocity(const float* x, const float* y, const float* z, std::size_t n, float time,
+                      float* wx, float* wy, float* wz) const override;
+};
+
+/**
+ * @class WindField
+ * @brief Wind sources shared by every cloth of a scene, and the air they move. A triangle of cloth
+ * in the wind feels a drag along the air velocity relative to it and a lift across it, both
+ * proportional to density times the square of that velocity times the area the triangle shows to
+ * it (see Aerodynamics).
+ *
+ * The field does not keep time by itself: the driver advances it once per simulated frame, so that
+ * cloths simulated one after the other see the same gusts.
+ */
+class WindField
+{
+public:
+    /**
+     * Density of the air, kg/m^3
+     */
+    float density = 1.2f;
+    /**
+     * Drag and lift coefficients of the cloth
+     */
+    float drag = 1.0f;
+    float lift = 0.5f;
+    /**
+     * Seconds since the field started blowing, the time of the turbulence
+     */
+    double time = 0.0;
+    std::vector<std::unique_ptr<WindSource>> sources;
+
+    template <typename T, typename... Args>
+    T& add(Args&&... args) {
+        sources.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        return static_cast<T&>(*sources.back());
+    }
+    std::size_t size() const { return sources.size(); }
+    bool empty() const { return sources.empty(); }
+
+    void advance(double seconds) { time += seconds; }
+
+    /**
+     * Air velocity at the n points (x, y, z), written to (wx, wy, wz)
+     */
+    void velocity(const float* x, const float* y, const float* z, std::size_t n, float* wx, float* wy, float* wz) const;
+    glm::vec3 velocity(glm::vec3 p) const;
+};
+}
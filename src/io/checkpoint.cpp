@@ -0,0 +1,513 @@
+/**
+ * @file
+ * @brief Contains the implementation of the binary checkpoint.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "io/checkpoint.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace cloth{
+
+namespace {
+
+constexpr char magic[8] = {'X', 'P', 'B', 'D', 'C', 'K', 'P', 'T'};
+constexpr std::uint32_t byte_order_mark = 0x01020304u;
+constexpr std::size_t section_alignment = 64;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t file_size;
+    std::uint32_t section_count;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 32, "checkpoint header layout");
+
+struct SectionEntry {
+    std::uint32_t id;
+    std::uint32_t element_size;
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+static_assert(sizeof(SectionEntry) == 24, "checkpoint section layout");
+
+/**
+ * Scalars of the cloth and the solver settings, fixed size fields only
+ */
+struct SavedState {
+    double frame_time;
+    float gravity[3];
+    float target_strain;
+    float max_substep_travel;
+    float jacobi_relaxation;
+    std::int32_t iteration_per_frame, max_frames_per_update, min_substeps, max_substeps;
+    std::int32_t rows, columns, pin1_index, pin2_index;
+    std::int32_t last_substeps, controller_substeps;
+    std::uint32_t solver_mode, bend_model;
+    float sleep_speed;
+    std::int32_t sleep_frames;
+    float tear_strain;
+    std::int32_t max_tears;
+    std::uint8_t adaptive_substeps, self_collision, long_range_attachments, sleeping, tearing, pad[3];
+};
+static_assert(sizeof(SavedState) == 104, "checkpoint state layout");
+
+/**
+ * Collects the sections, then lays out the whole file in one buffer
+ */
+class ImageBuilder
+{
+public:
+    template <typename T>
+    void add(CheckpointSection id, const T* data, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "sections hold plain data");
+        pending.push_back({id, static_cast<std::uint32_t>(sizeof(T)), data, count});
+    }
+    template <typename V>
+    void add(CheckpointSection id, const V& v) {
+        add(id, v.data(), v.size());
+    }
+
+    std::vector<char> build() const {
+        auto align = [](std::size_t offset) { return (offset + section_alignment - 1) / section_alignment * section_alignment; };
+        std::vector<SectionEntry> table(pending.size());
+        std::size_t offset = align(sizeof(FileHeader) + table.size() * sizeof(SectionEntry));
+        for (std::size_t k=0; k<pending.size(); ++k) {
+            table[k] = {static_cast<std::uint32_t>(pending[k].id), pending[k].element_size, offset, pending[k].count};
+            offset = align(offset + pending[k].element_size * pending[k].count);
+        }
+        std::vector<char> image(offset, 0);
+        FileHeader header {};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = Checkpoint::version;
+        header.byte_order = byte_order_mark;
+        header.file_size = offset;
+        header.section_count = static_cast<std::uint32_t>(table.size());
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::memcpy(image.data() + sizeof(header), table.data(), table.size() * sizeof(SectionEntry));
+        for (std::size_t k=0; k<pending.size(); ++k)
+            if (pending[k].count)
+                std::memcpy(image.data() + table[k].offset, pending[k].data, pending[k].element_size * pending[k].count);
+        return image;
+    }
+
+private:
+    struct Pending {
+        CheckpointSection id;
+        std::uint32_t element_size;
+        const void* data;
+        std::size_t count;
+    };
+    std::vector<Pending> pending;
+};
+
+void add_distance(ImageBuilder& image, const DistanceConstraints& cs, CheckpointSection first) {
+    const auto id = [first](int k) { return static_cast<CheckpointSection>(static_cast<std::uint32_t>(first) + k); };
+    cs.with_indices([&](const auto* a, const auto* b) {
+        image.add(id(0), a, cs.size());
+        image.add(id(1), b, cs.size());
+    });
+    image.add(id(2), cs.rest_dist);
+    image.add(id(3), cs.compliance);
+    image.add(id(4), cs.color_offsets);
+}
+
+void add_hinges(ImageBuilder& image, const HingeConstraints& cs, CheckpointSection first) {
+    const auto id = [first](int k) { return static_cast<CheckpointSection>(static_cast<std::uint32_t>(first) + k); };
+    image.add(id(0), cs.p0);
+    image.add(id(1), cs.p1);
+    image.add(id(2), cs.p2);
+    image.add(id(3), cs.p3);
+    image.add(id(4), cs.compliance);
+}
+}
+
+void save_checkpoint(const std::string& path, const Cloth& c, const SimSettings& s) {
+    SavedState state {};
+    state.frame_time = s.frame_time;
+    state.gravity[0] = s.gravity.x;
+    state.gravity[1] = s.gravity.y;
+    state.gravity[2] = s.gravity.z;
+    state.target_strain = s.target_strain;
+    state.max_substep_travel = s.max_substep_travel;
+    state.jacobi_relaxation = c.jacobi_relaxation;
+    state.iteration_per_frame = s.iteration_per_frame;
+    state.max_frames_per_update = s.max_frames_per_update;
+    state.min_substeps = s.min_substeps;
+    state.max_substeps = s.max_substeps;
+    state.rows = c.rows;
+    state.columns = c.columns;
+    state.pin1_index = c.pin1_index;
+    state.pin2_index = c.pin2_index;
+    state.last_substeps = c.last_substeps;
+    state.controller_substeps = c.substep_control.substeps;
+    state.solver_mode = static_cast<std::uint32_t>(c.solver_mode);
+    state.bend_model = static_cast<std::uint32_t>(c.get_bend_model());
+    state.adaptive_substeps = s.adaptive_substeps;
+    state.self_collision = s.self_collision;
+    state.long_range_attachments = s.long_range_attachments;
+    state.sleeping = s.sleeping;
+    state.sleep_speed = s.sleep_speed;
+    state.sleep_frames = s.sleep_frames;
+    state.tearing = s.tearing;
+    state.tear_strain = s.tear_strain;
+    state.max_tears = s.max_tears;
+
+    // a torn cloth rebuilds its topology only when it needs it
+    const MeshTopology topology = c.tearing.topology_stale
+            ? build_topology(reinterpret_cast<const std::uint32_t*>(c.tri_indices()), c.all_tris.size())
+            : c.topology;
+
+    using S = CheckpointSection;
+    const Particles& p = c.particles;
+    ImageBuilder image;
+    image.add(S::State, &state, 1);
+    image.add(S::ParticleX, p.x);
+    image.add(S::ParticleY, p.y);
+    image.add(S::ParticleZ, p.z);
+    image.add(S::ParticlePX, p.px);
+    image.add(S::ParticlePY, p.py);
+    image.add(S::ParticlePZ, p.pz);
+    image.add(S::ParticleVX, p.vx);
+    image.add(S::ParticleVY, p.vy);
+    image.add(S::ParticleVZ, p.vz);
+    image.add(S::ParticleW, p.w);
+    image.add(S::ParticleM, p.m);
+    image.add(S::Uvs, c.uvs);
+    image.add(S::Triangles, c.all_tris);
+    image.add(S::NodeTriOffsets, c.node_tris.offsets);
+    image.add(S::NodeTriItems, c.node_tris.items);
+    image.add(S::NodeTriEnds, c.node_tris.ends);
+    image.add(S::EdgeV0, topology.edge_v0);
+    image.add(S::EdgeV1, topology.edge_v1);
+    image.add(S::Hinges, topology.hinges);
+    add_distance(image, c.s_cs, S::StretchFirst);
+    add_distance(image, c.b_cs, S::BendFirst);
+    add_hinges(image, c.dihedral_cs, S::DihedralP0);
+    image.add(S::DihedralRest, c.dihedral_cs.rest_angle);
+    image.add(S::DihedralColors, c.dihedral_cs.color_offsets);
+    add_hinges(image, c.isometric_cs, S::IsometricP0);
+    image.add(S::IsometricK0, c.isometric_cs.k0);
+    image.add(S::IsometricK1, c.isometric_cs.k1);
+    image.add(S::IsometricK2, c.isometric_cs.k2);
+    image.add(S::IsometricK3, c.isometric_cs.k3);
+    image.add(S::IsometricScale, c.isometric_cs.scale);
+    image.add(S::IsometricColors, c.isometric_cs.color_offsets);
+    image.add(S::TetherAnchors, c.tethers.anchors);
+    image.add(S::TetherOffsets, c.tethers.offsets);
+    image.add(S::TetherParticle, c.tethers.particle);
+    image.add(S::TetherLength, c.tethers.length);
+    if (c.islands_current()) {
+        image.add(S::IslandQuietFrames, c.islands.quiet_frames);
+        image.add(S::IslandAsleep, c.islands.asleep);
+    }
+    if (!c.self_collision.split_origins().empty()) {
+        // the links of a torn cloth are those of the cloth before its first tear
+        image.add(S::SelfLinkOffsets, c.self_collision.link_table_offsets());
+        image.add(S::SelfLinks, c.self_collision.link_table());
+        image.add(S::SplitOrigin, c.self_collision.split_origins());
+    }
+
+    const std::vector<char> bytes = image.build();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("cannot open " + path);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+}
+
+Checkpoint::Checkpoint(const std::string& path) : file(path) {
+    FileHeader header;
+    if (file.size() < sizeof(header))
+        throw std::runtime_error(path + " is not a checkpoint");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error(path + " is not a checkpoint");
+    if (header.byte_order != byte_order_mark)
+        throw std::runtime_error(path + " was written with another byte order");
+    if (header.version != version)
+        throw std::runtime_error(path + ": checkpoint version " + std::to_string(header.version)
+                                 + ", expected " + std::to_string(version));
+    if (header.file_size != file.size()
+        || header.section_count > (file.size() - sizeof(header)) / sizeof(SectionEntry))
+        throw std::runtime_error(path + " is truncated");
+    for (std::uint32_t k=0; k<header.section_count; ++k) {
+        SectionEntry e;
+        std::memcpy(&e, file.data() + sizeof(header) + k * sizeof(e), sizeof(e));
+        if (e.offset % section_alignment != 0 || e.offset > file.size() || e.element_size == 0
+            || e.count > (file.size() - e.offset) / e.element_size)
+            throw std::runtime_error(path + ": section " + std::to_string(e.id) + " is out of the file");
+    }
+    std::size_t n = 0;
+    section<float>(CheckpointSection::ParticleW, n);
+    particles = n;
+}
+
+const void* Checkpoint::find(CheckpointSection id, std::size_t element_size, std::size_t& count) const {
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    for (std::uint32_t k=0; k<header.section_count; ++k) {
+        SectionEntry e;
+        std::memcpy(&e, file.data() + sizeof(header) + k * sizeof(e), sizeof(e));
+        if (e.id != static_cast<std::uint32_t>(id))
+            continue;
+        if (e.element_size != element_size)
+            throw std::runtime_error("checkpoint section " + std::to_string(e.id) + " has elements of "
+                                     + std::to_string(e.element_size) + " bytes");
+        count = static_cast<std::size_t>(e.count);
+        return file.data() + e.offset;
+    }
+    count = 0;
+    return nullptr;
+}
+
+namespace {
+/**
+ * Copy a section into v; per_particle sections must have one element per particle
+ */
+template <typename V>
+void load(const Checkpoint& cp, CheckpointSection id, V& v, bool per_particle = false) {
+    std::size_t n = 0;
+    const auto* data = cp.section<typename V::value_type>(id, n);
+    if (per_particle && n != cp.particle_count())
+        throw std::runtime_error("checkpoint section " + std::to_string(static_cast<std::uint32_t>(id)) + " does not match the particles");
+    v.assign(data, data + n);
+}
+
+/**
+ * Throw unless the n indices of data are below limit (e.g. the particle count)
+ */
+template <typename Index>
+void check_indices(const Index* data, std::size_t n, std::size_t limit, const char* what) {
+    for (std::size_t i=0; i<n; ++i)
+        if (static_cast<std::make_unsigned_t<Index>>(data[i]) >= limit)
+            throw std::runtime_error(std::string("checkpoint ") + what + " index out of range");
+}
+
+template <typename V>
+void check_indices(const V& v, std::size_t limit, const char* what) {
+    check_indices(v.data(), v.size(), limit, what);
+}
+
+/**
+ * Throw unless every key of an index table (Adjacency, tethers, links) is a range of items
+ * @param ends end of every key, null when the table is compact (key k ends where k+1 begins)
+ */
+void check_ranges(const std::vector<std::uint32_t>& offsets, const std::uint32_t* ends, std::size_t items, const char* what) {
+    for (std::size_t k=0; k+1<offsets.size(); ++k) {
+        const std::uint32_t end = ends ? ends[k] : offsets[k + 1];
+        if (offsets[k] > end || end > items)
+            throw std::runtime_error(std::string("checkpoint ") + what + " table is inconsistent");
+    }
+    if (!ends && !offsets.empty() && offsets.back() != items)
+        throw std::runtime_error(std::string("checkpoint ") + what + " table is inconsistent");
+}
+
+void load_colors(const Checkpoint& cp, CheckpointSection id, std::vector<std::uint32_t>& offsets, std::size_t size) {
+    load(cp, id, offsets);
+    for (std::size_t k=1; k<offsets.size(); ++k)
+        if (offsets[k] < offsets[k - 1])
+            throw std::runtime_error("checkpoint colours are not sorted");
+    if (!offsets.empty() && (offsets.front() != 0 || offsets.back() != size))
+        throw std::runtime_error("checkpoint colours do not cover their constraints");
+}
+
+void load_distance(const Checkpoint& cp, DistanceConstraints& cs, CheckpointSection first) {
+    const auto id = [first](int k) { return static_cast<CheckpointSection>(static_cast<std::uint32_t>(first) + k); };
+    cs.clear();
+    cs.set_index_width(cp.particle_count());
+    std::size_t n = 0, n1 = 0, n2 = 0, n3 = 0;
+    const float* rest = cp.section<float>(id(2), n);
+    const float* compliance = cp.section<float>(id(3), n3);
+    auto assign = [&](auto* index_type) {
+        using Index = std::remove_pointer_t<decltype(index_type)>;
+        const Index* a = cp.section<Index>(id(0), n1);
+        const Index* b = cp.section<Index>(id(1), n2);
+        if (n1 != n || n2 != n || n3 != n)
+            throw std::runtime_error("checkpoint constraint arrays differ in length");
+        check_indices(a, n, cp.particle_count(), "constraint");
+        check_indices(b, n, cp.particle_count(), "constraint");
+        cs.assign(a, b, rest, compliance, n);
+    };
+    if (cs.narrow())
+        assign(static_cast<std::uint16_t*>(nullptr));
+    else
+        assign(static_cast<std::uint32_t*>(nullptr));
+    load_colors(cp, id(4), cs.color_offsets, n);
+}
+
+void load_hinges(const Checkpoint& cp, HingeConstraints& cs, CheckpointSection first) {
+    const auto id = [first](int k) { return static_cast<CheckpointSection>(static_cast<std::uint32_t>(first) + k); };
+    load(cp, id(0), cs.p0);
+    load(cp, id(1), cs.p1);
+    load(cp, id(2), cs.p2);
+    load(cp, id(3), cs.p3);
+    load(cp, id(4), cs.compliance);
+    const std::size_t n = cs.p0.size();
+    if (cs.p1.size() != n || cs.p2.size() != n || cs.p3.size() != n || cs.compliance.size() != n)
+        throw std::runtime_error("checkpoint hinge arrays differ in length");
+    for (const auto* p : {&cs.p0, &cs.p1, &cs.p2, &cs.p3})
+        check_indices(*p, cp.particle_count(), "hinge");
+}
+}
+
+std::unique_ptr<Cloth> Checkpoint::restore(SimSettings& s) const {
+    using S = CheckpointSection;
+    std::size_t count = 0;
+    const SavedState* state = section<SavedState>(S::State, count);
+    if (count != 1)
+        throw std::runtime_error("checkpoint has no state");
+
+    s.frame_time = state->frame_time;
+    s.gravity = glm::vec3(state->gravity[0], state->gravity[1], state->gravity[2]);
+    s.target_strain = state->target_strain;
+    s.max_substep_travel = state->max_substep_travel;
+    s.iteration_per_frame = state->iteration_per_frame;
+    s.max_frames_per_update = state->max_frames_per_update;
+    s.min_substeps = state->min_substeps;
+    s.max_substeps = state->max_substeps;
+    s.adaptive_substeps = state->adaptive_substeps != 0;
+    s.self_collision = state->self_collision != 0;
+    s.long_range_attachments = state->long_range_attachments != 0;
+    s.sleeping = state->sleeping != 0;
+    s.sleep_speed = state->sleep_speed;
+    s.sleep_frames = state->sleep_frames;
+    s.tearing = state->tearing != 0;
+    s.tear_strain = state->tear_strain;
+    s.max_tears = state->max_tears;
+
+    if (state->solver_mode > static_cast<std::uint32_t>(SolverMode::Jacobi)
+        || state->bend_model > static_cast<std::uint32_t>(BendModel::Isometric))
+        throw std::runtime_error("checkpoint has an unknown solver or bending model");
+
+    std::unique_ptr<Cloth> c(new Cloth());
+    c->rows = state->rows;
+    c->columns = state->columns;
+    c->pin1_index = state->pin1_index;
+    c->pin2_index = state->pin2_index;
+    c->last_substeps = state->last_substeps;
+    c->substep_control.substeps = state->controller_substeps;
+    c->jacobi_relaxation = state->jacobi_relaxation;
+    c->solver_mode = static_cast<SolverMode>(state->solver_mode);
+    c->bend_model = static_cast<BendModel>(state->bend_model);
+
+    Particles& p = c->particles;
+    load(*this, S::ParticleX, p.x, true);
+    load(*this, S::ParticleY, p.y, true);
+    load(*this, S::ParticleZ, p.z, true);
+    load(*this, S::ParticlePX, p.px, true);
+    load(*this, S::ParticlePY, p.py, true);
+    load(*this, S::ParticlePZ, p.pz, true);
+    load(*this, S::ParticleVX, p.vx, true);
+    load(*this, S::ParticleVY, p.vy, true);
+    load(*this, S::ParticleVZ, p.vz, true);
+    load(*this, S::ParticleW, p.w, true);
+    load(*this, S::ParticleM, p.m, true);
+    load(*this, S::Uvs, c->uvs, true);
+
+    load(*this, S::Triangles, c->all_tris);
+    check_indices(c->tri_indices(), 3 * c->all_tris.size(), particles, "triangle");
+    if (c->rows > 1 && c->columns > 1) {
+        // a grid lists its upper left triangles first
+        const std::size_t split = static_cast<std::size_t>(c->rows - 1) * static_cast<std::size_t>(c->columns - 1);
+        if (split <= c->all_tris.size()) {
+            c->up_left_tris.assign(c->all_tris.begin(), c->all_tris.begin() + split);
+            c->low_right_tris.assign(c->all_tris.begin() + split, c->all_tris.end());
+        }
+    }
+    load(*this, S::NodeTriOffsets, c->node_tris.offsets);
+    load(*this, S::NodeTriItems, c->node_tris.items);
+    load(*this, S::NodeTriEnds, c->node_tris.ends);
+    if (!c->node_tris.ends.empty() && c->node_tris.ends.size() != particles)
+        throw std::runtime_error("checkpoint triangle table does not match the particles");
+    if (c->node_tris.offsets.size() != particles + 1)
+        throw std::runtime_error("checkpoint triangle table does not match the particles");
+    check_ranges(c->node_tris.offsets, c->node_tris.ends.empty() ? nullptr : c->node_tris.ends.data(),
+                 c->node_tris.items.size(), "triangle");
+    check_indices(c->node_tris.items, c->all_tris.size(), "triangle table");
+    load(*this, S::EdgeV0, c->topology.edge_v0);
+    load(*this, S::EdgeV1, c->topology.edge_v1);
+    load(*this, S::Hinges, c->topology.hinges);
+    if (c->topology.edge_v1.size() != c->topology.edge_v0.size())
+        throw std::runtime_error("checkpoint edge arrays differ in length");
+    check_indices(c->topology.edge_v0, particles, "edge");
+    check_indices(c->topology.edge_v1, particles, "edge");
+    for (const Hinge& h : c->topology.hinges)
+        if (h.v0 >= particles || h.v1 >= particles || h.a >= particles || h.b >= particles)
+            throw std::runtime_error("checkpoint hinge index out of range");
+
+    load_distance(*this, c->s_cs, S::StretchFirst);
+    load_distance(*this, c->b_cs, S::BendFirst);
+    load_hinges(*this, c->dihedral_cs, S::DihedralP0);
+    load(*this, S::DihedralRest, c->dihedral_cs.rest_angle);
+    if (c->dihedral_cs.rest_angle.size() != c->dihedral_cs.size())
+        throw std::runtime_error("checkpoint hinge arrays differ in length");
+    load_colors(*this, S::DihedralColors, c->dihedral_cs.color_offsets, c->dihedral_cs.size());
+    load_hinges(*this, c->isometric_cs, S::IsometricP0);
+    load(*this, S::IsometricK0, c->isometric_cs.k0);
+    load(*this, S::IsometricK1, c->isometric_cs.k1);
+    load(*this, S::IsometricK2, c->isometric_cs.k2);
+    load(*this, S::IsometricK3, c->isometric_cs.k3);
+    load(*this, S::IsometricScale, c->isometric_cs.scale);
+    const IsometricBendConstraints& isometric = c->isometric_cs;
+    for (const auto* v : {&isometric.k0, &isometric.k1, &isometric.k2, &isometric.k3, &isometric.scale})
+        if (v->size() != isometric.size())
+            throw std::runtime_error("checkpoint hinge arrays differ in length");
+    load_colors(*this, S::IsometricColors, c->isometric_cs.color_offsets, c->isometric_cs.size());
+    load(*this, S::TetherAnchors, c->tethers.anchors);
+    load(*this, S::TetherOffsets, c->tethers.offsets);
+    load(*this, S::TetherParticle, c->tethers.particle);
+    load(*this, S::TetherLength, c->tethers.length);
+    const LongRangeAttachments& tethers = c->tethers;
+    if (!tethers.anchors.empty() && tethers.offsets.size() != tethers.anchors.size() + 1)
+        throw std::runtime_error("checkpoint tether table is inconsistent");
+    if (tethers.length.size() != tethers.particle.size())
+        throw std::runtime_error("checkpoint tether arrays differ in length");
+    check_ranges(tethers.offsets, nullptr, tethers.particle.size(), "tether");
+    check_indices(tethers.anchors, particles, "tether anchor");
+    check_indices(tethers.particle, particles, "tether");
+
+    // derived data, linear in the size of the cloth
+    c->normals.resize(particles);
+    c->face_normals.resize(c->all_tris.size());
+    c->compute_normals();
+    c->self_collision.set_links(c->s_cs, particles);
+    std::size_t origin_count = 0;
+    if (section<std::uint32_t>(S::SplitOrigin, origin_count) && origin_count > 0) {
+        std::vector<std::uint32_t> offsets, links, origins;
+        load(*this, S::SelfLinkOffsets, offsets);
+        load(*this, S::SelfLinks, links);
+        load(*this, S::SplitOrigin, origins, true);
+        if (offsets.empty())
+            throw std::runtime_error("checkpoint self collision links are inconsistent");
+        check_ranges(offsets, nullptr, links.size(), "self collision link");
+        check_indices(links, particles, "self collision link");
+        check_indices(origins, offsets.size() - 1, "split origin");
+        c->self_collision.restore_links(std::move(offsets), std::move(links), std::move(origins));
+    }
+
+    // the islands follow from the stretch constraints, only their sleep state is saved
+    std::size_t quiet_count = 0, asleep_count = 0;
+    const auto* quiet = section<std::uint32_t>(S::IslandQuietFrames, quiet_count);
+    const auto* asleep = section<std::uint8_t>(S::IslandAsleep, asleep_count);
+    if (quiet && asleep) {
+        c->islands.build(c->s_cs, particles);
+        if (quiet_count != c->islands.size() || asleep_count != c->islands.size())
+            throw std::runtime_error("checkpoint islands do not match the constraints");
+        c->islands.restore(quiet, asleep);
+        c->islands_revision = c->constraint_revision;
+        c->islands_gravity = s.gravity;
+    }
+    return c;
+}
+}
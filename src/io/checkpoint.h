@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @brief Contains the binary checkpoint of a simulation: save_checkpoint and the class Checkpoint.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "cloth/cloth.h"
+#include "cloth/settings.h"
+#include "io/mapped_file.h"
+
+namespace cloth{
+/**
+ * Content of a checkpoint section. The values are part of the file format: new sections get new
+ * values, existing ones never change meaning.
+ */
+enum class CheckpointSection : std::uint32_t {
+    State = 1,
+    ParticleX, ParticleY, ParticleZ,
+    ParticlePX, ParticlePY, ParticlePZ,
+    ParticleVX, ParticleVY, ParticleVZ,
+    ParticleW, ParticleM,
+    Uvs,
+    Triangles,
+    NodeTriOffsets, NodeTriItems,
+    EdgeV0, EdgeV1, Hinges,
+    StretchFirst, StretchSecond, StretchRest, StretchCompliance, StretchColors,
+    BendFirst, BendSecond, BendRest, BendCompliance, BendColors,
+    DihedralP0, DihedralP1, DihedralP2, DihedralP3, DihedralCompliance, DihedralRest, DihedralColors,
+    IsometricP0, IsometricP1, IsometricP2, IsometricP3, IsometricCompliance,
+    IsometricK0, IsometricK1, IsometricK2, IsometricK3, IsometricScale, IsometricColors,
+    TetherAnchors, TetherOffsets, TetherParticle, TetherLength,
+    IslandQuietFrames, IslandAsleep,
+    NodeTriEnds, SelfLinkOffsets, SelfLinks, SplitOrigin
+};
+
+/**
+ * Write the full state of a cloth (particles, constraints with their colouring, topology, pins)
+ * and the solver settings to path. The file is assembled in memory and written with one write:
+ * a fixed header, a table of sections and the sections, each aligned to 64 bytes in the native
+ * byte order.
+ * @throws std::runtime_error when the file cannot be written
+ */
+void save_checkpoint(const std::string& path, const Cloth& c, const SimSettings& s);
+
+/**
+ * @class Checkpoint
+ * @brief A checkpoint file mapped in memory. Opening only validates the header and the section
+ * table; section() returns pointers into the mapping, so nothing is read or copied until used.
+ *
+ * restore() builds a cloth that continues exactly where the saved one stopped: the arrays are
+ * copied from the mapping as they are, nothing (colouring, geodesics, topology) is recomputed.
+ * Colliders, the thread pool, the profiler and the SIMD level are not part of the state.
+ */
+class Checkpoint
+{
+public:
+    /**
+     * Format version written by save_checkpoint, older or newer files are rejected
+    */
+    static constexpr std::uint32_t version = 3;
+
+    /**
+     * Map and validate the checkpoint at path
+     * @throws std::runtime_error when the file is not a valid checkpoint of this version
+     */
+    explicit Checkpoint(const std::string& path);
+
+    std::size_t particle_count() const { return particles; }
+
+    /**
+     * Elements of a section, in the mapping (null when the checkpoint does not have it)
+     * @param id section
+     * @param count set to the number of elements
+     * @throws std::runtime_error when the element size is not sizeof(T)
+     */
+    template <typename T>
+    const T* section(CheckpointSection id, std::size_t& count) const {
+        return static_cast<const T*>(find(id, sizeof(T), count));
+    }
+
+    /**
+     * Cloth and settings of the checkpoint; every index is checked against the particles, so a
+     * corrupt file throws std::runtime_error instead of reaching the solver
+     * @param s set to the saved settings
+     */
+    std::unique_ptr<Cloth> restore(SimSettings& s) const;
+
+private:
+    const void* find(CheckpointSection id, std::size_t element_size, std::size_t& count) const;
+
+    MappedFile file;
+    std::size_t particles = 0;
+};
+}
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Contains the implementation of class MappedFile.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "io/mapped_file.h"
+#include <stdexcept>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#define XPBD_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace cloth{
+
+#ifdef XPBD_HAVE_MMAP
+#ifdef MAP_POPULATE
+// fault the whole file in with the mmap call: the caller is about to read all of it anyway
+static constexpr int map_flags = MAP_POPULATE;
+#else
+static constexpr int map_flags = 0;
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    length = static_cast<std::size_t>(st.st_size);
+    if (length > 0) {
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE | map_flags, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot map " + path);
+        }
+        bytes = static_cast<const unsigned char*>(p);
+        mapped = true;
+    }
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+}
+
+void MappedFile::release() {
+    if (mapped)
+        ::munmap(const_cast<unsigned char*>(bytes), length);
+    mapped = false;
+    bytes = nullptr;
+    length = 0;
+    buffer.clear();
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("cannot open " + path);
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    bytes = buffer.data();
+    length = buffer.size();
+}
+
+void MappedFile::release() {
+    bytes = nullptr;
+    length = 0;
+    buffer.clear();
+}
+#endif
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        mapped = std::exchange(other.mapped, false);
+        buffer = std::move(other.buffer);
+        // a moved std::vector keeps its storage, so bytes stays valid in the buffered case
+    }
+    return *this;
+}
+}
@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @brief Contains the class MappedFile, a read only view of a whole file.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace cloth{
+/**
+ * @class MappedFile
+ * @brief Maps a file read only in memory (mmap), the pages are read on first touch. On platforms
+ * without mmap the file is read into a buffer instead, the interface is the same.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    /**
+     * Map the file at path
+     * @throws std::runtime_error when the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+
+private:
+    void release();
+
+    const unsigned char* bytes = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    std::vector<unsigned char> buffer;
+};
+}
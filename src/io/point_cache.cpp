@@ -0,0 +1,408 @@
+/**
+ * @file
+ * @brief Contains the implementation of classes PointCacheWriter and PointCacheReader.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "io/point_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include "cloth/normals.h"
+
+namespace cloth{
+
+namespace {
+
+constexpr char magic[8] = {'X', 'P', 'B', 'D', 'P', 'C', 'C', 'H'};
+constexpr char index_magic[8] = {'X', 'P', 'B', 'D', 'P', 'C', 'I', 'X'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint32_t byte_order_mark = 0x01020304u;
+constexpr std::uint32_t frame_marker = 0x4d415246u; // "FRAM"
+constexpr std::uint32_t normals_flag = 1u;
+// quantized coordinates stay in this range, so a difference of two always fits 32 bits
+constexpr std::int32_t quantized_limit = 1 << 30;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t flags;
+    std::uint32_t vertex_count;
+    std::uint32_t triangle_count;
+    std::uint32_t key_interval;
+    float precision;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 40, "point cache header layout");
+
+struct FrameHeader {
+    std::uint32_t marker;
+    std::uint32_t payload;
+    double time;
+};
+static_assert(sizeof(FrameHeader) == 16, "point cache frame layout");
+
+struct Trailer {
+    std::uint64_t index_offset;
+    std::uint64_t frame_count;
+    char magic[8];
+};
+static_assert(sizeof(Trailer) == 24, "point cache trailer layout");
+
+inline std::uint32_t zigzag(std::int32_t v) {
+    return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+}
+
+inline std::int32_t unzigzag(std::uint32_t v) {
+    return static_cast<std::int32_t>(v >> 1) ^ -static_cast<std::int32_t>(v & 1u);
+}
+
+inline void put_varint(std::vector<unsigned char>& out, std::uint32_t v) {
+    while (v >= 0x80u) {
+        out.push_back(static_cast<unsigned char>(v | 0x80u));
+        v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+inline std::uint32_t get_varint(const unsigned char*& p, const unsigned char* end) {
+    std::uint32_t v = 0;
+    for (int shift=0; shift<35; shift+=7) {
+        if (p == end)
+            throw std::runtime_error("point cache frame is truncated");
+        const unsigned char byte = *p++;
+        v |= static_cast<std::uint32_t>(byte & 0x7fu) << shift;
+        if (!(byte & 0x80u))
+            return v;
+    }
+    throw std::runtime_error("point cache frame is corrupt");
+}
+
+inline float sign_not_zero(float v) {
+    return v < 0.0f ? -1.0f : 1.0f;
+}
+
+/**
+ * Octahedral mapping of a direction to two snorm16 (Cigolle et al. 2014)
+ */
+void encode_normal(glm::vec3 n, std::int16_t out[2]) {
+    const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (!(l1 > 0.0f))
+        n = glm::vec3(0.0f, 0.0f, 1.0f);
+    else
+        n /= l1;
+    glm::vec2 p {n.x, n.y};
+    if (n.z < 0.0f)
+        p = glm::vec2((1.0f - std::abs(n.y)) * sign_not_zero(n.x), (1.0f - std::abs(n.x)) * sign_not_zero(n.y));
+    out[0] = static_cast<std::int16_t>(std::lround(std::clamp(p.x, -1.0f, 1.0f) * 32767.0f));
+    out[1] = static_cast<std::int16_t>(std::lround(std::clamp(p.y, -1.0f, 1.0f) * 32767.0f));
+}
+
+glm::vec3 decode_normal(const std::int16_t in[2]) {
+    glm::vec2 p {in[0] / 32767.0f, in[1] / 32767.0f};
+    glm::vec3 n {p.x, p.y, 1.0f - std::abs(p.x) - std::abs(p.y)};
+    if (n.z < 0.0f) {
+        n.x = (1.0f - std::abs(p.y)) * sign_not_zero(p.x);
+        n.y = (1.0f - std::abs(p.x)) * sign_not_zero(p.y);
+    }
+    return glm::normalize(n);
+}
+}
+
+PointCacheWriter::PointCacheWriter(const std::string& path, const Cloth& c, PointCacheOptions options)
+    : options(options), vertex_count(c.particles.size()),
+      tris(c.tri_indices(), c.tri_indices() + 3 * c.all_tris.size()), node_tris(c.node_tris) {
+    if (PointCacheWriter::options.key_interval == 0)
+        PointCacheWriter::options.key_interval = 1;
+    if (PointCacheWriter::options.max_pending == 0)
+        PointCacheWriter::options.max_pending = 1;
+    if (!(PointCacheWriter::options.precision > 0.0f))
+        throw std::invalid_argument("point cache precision must be positive");
+    if (c.uvs.size() != vertex_count)
+        throw std::invalid_argument("point cache needs one uv per vertex");
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("cannot open " + path);
+    FileHeader header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byte_order = byte_order_mark;
+    header.flags = PointCacheWriter::options.normals ? normals_flag : 0u;
+    header.vertex_count = static_cast<std::uint32_t>(vertex_count);
+    header.triangle_count = static_cast<std::uint32_t>(c.all_tris.size());
+    header.key_interval = PointCacheWriter::options.key_interval;
+    header.precision = PointCacheWriter::options.precision;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    // indices are never negative, int and uint32 share the representation
+    out.write(reinterpret_cast<const char*>(tris.data()), static_cast<std::streamsize>(tris.size() * sizeof(int)));
+    out.write(reinterpret_cast<const char*>(c.uvs.data()), static_cast<std::streamsize>(c.uvs.size() * sizeof(glm::vec2)));
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+    written = sizeof(header) + tris.size() * sizeof(int) + c.uvs.size() * sizeof(glm::vec2);
+    if (!PointCacheWriter::options.normals) {
+        tris.clear();
+        node_tris = Adjacency();
+    }
+    worker = std::thread(&PointCacheWriter::run, this);
+}
+
+PointCacheWriter::~PointCacheWriter() {
+    try {
+        finish();
+    } catch (...) {
+    }
+}
+
+void PointCacheWriter::rethrow() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void PointCacheWriter::append(const Cloth& c, double time) {
+    if (finished)
+        throw std::logic_error("point cache already finished");
+    if (c.particles.size() != vertex_count)
+        throw std::invalid_argument("point cache frame does not match the topology");
+    Pending frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return queue.size() < options.max_pending || error; });
+        if (error)
+            std::rethrow_exception(error);
+        if (!spare.empty()) {
+            frame = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+    // the copy is all the solver thread pays, outside the lock
+    frame.positions.capture(c.particles);
+    frame.positions.frame = appended;
+    frame.time = time;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(frame));
+    }
+    ++appended;
+    changed.notify_all();
+}
+
+void PointCacheWriter::run() {
+    for (;;) {
+        Pending frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return !queue.empty() || stopping; });
+            if (queue.empty())
+                return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        try {
+            bool failed;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = static_cast<bool>(error);
+            }
+            if (!failed) {
+                encode(frame, block);
+                out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+                if (!out)
+                    throw std::runtime_error("cannot write point cache frame " + std::to_string(frame.positions.frame));
+                offsets.push_back(written);
+                written += block.size();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            spare.push_back(std::move(frame));
+        }
+        changed.notify_all();
+    }
+}
+
+void PointCacheWriter::encode(const Pending& frame, std::vector<unsigned char>& bytes) {
+    const std::size_t n = vertex_count;
+    const bool key = offsets.size() % options.key_interval == 0;
+    previous.resize(3 * n);
+    bytes.assign(sizeof(FrameHeader), 0);
+    const float scale = 1.0f / options.precision;
+    const float* component[3] = {frame.positions.x.data(), frame.positions.y.data(), frame.positions.z.data()};
+    for (int k=0; k<3; ++k) {
+        std::int32_t* q = previous.data() + k * n;
+        std::int32_t last = 0;
+        for (std::size_t i=0; i<n; ++i) {
+            const float v = std::clamp(component[k][i] * scale, static_cast<float>(-quantized_limit), static_cast<float>(quantized_limit));
+            const std::int32_t value = static_cast<std::int32_t>(std::lround(v));
+            // key frames are delta coded along the vertices, the others against the last frame
+            put_varint(bytes, zigzag(value - (key ? last : q[i])));
+            last = value;
+            q[i] = value;
+        }
+    }
+    if (options.normals) {
+        faces.resize(tris.size() / 3);
+        compute_face_normals(tris.data(), faces.size(), component[0], component[1], component[2], faces.data(), nullptr);
+        const std::size_t at = bytes.size();
+        bytes.resize(at + 4 * n);
+        for (std::size_t i=0; i<n; ++i) {
+            glm::vec3 sum {0.0f};
+            for (std::uint32_t k=node_tris.begin(i); k<node_tris.end(i); ++k)
+                sum += faces[node_tris.items[k]];
+            std::int16_t packed[2];
+            encode_normal(sum, packed);
+            std::memcpy(bytes.data() + at + 4 * i, packed, sizeof(packed));
+        }
+    }
+    FrameHeader header {frame_marker, static_cast<std::uint32_t>(bytes.size() - sizeof(FrameHeader)), frame.time};
+    std::memcpy(bytes.data(), &header, sizeof(header));
+}
+
+void PointCacheWriter::finish() {
+    if (finished)
+        return;
+    finished = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+    rethrow();
+    Trailer trailer {written, offsets.size(), {}};
+    std::memcpy(trailer.magic, index_magic, sizeof(index_magic));
+    out.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+    out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    out.close();
+    if (!out)
+        throw std::runtime_error("cannot write the point cache index");
+}
+
+PointCacheReader::PointCacheReader(const std::string& path) : file(path) {
+    FileHeader header;
+    if (file.size() < sizeof(header))
+        throw std::runtime_error(path + " is not a point cache");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+        throw std::runtime_error(path + " is not a point cache");
+    if (header.byte_order != byte_order_mark)
+        throw std::runtime_error(path + " was written with another byte order");
+    if (header.version != version)
+        throw std::runtime_error(path + ": point cache version " + std::to_string(header.version)
+                                 + ", expected " + std::to_string(version));
+    vertices = header.vertex_count;
+    triangles = header.triangle_count;
+    normals = (header.flags & normals_flag) != 0;
+    precision = header.precision;
+    key_interval = std::max(1u, header.key_interval);
+    const std::uint64_t frames_at = sizeof(header) + 12ull * triangles + 8ull * vertices;
+    if (frames_at > file.size())
+        throw std::runtime_error(path + " is truncated");
+    index_data = reinterpret_cast<const std::uint32_t*>(file.data() + sizeof(header));
+    uv_data = reinterpret_cast<const float*>(file.data() + sizeof(header) + 12ull * triangles);
+
+    Trailer trailer {};
+    if (file.size() >= frames_at + sizeof(trailer))
+        std::memcpy(&trailer, file.data() + file.size() - sizeof(trailer), sizeof(trailer));
+    const bool indexed = std::memcmp(trailer.magic, index_magic, sizeof(index_magic)) == 0
+                         && trailer.index_offset >= frames_at
+                         && trailer.frame_count <= (file.size() - sizeof(trailer) - trailer.index_offset) / sizeof(std::uint64_t)
+                         && trailer.index_offset + trailer.frame_count * sizeof(std::uint64_t) + sizeof(trailer) == file.size();
+    // a frame must end before limit and hold the normals it closes with
+    const auto fits = [&](std::uint64_t at, std::uint64_t limit) {
+        FrameHeader frame;
+        if (at < frames_at || at > limit || limit - at < sizeof(frame))
+            return false;
+        std::memcpy(&frame, file.data() + at, sizeof(frame));
+        return frame.marker == frame_marker && frame.payload <= limit - at - sizeof(frame)
+               && (!normals || frame.payload >= 4ull * vertices);
+    };
+    if (indexed) {
+        blocks.resize(trailer.frame_count);
+        std::memcpy(blocks.data(), file.data() + trailer.index_offset, blocks.size() * sizeof(std::uint64_t));
+        for (const std::uint64_t at : blocks)
+            if (!fits(at, trailer.index_offset))
+                throw std::runtime_error(path + ": frame index is out of the file");
+    } else {
+        // the writer did not finish: walk the frames, drop the last one if it is partial
+        std::uint64_t at = frames_at;
+        while (fits(at, file.size())) {
+            FrameHeader frame;
+            std::memcpy(&frame, file.data() + at, sizeof(frame));
+            blocks.push_back(at);
+            at += sizeof(frame) + frame.payload;
+        }
+    }
+}
+
+double PointCacheReader::time(std::size_t frame) const {
+    FrameHeader header;
+    std::memcpy(&header, file.data() + blocks.at(frame), sizeof(header));
+    return header.time;
+}
+
+void PointCacheReader::decode(std::size_t frame) {
+    if (frame == current)
+        return;
+    // continue from the last frame when possible, otherwise from the key frame
+    std::size_t from = frame - frame % key_interval;
+    if (current != static_cast<std::size_t>(-1) && current >= from && current < frame)
+        from = current + 1;
+    quantized.resize(3 * vertices);
+    for (std::size_t f=from; f<=frame; ++f) {
+        FrameHeader header;
+        std::memcpy(&header, file.data() + blocks[f], sizeof(header));
+        if (header.marker != frame_marker)
+            throw std::runtime_error("point cache frame " + std::to_string(f) + " is corrupt");
+        const unsigned char* p = file.data() + blocks[f] + sizeof(header);
+        const unsigned char* end = p + header.payload;
+        const bool key = f % key_interval == 0;
+        for (int k=0; k<3; ++k) {
+            std::int32_t* q = quantized.data() + k * vertices;
+            std::int32_t last = 0;
+            for (std::size_t i=0; i<vertices; ++i) {
+                const std::int32_t delta = unzigzag(get_varint(p, end));
+                q[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(key ? last : q[i]) + static_cast<std::uint32_t>(delta));
+                last = q[i];
+            }
+        }
+        if (static_cast<std::size_t>(end - p) != (normals ? 4 * vertices : 0))
+            throw std::runtime_error("point cache frame " + std::to_string(f) + " is corrupt");
+        current = f;
+    }
+}
+
+void PointCacheReader::read(std::size_t frame, float* x, float* y, float* z, glm::vec3* n) {
+    if (frame >= blocks.size())
+        throw std::out_of_range("point cache has no frame " + std::to_string(frame));
+    decode(frame);
+    const std::int32_t* q = quantized.data();
+    for (std::size_t i=0; i<vertices; ++i) {
+        x[i] = static_cast<float>(q[i]) * precision;
+        y[i] = static_cast<float>(q[vertices + i]) * precision;
+        z[i] = static_cast<float>(q[2 * vertices + i]) * precision;
+    }
+    if (n && normals) {
+        FrameHeader header;
+        std::memcpy(&header, file.data() + blocks[frame], sizeof(header));
+        // the normals close the block
+        const unsigned char* packed = file.data() + blocks[frame] + sizeof(header) + header.payload - 4 * vertices;
+        for (std::size_t i=0; i<vertices; ++i) {
+            std::int16_t v[2];
+            std::memcpy(v, packed + 4 * i, sizeof(v));
+            n[i] = decode_normal(v);
+        }
+    }
+}
+}
@@ -0,0 +1,180 @@
+/**
+ * @file
+ * @brief Contains the point cache of an animated cloth: classes PointCacheWriter and
+ * PointCacheReader.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm.hpp>
+#include "cloth/adjacency.h"
+#include "cloth/cloth.h"
+#include "cloth/snapshot.h"
+#include "io/mapped_file.h"
+
+namespace cloth{
+/**
+ * Parameters of a point cache, fixed when the writer is created
+ */
+struct PointCacheOptions
+{
+    /**
+     * Store a normal per vertex and frame (octahedral, 2 x 16 bit) besides the positions
+    */
+    bool normals = true;
+    /**
+     * Quantization step of the positions, the largest error is half of it
+    */
+    float precision = 1.0e-5f;
+    /**
+     * Every key_interval-th frame is stored whole, the others as a delta from the previous frame;
+     * a seek decodes at most key_interval frames
+    */
+    std::uint32_t key_interval = 30;
+    /**
+     * Frames waiting for the I/O thread before append waits for it
+    */
+    std::size_t max_pending = 8;
+};
+
+/**
+ * @class PointCacheWriter
+ * @brief Streams the frames of a cloth to a point cache file. The topology (triangles and uvs) is
+ * written once when the writer is created; append only copies the positions, the normals,
+ * quantization, delta coding and the write itself run on a background I/O thread.
+ *
+ * File: a header, the topology, one block per frame and, once finish() has run, an index of the
+ * frame offsets. A file whose writer did not finish is still readable up to its last whole frame.
+ */
+class PointCacheWriter
+{
+public:
+    /**
+     * Create the file and write the topology of c
+     * @throws std::runtime_error when the file cannot be created
+     */
+    PointCacheWriter(const std::string& path, const Cloth& c, PointCacheOptions options = {});
+    /**
+     * Finishes the file, errors are dropped (call finish() to see them)
+     */
+    ~PointCacheWriter();
+    PointCacheWriter(const PointCacheWriter&) = delete;
+    PointCacheWriter& operator=(const PointCacheWriter&) = delete;
+
+    /**
+     * Queue the current positions of c as the next frame. It only waits when max_pending frames
+     * are already queued, that is when the disk cannot keep up with the simulation.
+     * @param time time stamp of the frame, in seconds
+     * @throws std::runtime_error when an earlier frame could not be written
+     */
+    void append(const Cloth& c, double time);
+    /**
+     * Write the queued frames and the index, then close the file
+     * @throws std::runtime_error when a frame or the index could not be written
+     */
+    void finish();
+
+    std::uint64_t frames() const { return appended; }
+
+private:
+    struct Pending {
+        Snapshot positions;
+        double time = 0.0;
+    };
+
+    void run();
+    void encode(const Pending& frame, std::vector<unsigned char>& bytes);
+    void rethrow();
+
+    PointCacheOptions options;
+    std::size_t vertex_count;
+    std::vector<int> tris;
+    Adjacency node_tris;
+    std::ofstream out;
+    std::uint64_t appended = 0;
+    bool finished = false;
+
+    // owned by the I/O thread
+    std::uint64_t written = 0;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::int32_t> previous;
+    std::vector<glm::vec3> faces;
+    std::vector<unsigned char> block;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Pending> queue;
+    std::vector<Pending> spare;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread worker;
+};
+
+/**
+ * @class PointCacheReader
+ * @brief Random access to the frames of a point cache. The file is memory mapped, the topology is
+ * read in place. Seeking is O(1): the frame index gives the block of any frame, and at most
+ * key_interval blocks are decoded from the previous key frame; reading the next frame of the last
+ * one read decodes only its own block.
+ */
+class PointCacheReader
+{
+public:
+    /**
+     * @throws std::runtime_error when the file is not a point cache
+     */
+    explicit PointCacheReader(const std::string& path);
+
+    std::size_t vertex_count() const { return vertices; }
+    std::size_t triangle_count() const { return triangles; }
+    std::size_t frame_count() const { return blocks.size(); }
+    bool has_normals() const { return normals; }
+    /**
+     * Three vertex indices per triangle and two uv floats per vertex, in the mapping
+    */
+    const std::uint32_t* indices() const { return index_data; }
+    const float* uvs() const { return uv_data; }
+    /**
+     * Time stamp of a frame, in seconds
+     */
+    double time(std::size_t frame) const;
+
+    /**
+     * Decode a frame
+     * @param frame in [0, frame_count())
+     * @param x,y,z vertex_count() floats each
+     * @param n vertex_count() normals, may be null; left untouched when the cache has no normals
+     */
+    void read(std::size_t frame, float* x, float* y, float* z, glm::vec3* n = nullptr);
+
+private:
+    void decode(std::size_t frame);
+
+    MappedFile file;
+    std::size_t vertices = 0;
+    std::size_t triangles = 0;
+    bool normals = false;
+    float precision = 0.0f;
+    std::uint32_t key_interval = 1;
+    const std::uint32_t* index_data = nullptr;
+    const float* uv_data = nullptr;
+    std::vector<std::uint64_t> blocks;
+
+    // last decoded frame
+    std::size_t current = static_cast<std::size_t>(-1);
+    std::vector<std::int32_t> quantized;
+};
+}
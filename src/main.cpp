@@ -1,11 +1,25 @@
 #include <iostream>
 #include <filesystem>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <glad.h>
 #include <GLFW/glfw3.h>
 #include <glm.hpp>
 #include <sys/time.h>
 #include "cloth/cloth.h"
+#include "cloth/replay.h"
+#include "cloth/sim_thread.h"
+#include "mesh/mesh_io.h"
+#include "cloth/scene.h"
+#include "display/cloth_pipeline.h"
+#include "display/cloth_renderer.h"
+#include "display/scene.h"
 #include "display/display.h"
 #include "state/state.h"
 #include "display/camera.h"
@@ -20,7 +34,64 @@ using namespace cloth;
 
 
 // start of the simulator
-int main(){
+// --threaded: simulate on a dedicated thread at a fixed rate and draw interpolated snapshots
+// --cloth file: simulate a triangle mesh (.obj, or any format assimp reads) instead of the 60x60 grid;
+//               repeat it to simulate several cloths (e.g. the panels of a garment) as one scene
+// --deterministic: simulate exactly one frame per drawn frame, whatever the real time elapsed
+// --record log: deterministic, and save the inputs and the state hash of every frame to log on exit
+// --replay log: deterministic, apply the inputs of log instead of the user's and check the hashes
+int main(int argc, char** argv){
+
+    bool threaded = false;
+    bool deterministic = false;
+    std::vector<std::string> cloth_files;
+    std::string record_file;
+    std::string replay_file;
+    for (int i=1; i<argc; ++i) {
+        if (std::strcmp(argv[i], "--threaded") == 0)
+            threaded = true;
+        else if (std::strcmp(argv[i], "--deterministic") == 0)
+            deterministic = true;
+        else if (std::strcmp(argv[i], "--cloth") == 0 && i + 1 < argc)
+            cloth_files.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record_file = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_file = argv[++i];
+    }
+    const bool recording = !record_file.empty();
+    const bool replaying = !replay_file.empty();
+    if (recording || replaying) {
+        deterministic = true;
+        threaded = false;
+    }
+
+    cloth::EventLog log;
+    try {
+        if (replaying)
+            log = cloth::EventLog::load(replay_file);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    cloth::ReplayVerifier verifier {log};
+
+    cloth::Scene scene;
+    try {
+        if (cloth_files.empty())
+            scene.emplace(60, 60, 1.0);
+        for (const std::string& file : cloth_files)
+            scene.emplace(cloth::load_mesh(file));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    // the simulation thread and the pin keys drive the first cloth
+    cloth::Cloth& cloth = scene.cloth(0);
+    if (threaded && scene.size() > 1) {
+        std::cerr << "--threaded simulates a single cloth, the scene is simulated on the render thread" << std::endl;
+        threaded = false;
+    }
 
 
     render::State state {SCR_WIDTH, SCR_HEIGHT};
@@ -28,13 +99,42 @@ int main(){
     
     set_GL_parameters();
 
-    cloth::Cloth cloth {60, 60, 1.0, state};
+    cloth::ThreadPool pool {};
+    scene.pool = &pool;
+    for (std::size_t k=0; k<scene.size(); ++k)
+        scene.cloth(k).pool = &pool;
+    // one program and texture for every cloth; the scene is one draw call, the threaded view of a
+    // single cloth draws snapshots instead
+    render::ClothPipeline pipeline {state};
+    std::unique_ptr<render::Scene> scene_renderer;
+    std::unique_ptr<render::ClothRenderer> cloth_renderer;
+    if (threaded)
+        cloth_renderer = std::make_unique<render::ClothRenderer>(cloth, pipeline);
+    else
+        scene_renderer = std::make_unique<render::Scene>(scene, pipeline);
     
     render::Camera camera {glm::vec3(0.0, 3.0, 2.0),
                            glm::vec3(0.0, -1.0, -1.0),
                            glm::vec3(0.0, 0.0, 1.0)};
     
     Axis axis {SCR_WIDTH, SCR_HEIGHT};
+
+    if (replaying)
+        state.frame_time = log.frame_time;
+    if (recording) {
+        log.record_settings(0, state);
+        log.record(0, cloth::SimEvent::camera(camera.pos, camera.front_v));
+    }
+    std::uint64_t frame = 0;
+    glm::vec3 recorded_pos = camera.pos;
+    glm::vec3 recorded_front = camera.front_v;
+    std::vector<cloth::SimEvent> events;
+
+    cloth::FixedTimestep timestep {state.frame_time, state.max_frames_per_update};
+    cloth::SimulationThread sim {cloth, state};
+    cloth::SnapshotInterpolator view;
+    if (threaded)
+        sim.start();
     
     // main render loop
     while(!glfwWindowShouldClose(window)){
@@ -42,15 +142,55 @@ int main(){
         state.update(window);
         //std::cout << state.delta_time << std::endl;
         
-        processInput(window, state, camera);
+        if (replaying)
+            should_close(window);
+        else
+            processInput(window, state, camera);
+
+        if (!threaded) {
+            events.clear();
+            if (replaying) {
+                auto [first, last] = log.at(frame);
+                events.assign(first, last);
+            } else {
+                process_sim_input(window, state, cloth, events);
+                if (recording && (camera.pos != recorded_pos || camera.front_v != recorded_front)) {
+                    events.push_back(cloth::SimEvent::camera(camera.pos, camera.front_v));
+                    recorded_pos = camera.pos;
+                    recorded_front = camera.front_v;
+                }
+            }
+            for (const cloth::SimEvent& e : events) {
+                if (!cloth::apply_event(e, cloth, state)) {
+                    camera.pos = glm::vec3(e.value[0], e.value[1], e.value[2]);
+                    camera.front_v = glm::vec3(e.value[3], e.value[4], e.value[5]);
+                }
+                if (recording)
+                    log.record(frame, e);
+            }
+        }
         
         glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); // per vedere le linee dei triangoli
         
-        cloth.simulate_XPBD(state);
-        
-        cloth.render(camera);
+        if (threaded) {
+            if (const cloth::Snapshot* newest = sim.poll())
+                view.push(*newest);
+            cloth_renderer->render(camera, view.at(std::chrono::steady_clock::now(), sim.step_seconds()));
+        } else if (deterministic) {
+            scene.simulate_XPBD(state);
+            if (recording)
+                log.hashes.push_back(cloth::state_hash(scene.particles(), scene.pool));
+            if (replaying && !verifier.check(frame, scene.particles(), scene.pool) && verifier.first_mismatch == static_cast<std::int64_t>(frame))
+                std::cerr << "replay diverged at frame " << frame << std::endl;
+            ++frame;
+            scene_renderer->render(camera);
+        } else {
+            for (int f = timestep.advance(state.delta_time); f > 0; --f)
+                scene.simulate_XPBD(state);
+            scene_renderer->render(camera);
+        }
         axis.render(camera);
 
         glfwSwapBuffers(window);
@@ -60,7 +200,21 @@ int main(){
     }
 
 
-    cloth.free_resources();
+    sim.stop();
+    if (replaying && verifier.first_mismatch < 0)
+        std::cout << "replay verified " << verifier.checked << " of " << log.hashes.size() << " frames" << std::endl;
+    if (recording) {
+        try {
+            log.save(record_file);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    if (scene_renderer)
+        scene_renderer->free_resources();
+    if (cloth_renderer)
+        cloth_renderer->free_resources();
+    pipeline.free_resources();
     axis.free();
     glfwTerminate();
 
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Contains the implementation of the mesh loaders.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "mesh/mesh_io.h"
+
+namespace cloth{
+
+#ifdef XPBD_WITH_ASSIMP
+// mesh_io_assimp.cpp
+TriangleMesh load_mesh_assimp(const std::string& path);
+#endif
+
+bool assimp_available() {
+#ifdef XPBD_WITH_ASSIMP
+    return true;
+#else
+    return false;
+#endif
+}
+
+TriangleMesh read_obj(std::istream& in) {
+    TriangleMesh mesh;
+    std::vector<glm::vec2> texture_coords;
+    std::vector<bool> has_uv;
+    std::string line;
+    std::vector<std::uint32_t> polygon;
+    std::size_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        std::istringstream fields(line);
+        std::string tag;
+        fields >> tag;
+        if (tag == "v") {
+            glm::vec3 v;
+            fields >> v.x >> v.y >> v.z;
+            mesh.vertices.push_back(v);
+        } else if (tag == "vt") {
+            glm::vec2 uv;
+            fields >> uv.x >> uv.y;
+            texture_coords.push_back(uv);
+        } else if (tag == "f") {
+            polygon.clear();
+            std::string corner;
+            while (fields >> corner) {
+                // v, v/vt, v//vn or v/vt/vn; negative indices count from the last vertex
+                const long index = std::strtol(corner.c_str(), nullptr, 10);
+                const long resolved = index < 0 ? static_cast<long>(mesh.vertices.size()) + index : index - 1;
+                if (index == 0 || resolved < 0 || resolved >= static_cast<long>(mesh.vertices.size()))
+                    throw std::runtime_error("obj line " + std::to_string(line_number) + ": bad vertex index " + corner);
+                polygon.push_back(static_cast<std::uint32_t>(resolved));
+                // uvs are per corner in the file, a vertex keeps the first one it is given
+                const std::size_t slash = corner.find('/');
+                if (slash != std::string::npos && slash + 1 < corner.size() && corner[slash + 1] != '/') {
+                    const long uv_index = std::strtol(corner.c_str() + slash + 1, nullptr, 10);
+                    const long uv_resolved = uv_index < 0 ? static_cast<long>(texture_coords.size()) + uv_index : uv_index - 1;
+                    if (uv_resolved >= 0 && uv_resolved < static_cast<long>(texture_coords.size())) {
+                        mesh.uvs.resize(mesh.vertices.size());
+                        has_uv.resize(mesh.vertices.size(), false);
+                        if (!has_uv[resolved]) {
+                            has_uv[resolved] = true;
+                            mesh.uvs[resolved] = texture_coords[uv_resolved];
+                        }
+                    }
+                }
+            }
+            for (std::size_t k=2; k<polygon.size(); ++k) {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[k - 1]);
+                mesh.indices.push_back(polygon[k]);
+            }
+        }
+    }
+    if (!mesh.uvs.empty())
+        mesh.uvs.resize(mesh.vertices.size());
+    return mesh;
+}
+
+TriangleMesh load_mesh(const std::string& path) {
+    std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (extension == ".obj") {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("cannot open " + path);
+        return read_obj(in);
+    }
+#ifdef XPBD_WITH_ASSIMP
+    return load_mesh_assimp(path);
+#else
+    throw std::runtime_error("cannot read " + path + ": only .obj is supported without assimp");
+#endif
+}
+}
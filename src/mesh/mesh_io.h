@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief Contains the functions that load triangle meshes from files.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <istream>
+#include <string>
+#include "mesh/triangle_mesh.h"
+
+namespace cloth{
+/**
+ * Load a mesh, polygons are triangulated. Wavefront .obj files are read natively, every other
+ * format goes through assimp and needs the build to have found the library.
+ * @throws std::runtime_error when the file cannot be read
+ */
+TriangleMesh load_mesh(const std::string& path);
+
+/**
+ * Read the vertices ('v') and faces ('f', polygons split in fans) of a Wavefront .obj stream
+ * @throws std::runtime_error on a malformed face
+ */
+TriangleMesh read_obj(std::istream& in);
+
+/**
+ * Whether load_mesh can read formats other than .obj
+ */
+bool assimp_available();
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @brief Contains the mesh loader based on assimp, built only when the library is available.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <stdexcept>
+#include <Importer.hpp>
+#include <scene.h>
+#include <postprocess.h>
+#include "mesh/mesh_io.h"
+
+namespace cloth{
+
+/**
+ * Append the meshes of node and of its children, in world space
+ */
+static void append_node(const aiScene* scene, const aiNode* node, const aiMatrix4x4& parent, TriangleMesh& out) {
+    const aiMatrix4x4 transform = parent * node->mTransformation;
+    for (unsigned m=0; m<node->mNumMeshes; ++m) {
+        const aiMesh* mesh = scene->mMeshes[node->mMeshes[m]];
+        const std::uint32_t base = static_cast<std::uint32_t>(out.vertices.size());
+        for (unsigned v=0; v<mesh->mNumVertices; ++v) {
+            const aiVector3D p = transform * mesh->mVertices[v];
+            out.vertices.emplace_back(p.x, p.y, p.z);
+        }
+        if (mesh->HasTextureCoords(0)) {
+            out.uvs.resize(base);
+            for (unsigned v=0; v<mesh->mNumVertices; ++v) {
+                const aiVector3D uv = mesh->mTextureCoords[0][v];
+                out.uvs.push_back(glm::vec2(uv.x, uv.y));
+            }
+        }
+        for (unsigned f=0; f<mesh->mNumFaces; ++f) {
+            const aiFace& face = mesh->mFaces[f];
+            if (face.mNumIndices != 3)
+                continue; // points and lines left by the triangulation
+            for (unsigned k=0; k<3; ++k)
+                out.indices.push_back(base + face.mIndices[k]);
+        }
+    }
+    for (unsigned c=0; c<node->mNumChildren; ++c)
+        append_node(scene, node->mChildren[c], transform, out);
+}
+
+TriangleMesh load_mesh_assimp(const std::string& path) {
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+    if (!scene || !scene->mRootNode)
+        throw std::runtime_error("cannot read " + path + ": " + importer.GetErrorString());
+    TriangleMesh mesh;
+    append_node(scene, scene->mRootNode, aiMatrix4x4(), mesh);
+    if (!mesh.uvs.empty())
+        mesh.uvs.resize(mesh.vertices.size());
+    return mesh;
+}
+}
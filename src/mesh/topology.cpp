@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Contains the implementation of the mesh topology functions.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include "mesh/topology.h"
+
+namespace cloth{
+
+std::vector<std::uint32_t> weld_vertices(TriangleMesh& mesh, float tolerance) {
+    const std::size_t n = mesh.vertices.size();
+    using Cell = std::array<std::int32_t, 3>;
+    std::vector<Cell> cells(n);
+    std::size_t buckets = 1;
+    while (buckets < n)
+        buckets <<= 1;
+    std::vector<std::uint32_t> bucket_of(n);
+    for (std::size_t v=0; v<n; ++v) {
+        std::uint32_t hash = 2166136261u;
+        for (int k=0; k<3; ++k) {
+            const float coord = mesh.vertices[v][k];
+            if (tolerance > 0.0f) {
+                cells[v][k] = static_cast<std::int32_t>(std::floor(coord / tolerance));
+            } else {
+                // exact: the bit pattern, with -0 folded on +0
+                const float folded = coord == 0.0f ? 0.0f : coord;
+                std::memcpy(&cells[v][k], &folded, sizeof(float));
+            }
+            hash = (hash ^ static_cast<std::uint32_t>(cells[v][k])) * 16777619u;
+        }
+        bucket_of[v] = (hash ^ (hash >> 15)) & static_cast<std::uint32_t>(buckets - 1);
+    }
+
+    // counting sort of the vertices on the hash of their cell, stable so every bucket is in vertex order
+    std::vector<std::uint32_t> start(buckets + 1, 0);
+    for (std::size_t v=0; v<n; ++v)
+        ++start[bucket_of[v] + 1];
+    for (std::size_t b=0; b<buckets; ++b)
+        start[b + 1] += start[b];
+    std::vector<std::uint32_t> sorted(n);
+    {
+        std::vector<std::uint32_t> fill(start.begin(), start.end() - 1);
+        for (std::size_t v=0; v<n; ++v)
+            sorted[fill[bucket_of[v]]++] = static_cast<std::uint32_t>(v);
+    }
+
+    // every vertex points to the first (lowest index) vertex of its cell
+    std::vector<std::uint32_t> representative(n);
+    for (std::size_t b=0; b<buckets; ++b) {
+        // different cells sharing a bucket are separated by a stable insertion sort on the cell
+        std::uint32_t* bucket = sorted.data() + start[b];
+        const std::size_t size = start[b + 1] - start[b];
+        for (std::size_t i=1; i<size; ++i) {
+            const std::uint32_t v = bucket[i];
+            std::size_t j = i;
+            for (; j > 0 && cells[v] < cells[bucket[j - 1]]; --j)
+                bucket[j] = bucket[j - 1];
+            bucket[j] = v;
+        }
+        for (std::size_t begin=0; begin<size;) {
+            std::size_t end = begin + 1;
+            while (end < size && cells[bucket[end]] == cells[bucket[begin]])
+                ++end;
+            for (std::size_t k=begin; k<end; ++k)
+                representative[bucket[k]] = bucket[begin];
+            begin = end;
+        }
+    }
+
+    std::vector<std::uint32_t> remap(n);
+    std::uint32_t kept = 0;
+    for (std::size_t v=0; v<n; ++v) {
+        if (representative[v] == v) {
+            remap[v] = kept;
+            mesh.vertices[kept] = mesh.vertices[v];
+            if (!mesh.uvs.empty())
+                mesh.uvs[kept] = mesh.uvs[v];
+            ++kept;
+        }
+    }
+    for (std::size_t v=0; v<n; ++v)
+        remap[v] = remap[representative[v]];
+    mesh.vertices.resize(kept);
+    if (!mesh.uvs.empty())
+        mesh.uvs.resize(kept);
+
+    std::size_t out = 0;
+    for (std::size_t t=0; t<mesh.triangle_count(); ++t) {
+        const std::uint32_t a = remap[mesh.indices[3*t]];
+        const std::uint32_t b = remap[mesh.indices[3*t + 1]];
+        const std::uint32_t c = remap[mesh.indices[3*t + 2]];
+        if (a == b || b == c || a == c)
+            continue;
+        mesh.indices[out++] = a;
+        mesh.indices[out++] = b;
+        mesh.indices[out++] = c;
+    }
+    mesh.indices.resize(out);
+    return remap;
+}
+
+MeshTopology build_topology(const std::uint32_t* indices, std::size_t triangles) {
+    std::uint32_t max_vertex = 0;
+    for (std::size_t k=0; k<3*triangles; ++k)
+        max_vertex = std::max(max_vertex, indices[k]);
+    const std::size_t vertices = triangles ? std::size_t(max_vertex) + 1 : 0;
+
+    // counting sort of the half edges on their smaller vertex, stable so each bucket is in triangle order
+    struct HalfEdge
+    {
+        std::uint32_t larger;
+        std::uint32_t opposite;
+    };
+    std::vector<std::uint32_t> start(vertices + 1, 0);
+    for (std::size_t t=0; t<triangles; ++t)
+        for (int k=0; k<3; ++k)
+            ++start[std::min(indices[3*t + k], indices[3*t + (k + 1) % 3]) + 1];
+    for (std::size_t v=0; v<vertices; ++v)
+        start[v + 1] += start[v];
+    std::vector<HalfEdge> half(3 * triangles);
+    {
+        std::vector<std::uint32_t> fill(start.begin(), start.end() - 1);
+        for (std::size_t t=0; t<triangles; ++t) {
+            for (int k=0; k<3; ++k) {
+                const std::uint32_t a = indices[3*t + k];
+                const std::uint32_t b = indices[3*t + (k + 1) % 3];
+                half[fill[std::min(a, b)]++] = {std::max(a, b), indices[3*t + (k + 2) % 3]};
+            }
+        }
+    }
+
+    MeshTopology topology;
+    topology.edge_v0.reserve(half.size() / 2 + 1);
+    topology.edge_v1.reserve(half.size() / 2 + 1);
+    topology.hinges.reserve(half.size() / 2);
+    for (std::size_t v=0; v<vertices; ++v) {
+        // a bucket holds a handful of half edges: stable insertion sort on the larger vertex
+        HalfEdge* bucket = half.data() + start[v];
+        const std::size_t size = start[v + 1] - start[v];
+        for (std::size_t i=1; i<size; ++i) {
+            const HalfEdge h = bucket[i];
+            std::size_t j = i;
+            for (; j > 0 && bucket[j - 1].larger > h.larger; --j)
+                bucket[j] = bucket[j - 1];
+            bucket[j] = h;
+        }
+        for (std::size_t begin=0; begin<size;) {
+            std::size_t end = begin + 1;
+            while (end < size && bucket[end].larger == bucket[begin].larger)
+                ++end;
+            const std::uint32_t v0 = static_cast<std::uint32_t>(v);
+            const std::uint32_t v1 = bucket[begin].larger;
+            topology.edge_v0.push_back(v0);
+            topology.edge_v1.push_back(v1);
+            for (std::size_t k=begin + 1; k<end; ++k)
+                topology.hinges.push_back({v0, v1, bucket[k - 1].opposite, bucket[k].opposite});
+            begin = end;
+        }
+    }
+    return topology;
+}
+}
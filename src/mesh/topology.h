@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Contains the functions that weld a triangle mesh and extract its edges and hinges.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mesh/triangle_mesh.h"
+
+namespace cloth{
+/**
+ * @struct Hinge
+ * @brief Two triangles sharing the edge (v0, v1); a and b are the vertices opposite to the edge.
+ */
+struct Hinge
+{
+    std::uint32_t v0, v1;
+    std::uint32_t a, b;
+};
+
+/**
+ * @struct MeshTopology
+ * @brief Unique edges (v0 < v1, sorted) and the hinges of the interior edges. A non manifold edge
+ * gives one hinge per pair of consecutive incident triangles.
+ */
+struct MeshTopology
+{
+    std::vector<std::uint32_t> edge_v0;
+    std::vector<std::uint32_t> edge_v1;
+    std::vector<Hinge> hinges;
+
+    std::size_t edge_count() const { return edge_v0.size(); }
+};
+
+/**
+ * Merge the vertices that fall in the same cell of a grid of side tolerance (the same bit pattern
+ * when tolerance is 0, -0 and +0 being equal) and drop the triangles that collapse. Vertices closer
+ * than tolerance but on either side of a cell boundary stay apart. The cells are hashed and counting
+ * sorted, every vertex goes to the first vertex of its cell and the surviving vertices keep their
+ * relative order. O(V) for a mesh without many vertices per cell.
+ * @return new index of every old vertex
+ */
+std::vector<std::uint32_t> weld_vertices(TriangleMesh& mesh, float tolerance);
+
+/**
+ * Edges and hinges of a triangle list: every triangle emits its three half edges, a counting sort
+ * on the smaller vertex buckets them, then an insertion sort on the larger vertex brings the copies
+ * of an edge together inside each bucket. Both sorts are stable, so the hinges of an edge follow the
+ * triangle order. O(T + V) for bounded vertex valence.
+ */
+MeshTopology build_topology(const std::uint32_t* indices, std::size_t triangles);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file
+ * @brief Contains the struct TriangleMesh, an indexed triangle list.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm.hpp>
+
+namespace cloth{
+/**
+ * @struct TriangleMesh
+ * @brief Vertices and three vertex indices per triangle, counter clockwise seen from outside
+ */
+struct TriangleMesh
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<std::uint32_t> indices;
+    /**
+     * Texture coordinates, one per vertex or empty
+     */
+    std::vector<glm::vec2> uvs;
+
+    std::size_t triangle_count() const { return indices.size() / 3; }
+};
+}
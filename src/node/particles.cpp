@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Contains the implementation of struct Particles.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "node/particles.h"
+#include <cmath>
+
+namespace cloth{
+
+void Particles::reserve(std::size_t n) {
+    for (auto* a : {&x, &y, &z, &px, &py, &pz, &vx, &vy, &vz, &w})
+        a->reserve(n);
+    m.reserve(n);
+}
+
+void Particles::clear() {
+    for (auto* a : {&x, &y, &z, &px, &py, &pz, &vx, &vy, &vz, &w})
+        a->clear();
+    m.clear();
+}
+
+std::size_t Particles::add(const Node& node) {
+    x.push_back(node.pos.x);
+    y.push_back(node.pos.y);
+    z.push_back(node.pos.z);
+    px.push_back(node.prev_pos.x);
+    py.push_back(node.prev_pos.y);
+    pz.push_back(node.prev_pos.z);
+    vx.push_back(node.vel.x);
+    vy.push_back(node.vel.y);
+    vz.push_back(node.vel.z);
+    w.push_back(node.w);
+    m.push_back(node.m);
+    return size() - 1;
+}
+
+std::size_t Particles::split(std::size_t i) {
+    m[i] *= 0.5f;
+    w[i] *= 2.0f;
+    for (auto* a : {&x, &y, &z, &px, &py, &pz, &vx, &vy, &vz, &w}) {
+        const float v = (*a)[i];
+        a->push_back(v);
+    }
+    const float mass = m[i];
+    m.push_back(mass);
+    return size() - 1;
+}
+
+void Particles::set_position(std::size_t i, glm::vec3 p) {
+    x[i] = p.x;
+    y[i] = p.y;
+    z[i] = p.z;
+}
+
+void Particles::set_velocity(std::size_t i, glm::vec3 v) {
+    vx[i] = v.x;
+    vy[i] = v.y;
+    vz[i] = v.z;
+}
+
+float Particles::distance(std::size_t i, std::size_t j) const {
+    return sqrt(powf((x[i] - x[j]), 2) +
+                powf((y[i] - y[j]), 2) +
+                powf((z[i] - z[j]), 2));
+}
+}
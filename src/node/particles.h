@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @brief Contains the struct Particles, the structure-of-arrays storage of the cloth nodes.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <glm.hpp>
+#include "node/node.h"
+#include "node/aligned_allocator.h"
+
+namespace cloth{
+/**
+ * @struct Particles
+ * @brief Physics state of every node, one aligned array per component. The solver loops only
+ * stream the arrays they use, render data (normals, uv) is kept by the owner of the particles.
+ */
+struct Particles
+{
+    /**
+     * Position, while a substep is solved this is the predicted position
+    */
+    aligned_vector<float> x, y, z;
+    /**
+     * Position at the beginning of the substep
+    */
+    aligned_vector<float> px, py, pz;
+    /**
+     * Velocity
+    */
+    aligned_vector<float> vx, vy, vz;
+    /**
+     * Inverse of mass, 0 for pinned nodes
+    */
+    aligned_vector<float> w;
+    /**
+     * Mass (cold data, only used to restore w when a node is unpinned)
+    */
+    std::vector<float> m;
+
+    std::size_t size() const { return w.size(); }
+
+    void reserve(std::size_t n);
+    void clear();
+
+    /**
+     * Append the physics part of a node
+     * @param node
+     * @returns index of the new particle
+     */
+    std::size_t add(const Node& node);
+    /**
+     * Append a copy of particle i, the two halves share its mass
+     * @returns index of the new particle
+     */
+    std::size_t split(std::size_t i);
+
+    glm::vec3 position(std::size_t i) const { return {x[i], y[i], z[i]}; }
+    glm::vec3 prev_position(std::size_t i) const { return {px[i], py[i], pz[i]}; }
+    glm::vec3 velocity(std::size_t i) const { return {vx[i], vy[i], vz[i]}; }
+
+    void set_position(std::size_t i, glm::vec3 p);
+    void set_velocity(std::size_t i, glm::vec3 v);
+
+    /**
+     * Calculate distance value between two particles
+     * @param i
+     * @param j
+     * @returns distance
+     */
+    float distance(std::size_t i, std::size_t j) const;
+};
+}
@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @brief Contains the implementation of class ThreadPool.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#include "parallel/thread_pool.h"
+
+namespace cloth{
+
+// number of polls before a waiting thread gives up its time slice / goes to sleep; the solver issues
+// hundreds of short loops per frame, so threads spin briefly instead of sleeping right away
+static constexpr int spin_count = 4096;
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    workers.reserve(threads - 1);
+    for (unsigned i=1; i<threads; ++i)
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+    for (auto& t : workers)
+        t.join();
+}
+
+void ThreadPool::run(unsigned tasks, const std::function<void(unsigned)>& task) {
+    if (tasks == 0)
+        return;
+    if (tasks == 1 || workers.empty()) {
+        for (unsigned k=0; k<tasks; ++k)
+            task(k);
+        return;
+    }
+    std::lock_guard<std::mutex> caller(dispatch);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        current_tasks = tasks;
+        pending.store(tasks - 1, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    task(0);
+
+    for (int spin=0; pending.load(std::memory_order_acquire) != 0; ++spin) {
+        if (spin > spin_count)
+            std::this_thread::yield();
+    }
+}
+
+void ThreadPool::worker_loop(unsigned id) {
+    unsigned long seen = 0;
+    while (true) {
+        int spin = 0;
+        while (generation.load(std::memory_order_acquire) == seen && spin < spin_count)
+            ++spin;
+        const std::function<void(unsigned)>* task;
+        unsigned tasks;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return generation.load(std::memory_order_relaxed) != seen; });
+            seen = generation.load(std::memory_order_relaxed);
+            if (stop)
+                return;
+            task = current;
+            tasks = current_tasks;
+        }
+        if (id < tasks) {
+            (*task)(id);
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+}
+}
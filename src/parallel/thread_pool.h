@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief Contains the class ThreadPool used by the parallel solver passes.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cloth{
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads executing fork-join loops. The calling thread takes part in
+ * every loop, so a pool of size 1 has no workers and runs everything inline.
+ * Ranges are split statically (chunk k always covers the same indices), which keeps the work
+ * assignment reproducible.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * Constructor of ThreadPool
+     * @param threads total number of threads including the caller, 0 means one per hardware thread
+     */
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Number of threads taking part in a loop (workers + caller)
+     */
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    /**
+     * Call f(chunk_begin, chunk_end) over [begin, end) split in at most size() chunks of at least
+     * grain elements, and return when every chunk is done.
+     */
+    template <typename F>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& f) {
+        if (end <= begin)
+            return;
+        const std::size_t n = end - begin;
+        std::size_t chunks = grain == 0 ? n : (n + grain - 1) / grain;
+        if (chunks > size())
+            chunks = size();
+        if (chunks <= 1) {
+            f(begin, end);
+            return;
+        }
+        run(static_cast<unsigned>(chunks), [&](unsigned k) {
+            f(begin + n * k / chunks, begin + n * (k + 1) / chunks);
+        });
+    }
+
+    /**
+     * Call task(k) for k in [0, tasks), tasks <= size(), on distinct threads. Loops issued by
+     * different threads (e.g. simulation and render thread) are run one after the other.
+     */
+    void run(unsigned tasks, const std::function<void(unsigned)>& task);
+
+private:
+    void worker_loop(unsigned id);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex dispatch;
+    std::condition_variable wake;
+    const std::function<void(unsigned)>* current = nullptr;
+    unsigned current_tasks = 0;
+    std::atomic<unsigned long> generation {0};
+    std::atomic<unsigned> pending {0};
+    bool stop = false;
+};
+
+/**
+ * Run f(chunk_begin, chunk_end) over [begin, end) on pool, or inline when pool is null
+ */
+template <typename F>
+void parallel_for(ThreadPool* pool, std::size_t begin, std::size_t end, std::size_t grain, F&& f) {
+    if (pool)
+        pool->parallel_for(begin, end, grain, f);
+    else if (begin < end)
+        f(begin, end);
+}
+
+/**
+ * Reduce [begin, end) on pool: block k covers [begin + k * grain, begin + (k + 1) * grain), its
+ * partial is block(block_begin, block_end), and the partials are folded left to right with
+ * combine(accumulated, partial) starting from init. The blocks depend on grain only, not on the
+ * number of threads, so a combine that is not associative (a float sum, a hash) gives the same bits
+ * whatever the pool.
+ */
+template <typename T, typename Block, typename Combine>
+T parallel_reduce(ThreadPool* pool, std::size_t begin, std::size_t end, std::size_t grain, T init, Block&& block, Combine&& combine) {
+    if (end <= begin)
+        return init;
+    if (grain == 0)
+        grain = 1;
+    const std::size_t blocks = (end - begin + grain - 1) / grain;
+    std::vector<T> partial(blocks);
+    parallel_for(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k=first; k<last; ++k)
+            partial[k] = block(begin + k * grain, std::min(end, begin + (k + 1) * grain));
+    });
+    for (std::size_t k=0; k<blocks; ++k)
+        init = combine(init, partial[k]);
+    return init;
+}
+
+/**
+ * Gather a variable number of items per element of [begin, end) on pool: with the blocks of
+ * parallel_reduce, block(block_begin, block_end, list) appends the items of a block to its own list,
+ * then the lists are concatenated in block order into result. Like the partials of parallel_reduce,
+ * the layout of result depends on grain only, not on the number of threads.
+ * @param lists one list per block, kept by the caller so that their memory is reused
+ */
+template <typename T, typename Block>
+void parallel_gather(ThreadPool* pool, std::size_t begin, std::size_t end, std::size_t grain,
+                     std::vector<std::vector<T>>& lists, std::vector<T>& result, Block&& block) {
+    result.clear();
+    if (end <= begin)
+        return;
+    if (grain == 0)
+        grain = 1;
+    const std::size_t blocks = (end - begin + grain - 1) / grain;
+    lists.resize(blocks);
+    parallel_for(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k=first; k<last; ++k) {
+            lists[k].clear();
+            block(begin + k * grain, std::min(end, begin + (k + 1) * grain), lists[k]);
+        }
+    });
+    std::vector<std::size_t> at(blocks + 1, 0);
+    for (std::size_t k=0; k<blocks; ++k)
+        at[k + 1] = at[k] + lists[k].size();
+    result.resize(at[blocks]);
+    parallel_for(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t k=first; k<last; ++k)
+            std::copy(lists[k].begin(), lists[k].end(), result.begin() + at[k]);
+    });
+}
+}
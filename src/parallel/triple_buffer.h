@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @brief Contains the class TripleBuffer, a lock-free single producer / single consumer mailbox.
+ * @author Davide Furlani
+ * @version 0.1
+ * @date January, 2023
+ * @copyright 2023 Davide Furlani
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace cloth{
+/**
+ * @class TripleBuffer
+ * @brief Hands the newest value of T from one writer thread to one reader thread without locks
+ * and without either side ever waiting for the other.
+ *
+ * The writer owns the back slot and the reader the front slot; the third slot sits in the middle.
+ * publish() swaps back and middle, acquire() swaps middle and front, both with a single atomic
+ * exchange. A fresh bit stored with the middle index tells the reader whether the middle slot
+ * holds a value it has not seen yet. Values the reader is too slow to pick up are overwritten, so
+ * the reader always gets the latest one.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * Slot the writer fills before calling publish()
+     */
+    T& write_buffer() { return slots[back]; }
+
+    /**
+     * Make the write buffer the newest value and take a free slot as the next write buffer
+     */
+    void publish() {
+        back = middle.exchange(static_cast<std::uint8_t>(back | fresh), std::memory_order_acq_rel) & index_mask;
+    }
+
+    /**
+     * Move the newest published value, if any, to the read buffer
+     * @return false when nothing was published since the last call
+     */
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & fresh))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    /**
+     * Slot read by the reader, valid until the next acquire()
+     */
+    const T& read_buffer() const { return slots[front]; }
+
+    /**
+     * Direct access to every slot, only while neither thread uses the buffer (e.g. to preallocate)
+     */
+    T& slot(int i) { return slots[i]; }
+
+private:
+    static constexpr std::uint8_t index_mask = 0x3;
+    static constexpr std::uint8_t fresh = 0x4;
+
+    // writer, shared and reader state on separate cache lines
+    T slots[3];
+    alignas(64) std::uint8_t back = 0;
+    alignas(64) std::atomic<std::uint8_t> middle {1};
+    alignas(64) std::uint8_t front = 2;
+};
+}
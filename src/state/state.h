@@ -11,16 +11,14 @@
 #include <glad.h>
 #include <GLFW/glfw3.h>
 #include <glm.hpp>
+#include "cloth/settings.h"
 
 namespace render {
-    struct State {
+    struct State : public cloth::SimSettings {
     public:
         
-        int iteration_per_frame = 30;
-        
         unsigned scr_width;
         unsigned scr_height;
-        glm::vec3 gravity {0.0, 0.0, -9.81};
 
         double last_frame_time = 0.0;
         double current_frame_time = 0.0;